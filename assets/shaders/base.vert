@@ -1,5 +1,11 @@
 #version 450
 
+layout (binding = 0) uniform UniformBufferObject
+{
+    mat4 mvp;
+    vec2 atlasDimens;
+} ubo;
+
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec4 inColor;
 
@@ -7,6 +13,6 @@ layout (location = 0) out vec4 outColor;
 
 void main()
 {
-    gl_Position = vec4(inPosition, 1.0);
+    gl_Position = ubo.mvp * vec4(inPosition, 1.0);
     outColor = inColor;
 }
\ No newline at end of file
@@ -1,3 +1,4 @@
 C:/VulkanSDK/1.3.296.0/Bin/glslc.exe base.vert -o base_vert.spv
 C:/VulkanSDK/1.3.296.0/Bin/glslc.exe base.frag -o base_frag.spv
+C:/VulkanSDK/1.3.296.0/Bin/glslc.exe cull.comp -o cull_comp.spv
 pause
\ No newline at end of file
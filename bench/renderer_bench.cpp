@@ -0,0 +1,326 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Renderer_Bench.cpp																									 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/rendering/renderer.h"
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Defines																						   */
+/*-------------------------------------------------------------------------------------------------*/
+
+#define BENCH_QUADS 200000
+#define BENCH_WORLD_SIZE 20000.0f
+#define BENCH_WARMUP_FRAMES 30
+#define BENCH_FRAMES 600
+#define BENCH_SCREEN_WIDTH 1280
+#define BENCH_SCREEN_HEIGHT 720
+#define BENCH_CHURN_PERCENT 1
+#define BENCH_MAX_ZOOM 64.0f
+#define BENCH_RESIZE_INTERVAL 5
+#define BENCH_OUTPUT_PATH "vkexample_bench.json"
+
+using namespace VkExample;
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Helpers																						   */
+/*-------------------------------------------------------------------------------------------------*/
+/* Timer ----------------------------------------------------------------------*/
+struct Timer
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	double Ms() { return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(); }
+};
+
+/* Scene Result ---------------------------------------------------------------*/
+struct SceneResult
+{
+	std::string				name;
+	std::vector<double>		cpuMs;
+	std::vector<double>		gpuMs;
+	double					totalMs;
+	VkDeviceSize			uploadedBytes;
+	AllocatorStats			memory;
+};
+
+/* Percentile -----------------------------------------------------------------*/
+static double Percentile(std::vector<double> samples, double p)
+{
+	if (samples.empty()) return 0.0;
+
+	std::sort(samples.begin(), samples.end());
+	size_t i = (size_t)std::ceil(p * samples.size());
+	return samples[std::min(samples.size() - 1, i > 0 ? i - 1 : 0)];
+}
+
+/* Random Quad ----------------------------------------------------------------*/
+/*
+	Writes one quad (two triangles) at a random spot in the world.
+*/
+static void RandomQuad(std::mt19937& rng, Vertex* out)
+{
+	std::uniform_real_distribution<float> position(-BENCH_WORLD_SIZE * 0.5f, BENCH_WORLD_SIZE * 0.5f);
+	std::uniform_real_distribution<float> size(4.0f, 64.0f);
+	std::uniform_real_distribution<float> channel(0.0f, 1.0f);
+
+	glm::vec2 lo(position(rng), position(rng));
+	glm::vec2 hi = lo + glm::vec2(size(rng), size(rng));
+	glm::vec4 color(channel(rng), channel(rng), channel(rng), 1.0f);
+
+	Vertex a = { glm::vec3(lo.x, lo.y, 0.0f), color, { 0.0f, 0.0f } };
+	Vertex b = { glm::vec3(hi.x, lo.y, 0.0f), color, { 1.0f, 0.0f } };
+	Vertex c = { glm::vec3(hi.x, hi.y, 0.0f), color, { 1.0f, 1.0f } };
+	Vertex d = { glm::vec3(lo.x, hi.y, 0.0f), color, { 0.0f, 1.0f } };
+
+	out[0] = a; out[1] = b; out[2] = c;
+	out[3] = a; out[4] = c; out[5] = d;
+}
+
+/* Run Scene ------------------------------------------------------------------*/
+/*
+	Renders BENCH_WARMUP_FRAMES untimed frames, then BENCH_FRAMES timed
+	ones. CPU time covers the scene's update and Render(); GPU time comes
+	from the renderer's timestamps, which arrive a few frames late.
+*/
+static SceneResult RunScene(const char* name, Renderer* renderer, std::function<void(int)> update)
+{
+	SceneResult result;
+	result.name = name;
+
+	for (int f = 0; f < BENCH_WARMUP_FRAMES; f++)
+	{
+		update(f);
+		renderer->Render();
+		glfwPollEvents();
+	}
+
+	uint64_t gpuSamples = renderer->GetGpuFrameSamples();
+	VkDeviceSize uploaded = renderer->GetUploadedBytes();
+	Timer total;
+
+	for (int f = 0; f < BENCH_FRAMES; f++)
+	{
+		Timer frame;
+		update(BENCH_WARMUP_FRAMES + f);
+		renderer->Render();
+		glfwPollEvents();
+		result.cpuMs.push_back(frame.Ms());
+
+		if (renderer->GetGpuFrameSamples() != gpuSamples)
+		{
+			gpuSamples = renderer->GetGpuFrameSamples();
+			result.gpuMs.push_back(renderer->GetGpuFrameMs());
+		}
+	}
+
+	result.totalMs = total.Ms();
+	result.uploadedBytes = renderer->GetUploadedBytes() - uploaded;
+	result.memory = renderer->GetMemoryStats();
+
+	printf("%-14s cpu p50 %7.3f ms p99 %7.3f ms | gpu p50 %7.3f ms p99 %7.3f ms | upload %9.1f MB/s\n",
+		name, Percentile(result.cpuMs, 0.5), Percentile(result.cpuMs, 0.99),
+		Percentile(result.gpuMs, 0.5), Percentile(result.gpuMs, 0.99),
+		result.uploadedBytes / (1024.0 * 1024.0) / (result.totalMs / 1000.0));
+
+	return result;
+}
+
+/* Write Timings --------------------------------------------------------------*/
+static void WriteTimings(FILE* file, const char* key, const std::vector<double>& samples)
+{
+	if (samples.empty())
+	{
+		fprintf(file, "\t\t\t\"%s\": null", key);
+		return;
+	}
+
+	double sum = 0.0;
+	for (int i = 0; i < samples.size(); i++) sum += samples[i];
+
+	fprintf(file, "\t\t\t\"%s\": { \"samples\": %zu, \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f }",
+		key, samples.size(), sum / samples.size(), Percentile(samples, 0.5), Percentile(samples, 0.9),
+		Percentile(samples, 0.99), Percentile(samples, 1.0));
+}
+
+/* Write Json -----------------------------------------------------------------*/
+static bool WriteJson(const char* path, Renderer* renderer, const std::vector<SceneResult>& results)
+{
+	FILE* file = fopen(path, "w");
+	if (file == nullptr) return false;
+
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"quads\": %d,\n", BENCH_QUADS);
+	fprintf(file, "\t\"frames\": %d,\n", BENCH_FRAMES);
+	fprintf(file, "\t\"gpu_timing\": %s,\n", renderer->GetGpuTiming() ? "true" : "false");
+
+	const std::vector<VkExample::StartupPhase>& phases = renderer->GetStartupPhases();
+	fprintf(file, "\t\"startup_ms\": {");
+	for (int i = 0; i < phases.size(); i++)
+	{
+		fprintf(file, "%s \"%s\": %.3f", i ? "," : "", phases[i].name, phases[i].ms);
+	}
+	fprintf(file, " },\n");
+	fprintf(file, "\t\"scenes\": [\n");
+
+	for (int i = 0; i < results.size(); i++)
+	{
+		const SceneResult& r = results[i];
+		double seconds = r.totalMs / 1000.0;
+
+		fprintf(file, "\t\t{\n");
+		fprintf(file, "\t\t\t\"name\": \"%s\",\n", r.name.c_str());
+		WriteTimings(file, "cpu_ms", r.cpuMs);
+		fprintf(file, ",\n");
+		WriteTimings(file, "gpu_ms", r.gpuMs);
+		fprintf(file, ",\n");
+		fprintf(file, "\t\t\t\"uploaded_bytes\": %llu,\n", (unsigned long long)r.uploadedBytes);
+		fprintf(file, "\t\t\t\"upload_mb_per_s\": %.2f,\n", r.uploadedBytes / (1024.0 * 1024.0) / seconds);
+		fprintf(file, "\t\t\t\"memory\": { \"bytes_used\": %llu, \"bytes_reserved\": %llu, \"device_memory_count\": %u, \"allocation_count\": %u }\n",
+			(unsigned long long)r.memory.bytesUsed, (unsigned long long)r.memory.bytesReserved,
+			r.memory.deviceMemoryCount, r.memory.allocationCount);
+		fprintf(file, "\t\t}%s\n", i + 1 < results.size() ? "," : "");
+	}
+
+	fprintf(file, "\t]\n}\n");
+	fclose(file);
+	return true;
+}
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Main																							   */
+/*-------------------------------------------------------------------------------------------------*/
+/*
+	Drives the renderer through fixed synthetic scenes and writes their
+	frame times, upload throughput and memory use as JSON (to the path
+	given on the command line, or BENCH_OUTPUT_PATH).
+
+	The window is hidden and validation is off, so the numbers are the
+	renderer's own. Everything is seeded, so two runs on the same driver
+	do the same work; for numbers that are comparable across machines,
+	point the loader at a software ICD (e.g. VK_DRIVER_FILES set to
+	lavapipe's manifest).
+
+	Scenes:
+		static			BENCH_QUADS quads, written once.
+		full_churn		Every quad moves every frame and the whole
+						vertex buffer is rewritten.
+		churn_1pct		BENCH_CHURN_PERCENT% of the quads move every
+						frame, through QueueVertexUpload().
+		zoom_sweep		The camera zooms out to BENCH_MAX_ZOOM and back.
+		resize_storm	The window changes size every
+						BENCH_RESIZE_INTERVAL frames.
+*/
+int main(int argc, char** argv)
+{
+	const char* outputPath = argc > 1 ? argv[1] : BENCH_OUTPUT_PATH;
+
+	RendererSettings settings;
+	settings.validation = false;
+	settings.hiddenWindow = true;
+	settings.gpuTiming = true;
+
+	Camera* camera = new Camera({ 0.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, 0.0f, 0.0f }, 1.0f, 0.001f, 1000.0f);
+	Renderer* renderer = new Renderer({ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR },
+									  BENCH_SCREEN_WIDTH, BENCH_SCREEN_HEIGHT, "VkExample Bench", camera, settings);
+	GLFWwindow* window = renderer->GetWindow();
+
+	std::mt19937 rng(1234);
+	std::vector<Vertex> vertices(BENCH_QUADS * 6);
+	for (int i = 0; i < BENCH_QUADS; i++) RandomQuad(rng, &vertices[i * 6]);
+	std::vector<Vertex> original = vertices;
+
+	/* Puts the scene and camera back the way every scene starts. */
+	auto reset = [&]()
+	{
+		vertices = original;
+		renderer->WriteVertexBuffer(vertices.data(), vertices.size(), 0);
+		camera->SetZoom(1.0f);
+		camera->UpdateProjection();
+	};
+
+	std::vector<SceneResult> results;
+
+	/* Static ---------------------------------------------------------------*/
+	reset();
+	results.push_back(RunScene("static", renderer, [](int) {}));
+
+	/* Full Churn -----------------------------------------------------------*/
+	reset();
+	results.push_back(RunScene("full_churn", renderer, [&](int)
+	{
+		for (int i = 0; i < BENCH_QUADS; i++) RandomQuad(rng, &vertices[i * 6]);
+		renderer->WriteVertexBuffer(vertices.data(), vertices.size(), 0);
+	}));
+
+	/* Partial Churn --------------------------------------------------------*/
+	/*
+		Moved quads go through the per-frame upload buffer. Any that don't
+		fit this frame are queued first thing next frame; WriteVertexBuffer()
+		would stop drawing everything after the quad.
+	*/
+	reset();
+	std::uniform_int_distribution<int> pick(0, BENCH_QUADS - 1);
+	std::vector<int> moved;
+	std::vector<int> deferred;
+	results.push_back(RunScene("churn_1pct", renderer, [&](int)
+	{
+		moved.swap(deferred);
+		deferred.clear();
+
+		for (int i = 0; i < BENCH_QUADS * BENCH_CHURN_PERCENT / 100; i++)
+		{
+			int k = pick(rng);
+			RandomQuad(rng, &vertices[k * 6]);
+			moved.push_back(k);
+		}
+
+		for (int i = 0; i < moved.size(); i++)
+		{
+			int k = moved[i];
+			if (!renderer->QueueVertexUpload(&vertices[k * 6], 6, k * 6)) deferred.push_back(k);
+		}
+
+		moved.clear();
+	}));
+
+	/* Zoom Sweep -----------------------------------------------------------*/
+	reset();
+	results.push_back(RunScene("zoom_sweep", renderer, [&](int f)
+	{
+		float t = (float)(f % BENCH_FRAMES) / BENCH_FRAMES;
+		float zoom = std::pow(BENCH_MAX_ZOOM, 1.0f - std::abs(2.0f * t - 1.0f));
+		camera->SetZoom(zoom);
+		camera->UpdateProjection();
+	}));
+
+	/* Resize Storm ---------------------------------------------------------*/
+	reset();
+	results.push_back(RunScene("resize_storm", renderer, [&](int f)
+	{
+		if (f % BENCH_RESIZE_INTERVAL != 0) return;
+
+		bool small = (f / BENCH_RESIZE_INTERVAL) % 2;
+		glfwSetWindowSize(window, small ? BENCH_SCREEN_WIDTH / 2 : BENCH_SCREEN_WIDTH, small ? BENCH_SCREEN_HEIGHT / 2 : BENCH_SCREEN_HEIGHT);
+		renderer->SetWindowResized(true);
+	}));
+
+	if (WriteJson(outputPath, renderer, results)) printf("Wrote %s.\n", outputPath);
+	else printf("Failed to write %s.\n", outputPath);
+
+	delete(renderer);
+	delete(camera);
+
+	return 0;
+}
\ No newline at end of file
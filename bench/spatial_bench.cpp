@@ -0,0 +1,186 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Spatial_Bench.cpp																									 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../src/util/spatial_grid.h"
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Defines																						   */
+/*-------------------------------------------------------------------------------------------------*/
+
+#define BENCH_ITEMS 1000000
+#define BENCH_WORLD_SIZE 200000.0f
+#define BENCH_CELL_SIZE 512.0f
+#define BENCH_VIEW_WIDTH 1920.0f
+#define BENCH_VIEW_HEIGHT 1080.0f
+#define BENCH_FRAMES 600
+
+using namespace VkExample;
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Helpers																						   */
+/*-------------------------------------------------------------------------------------------------*/
+/* Timer ----------------------------------------------------------------------*/
+struct Timer
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	double Ms() { return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(); }
+};
+
+/* View -----------------------------------------------------------------------*/
+static Rect View(glm::vec2 centre, float zoom)
+{
+	glm::vec2 half = glm::vec2(BENCH_VIEW_WIDTH, BENCH_VIEW_HEIGHT) * 0.5f * zoom;
+	return { centre - half, centre + half };
+}
+
+/* Report ---------------------------------------------------------------------*/
+static void Report(const char* name, double ms, uint32_t operations, uint64_t results)
+{
+	printf("%-28s %10.2f ms total %10.4f ms/op %12.1f results/op\n", name, ms, ms / operations, (double)results / operations);
+}
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Main																							   */
+/*-------------------------------------------------------------------------------------------------*/
+/*
+	Builds a grid of BENCH_ITEMS random quads and times the access patterns
+	a 2D scene sees: panning across the world, zooming out, picking, and
+	churn (items moving, being removed and being added each frame). A
+	linear scan is timed alongside as the baseline the grid replaces.
+*/
+int main()
+{
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> position(0.0f, BENCH_WORLD_SIZE);
+	std::uniform_real_distribution<float> size(4.0f, 64.0f);
+	std::uniform_real_distribution<float> step(-8.0f, 8.0f);
+
+	std::vector<Rect> bounds(BENCH_ITEMS);
+	for (int i = 0; i < BENCH_ITEMS; i++)
+	{
+		glm::vec2 p(position(rng), position(rng));
+		bounds[i] = { p, p + glm::vec2(size(rng), size(rng)) };
+	}
+
+	/* A few huge items, which end up in the oversized list. */
+	for (int i = 0; i < 16; i++) bounds[i].max = bounds[i].min + glm::vec2(BENCH_WORLD_SIZE * 0.1f);
+
+	SpatialGrid grid(BENCH_CELL_SIZE);
+	std::vector<uint32_t> ids(BENCH_ITEMS);
+	std::vector<uint32_t> results;
+	results.reserve(1 << 20);
+
+	/* Insert ---------------------------------------------------------------*/
+	Timer insertTimer;
+	for (int i = 0; i < BENCH_ITEMS; i++) ids[i] = grid.Insert(bounds[i], i);
+	Report("insert", insertTimer.Ms(), BENCH_ITEMS, 0);
+
+	/* Pan ------------------------------------------------------------------*/
+	uint64_t panResults = 0;
+	Timer panTimer;
+	for (int f = 0; f < BENCH_FRAMES; f++)
+	{
+		float t = (float)f / BENCH_FRAMES;
+		results.clear();
+		grid.Query(View(glm::vec2(t, 0.5f) * BENCH_WORLD_SIZE, 1.0f), results);
+		panResults += results.size();
+	}
+	Report("pan query", panTimer.Ms(), BENCH_FRAMES, panResults);
+
+	/* Zoom -----------------------------------------------------------------*/
+	uint64_t zoomResults = 0;
+	Timer zoomTimer;
+	for (int f = 0; f < BENCH_FRAMES; f++)
+	{
+		float zoom = std::pow(2.0f, 6.0f * f / BENCH_FRAMES);
+		results.clear();
+		grid.Query(View(glm::vec2(BENCH_WORLD_SIZE * 0.5f), zoom), results);
+		zoomResults += results.size();
+	}
+	Report("zoom query (1x-64x)", zoomTimer.Ms(), BENCH_FRAMES, zoomResults);
+
+	/* Pick -----------------------------------------------------------------*/
+	uint64_t pickResults = 0;
+	Timer pickTimer;
+	for (int i = 0; i < 100000; i++)
+	{
+		results.clear();
+		grid.QueryPoint(glm::vec2(position(rng), position(rng)), results);
+		pickResults += results.size();
+	}
+	Report("pick", pickTimer.Ms(), 100000, pickResults);
+
+	/* Churn ----------------------------------------------------------------*/
+	/*
+		Each frame 10% of the items move a little, 1% are removed and 1%
+		are added back, followed by the frame's view query.
+	*/
+	std::uniform_int_distribution<int> pick(0, BENCH_ITEMS - 1);
+	uint64_t churnResults = 0;
+	Timer churnTimer;
+	for (int f = 0; f < BENCH_FRAMES / 10; f++)
+	{
+		for (int i = 0; i < BENCH_ITEMS / 10; i++)
+		{
+			int k = pick(rng);
+			glm::vec2 d(step(rng), step(rng));
+			bounds[k] = { bounds[k].min + d, bounds[k].max + d };
+			grid.Move(ids[k], bounds[k]);
+		}
+
+		for (int i = 0; i < BENCH_ITEMS / 100; i++)
+		{
+			int k = pick(rng);
+			grid.Remove(ids[k]);
+			ids[k] = grid.Insert(bounds[k], k);
+		}
+
+		results.clear();
+		grid.Query(View(glm::vec2(BENCH_WORLD_SIZE * 0.5f), 1.0f), results);
+		churnResults += results.size();
+	}
+	Report("churn frame (120k updates)", churnTimer.Ms(), BENCH_FRAMES / 10, churnResults);
+
+	/* Linear Scan Baseline -------------------------------------------------*/
+	uint64_t scanResults = 0;
+	uint32_t scanFrames = 20;
+	Timer scanTimer;
+	for (uint32_t f = 0; f < scanFrames; f++)
+	{
+		Rect view = View(glm::vec2((float)f / scanFrames, 0.5f) * BENCH_WORLD_SIZE, 1.0f);
+		for (int i = 0; i < BENCH_ITEMS; i++)
+		{
+			if (bounds[i].Overlaps(view)) scanResults++;
+		}
+	}
+	Report("linear scan query", scanTimer.Ms(), scanFrames, scanResults);
+
+	/* Check ----------------------------------------------------------------*/
+	/* The grid has to agree with the scan exactly. */
+	Rect view = View(glm::vec2(BENCH_WORLD_SIZE * 0.5f), 4.0f);
+	uint64_t expected = 0;
+	for (int i = 0; i < BENCH_ITEMS; i++)
+	{
+		if (bounds[i].Overlaps(view)) expected++;
+	}
+
+	results.clear();
+	grid.Query(view, results);
+	SpatialGridStats stats = grid.GetStats();
+
+	printf("check: %zu results (expected %llu), %u cells visited, %u entries tested, %u cells, %u oversized\n",
+		results.size(), (unsigned long long)expected, stats.cellsVisited, stats.entriesTested, stats.cellCount, stats.oversizedCount);
+
+	return results.size() == expected ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Sprite_Bench.cpp																										 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../src/util/sprite_expander.h"
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Defines																						   */
+/*-------------------------------------------------------------------------------------------------*/
+
+#define BENCH_SPRITES 1000000
+#define BENCH_WORLD_SIZE 20000.0f
+#define BENCH_RUNS 20
+#define BENCH_FRAME_BUDGET_MS 16.6
+#define BENCH_TOLERANCE 1e-3f
+
+using namespace VkExample;
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Helpers																						   */
+/*-------------------------------------------------------------------------------------------------*/
+/* Timer ----------------------------------------------------------------------*/
+struct Timer
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	double Ms() { return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(); }
+};
+
+/* Report ---------------------------------------------------------------------*/
+static void Report(const char* name, double ms, uint32_t runs)
+{
+	double perRun = ms / runs;
+	double bytes = (double)BENCH_SPRITES * 6 * sizeof(Vertex);
+	printf("%-28s %10.3f ms/frame %10.1f Msprites/s %8.2f GB/s  %s\n", name, perRun, BENCH_SPRITES / perRun / 1000.0,
+		bytes / perRun / 1000000.0, perRun <= BENCH_FRAME_BUDGET_MS ? "within budget" : "over budget");
+}
+
+/* Expand GLM -----------------------------------------------------------------*/
+/*
+	The baseline: a Quad per sprite with glm, as the scenes build them,
+	copied into the output.
+*/
+static void ExpandGLM(const SpriteArrays& sprites, Vertex* out)
+{
+	for (uint32_t i = 0; i < sprites.count; i++)
+	{
+		float sine = std::sin(sprites.rotation[i]);
+		float cosine = std::cos(sprites.rotation[i]);
+		glm::mat2 rotation(cosine, sine, -sine, cosine);
+		glm::vec2 centre(sprites.x[i], sprites.y[i]);
+		glm::vec2 half = glm::vec2(sprites.width[i], sprites.height[i]) * 0.5f;
+		glm::vec4 color(sprites.r[i], sprites.g[i], sprites.b[i], sprites.a[i]);
+
+		Vertex a = { glm::vec3(centre + rotation * glm::vec2(-half.x, -half.y), sprites.z[i]), color, glm::vec2(sprites.u0[i], sprites.v0[i]) };
+		Vertex b = { glm::vec3(centre + rotation * glm::vec2(half.x, -half.y), sprites.z[i]), color, glm::vec2(sprites.u1[i], sprites.v0[i]) };
+		Vertex c = { glm::vec3(centre + rotation * glm::vec2(half.x, half.y), sprites.z[i]), color, glm::vec2(sprites.u1[i], sprites.v1[i]) };
+		Vertex d = { glm::vec3(centre + rotation * glm::vec2(-half.x, half.y), sprites.z[i]), color, glm::vec2(sprites.u0[i], sprites.v1[i]) };
+
+		Quad quad = { { a, b, c }, { a, c, d } };
+		memcpy(out + (size_t)i * 6, &quad, sizeof(Quad));
+	}
+}
+
+/* Max Error ------------------------------------------------------------------*/
+/*
+	The largest difference between two expansions, positions relative
+	to the sprite's size, everything else absolute.
+*/
+static float MaxError(const SpriteArrays& sprites, const std::vector<Vertex>& expected, const std::vector<Vertex>& actual)
+{
+	float error = 0.0f;
+	for (int i = 0; i < expected.size(); i++)
+	{
+		uint32_t sprite = i / 6;
+		float size = std::max(sprites.width[sprite], sprites.height[sprite]);
+
+		glm::vec3 position = glm::abs(expected[i].position - actual[i].position) / size;
+		glm::vec4 color = glm::abs(expected[i].color - actual[i].color);
+		glm::vec2 uv = glm::abs(expected[i].uv - actual[i].uv);
+
+		error = std::max(error, std::max(std::max(position.x, position.y), position.z));
+		error = std::max(error, std::max(std::max(color.x, color.y), std::max(color.z, color.w)));
+		error = std::max(error, std::max(uv.x, uv.y));
+	}
+	return error;
+}
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Main																							   */
+/*-------------------------------------------------------------------------------------------------*/
+/*
+	Expands BENCH_SPRITES random sprites BENCH_RUNS times with each
+	kernel the CPU can run, on one thread and then on as many as the
+	expander will use, against the glm baseline. Every kernel's output
+	has to match the scalar kernel's.
+*/
+int main()
+{
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> position(0.0f, BENCH_WORLD_SIZE);
+	std::uniform_real_distribution<float> size(4.0f, 64.0f);
+	std::uniform_real_distribution<float> angle(-10.0f, 10.0f);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	std::vector<std::vector<float>> fields(14, std::vector<float>(BENCH_SPRITES));
+	for (int i = 0; i < BENCH_SPRITES; i++)
+	{
+		fields[0][i] = position(rng);
+		fields[1][i] = position(rng);
+		fields[2][i] = unit(rng);
+		fields[3][i] = size(rng);
+		fields[4][i] = size(rng);
+		fields[5][i] = angle(rng);
+		for (int k = 6; k < 10; k++) fields[k][i] = unit(rng);
+
+		/* A 16 x 16 atlas. */
+		float u = std::floor(unit(rng) * 16.0f) / 16.0f;
+		float v = std::floor(unit(rng) * 16.0f) / 16.0f;
+		fields[10][i] = u;
+		fields[11][i] = v;
+		fields[12][i] = u + 1.0f / 16.0f;
+		fields[13][i] = v + 1.0f / 16.0f;
+	}
+
+	SpriteArrays sprites = {
+		fields[0].data(), fields[1].data(), fields[2].data(),
+		fields[3].data(), fields[4].data(), fields[5].data(),
+		fields[6].data(), fields[7].data(), fields[8].data(), fields[9].data(),
+		fields[10].data(), fields[11].data(), fields[12].data(), fields[13].data(),
+		BENCH_SPRITES
+	};
+
+	/* Written once up front so page faults aren't timed. */
+	std::vector<Vertex> expected(BENCH_SPRITES * 6);
+	std::vector<Vertex> vertices(BENCH_SPRITES * 6);
+
+	SpriteExpander expander;
+	printf("%u sprites, %.1f MB of vertices, default kernel %s\n", BENCH_SPRITES, BENCH_SPRITES * 6.0 * sizeof(Vertex) / 1000000.0, expander.GetKernelName());
+
+	/* GLM Baseline ---------------------------------------------------------*/
+	ExpandGLM(sprites, vertices.data());
+	Timer glmTimer;
+	for (int r = 0; r < BENCH_RUNS; r++) ExpandGLM(sprites, vertices.data());
+	Report("glm quads", glmTimer.Ms(), BENCH_RUNS);
+
+	/* Reference ------------------------------------------------------------*/
+	expander.SetKernel("scalar");
+	expander.SetMaxThreads(1);
+	expander.Expand(sprites, expected.data());
+
+	bool passed = MaxError(sprites, expected, vertices) <= BENCH_TOLERANCE;
+
+	/* Kernels --------------------------------------------------------------*/
+	const char* kernels[3] = { "scalar", "sse", "avx2" };
+	for (int k = 0; k < 3; k++)
+	{
+		if (!expander.SetKernel(kernels[k]))
+		{
+			printf("%-28s not supported\n", kernels[k]);
+			continue;
+		}
+
+		uint32_t threadCounts[2] = { 1, SPRITE_EXPAND_MAX_THREADS };
+		for (int t = 0; t < 2; t++)
+		{
+			expander.SetMaxThreads(threadCounts[t]);
+			expander.Expand(sprites, vertices.data());
+
+			Timer timer;
+			for (int r = 0; r < BENCH_RUNS; r++) expander.Expand(sprites, vertices.data());
+
+			char name[64];
+			snprintf(name, sizeof(name), "%s, %s", kernels[k], t == 0 ? "1 thread" : "threaded");
+			Report(name, timer.Ms(), BENCH_RUNS);
+
+			float error = MaxError(sprites, expected, vertices);
+			if (error > BENCH_TOLERANCE)
+			{
+				printf("%-28s mismatch, max error %g\n", name, error);
+				passed = false;
+			}
+		}
+	}
+
+	/* Check ----------------------------------------------------------------*/
+	printf("check: %s\n", passed ? "all kernels match" : "FAILED");
+
+	return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include <iostream>
 
 #include "rendering/renderer.h"
+#include "util/sprite_expander.h"
+#include "world/chunk_streamer.h"
 
 /*-------------------------------------------------------------------------------------------------*/
 /* Parameters																					   */
@@ -16,11 +18,60 @@
 #define VERSION 0.01
 #define SCREEN_WIDTH 1600
 #define SCREEN_HEIGHT 800
+#define TRACE_PATH "vkexample_trace.json"
+#define TARGET_FRAME_RATE 60.0
+#define IDLE_WAIT_SECONDS 0.5
+#define TILES_PER_CHUNK 16
+
+/*-------------------------------------------------------------------------------------------------*/
+/* World Generation																				   */
+/*-------------------------------------------------------------------------------------------------*/
+/*
+	A stand-in for real map data: a TILES_PER_CHUNK x TILES_PER_CHUNK grid
+	of tiles per chunk, each coloured from a hash of its world position so
+	the same tile always comes back the same.
+
+	The tiles are laid out as sprites and expanded into the chunk's
+	vertices by the SIMD kernels. The expander is shared by the streaming
+	workers; a chunk's worth of sprites stays on the calling thread.
+*/
+static VkExample::SpriteExpander spriteExpander;
+
+static void GenerateChunk(VkExample::ChunkCoord coord, glm::vec2 origin, std::vector<VkExample::Vertex>& vertices)
+{
+	const int count = TILES_PER_CHUNK * TILES_PER_CHUNK;
+	float tileSize = WORLD_CHUNK_SIZE / TILES_PER_CHUNK;
+
+	float x[count], y[count], r[count], g[count], b[count];
+	float size[count], zero[count], one[count];
+
+	for (int i = 0; i < count; i++)
+	{
+		int tx = i % TILES_PER_CHUNK;
+		int ty = i / TILES_PER_CHUNK;
+
+		uint32_t h = (uint32_t)(coord.x * TILES_PER_CHUNK + tx) * 73856093u ^ (uint32_t)(coord.y * TILES_PER_CHUNK + ty) * 19349663u;
+		r[i] = ((h >> 0) & 255) / 255.0f;
+		g[i] = ((h >> 8) & 255) / 255.0f;
+		b[i] = ((h >> 16) & 255) / 255.0f;
+
+		x[i] = origin.x + (tx + 0.45f) * tileSize;
+		y[i] = origin.y + (ty + 0.45f) * tileSize;
+		size[i] = tileSize * 0.9f;
+		zero[i] = 0.0f;
+		one[i] = 1.0f;
+	}
+
+	VkExample::SpriteArrays sprites = { x, y, zero, size, size, zero, r, g, b, one, zero, zero, one, one, count };
+
+	vertices.resize(count * 6);
+	spriteExpander.Expand(sprites, vertices.data());
+}
 
 /*-------------------------------------------------------------------------------------------------*/
 /* Main																							   */
 /*-------------------------------------------------------------------------------------------------*/
-void main()
+int main()
 {
 	/*-----------------------------------------------------------------------*/
 	/* Basic Setup					        								 */
@@ -32,11 +83,26 @@ void main()
 	/*-----------------------------------------------------------------------*/
 	/* World & Rendering Setup					        					 */
 	/*-----------------------------------------------------------------------*/
-	VkExample::Camera* camera = new VkExample::Camera({ 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f, 0.0f }, 1.0f, 0.001f, 1000.0f);
+	VkExample::Camera* camera = new VkExample::Camera({ 0.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, 0.0f, 0.0f }, 1.0f, 0.001f, 1000.0f);
 	VkExample::Renderer* renderer = new VkExample::Renderer({ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR },
 												SCREEN_WIDTH, SCREEN_HEIGHT, "VkExample", camera);
 	GLFWwindow* window = renderer->GetWindow();
 
+	const std::vector<VkExample::StartupPhase>& phases = renderer->GetStartupPhases();
+	for (int i = 0; i < phases.size(); i++)
+	{
+		std::cout << phases[i].name << ": " << std::fixed << std::setprecision(2) << phases[i].ms << " ms" << std::endl;
+	}
+	std::cout << std::defaultfloat;
+	VkExample::ChunkStreamer* streamer = new VkExample::ChunkStreamer(renderer, camera, GenerateChunk);
+
+	/*
+		The loop runs at TARGET_FRAME_RATE (0 for uncapped) rather than as
+		fast as it can.
+	*/
+	VkExample::FramePacer* pacer = new VkExample::FramePacer(TARGET_FRAME_RATE);
+	renderer->SetFramePacer(pacer);
+
 	/*-----------------------------------------------------------------------*/
 	/* Main Loop        													 */
 	/*-----------------------------------------------------------------------*/
@@ -49,27 +115,58 @@ void main()
 	while (!glfwWindowShouldClose(window))
 	{
 		/* Delta Time -------------------------------------------------------*/
+		pacer->Wait();
+		VkExample::Profiler::MarkFrame();
+
 		double nowTime = glfwGetTime();
 		deltaTime = nowTime - lastTime;
 		lastTime = nowTime;
 		sumTime += deltaTime;
-		frameRate++;
 
 		if (sumTime > 1.0)
 		{
 			sumTime = 0.0;
-			std::cout << "FPS: " << frameRate << std::endl;
+			/*
+				The average hides stutter, so print the frame-time
+				distribution alongside it.
+			*/
+			VkExample::TimingStats frameStats = VkExample::Profiler::GetFrameStats();
+			VkExample::CullStats cullStats = renderer->GetCullStats();
+			VkExample::StreamerStats streamStats = streamer->GetStats();
+			std::cout << "FPS: " << frameRate << std::fixed << std::setprecision(2)
+					  << " | frame ms p50: " << frameStats.p50Ms
+					  << " p99: " << frameStats.p99Ms
+					  << " max: " << frameStats.maxMs
+					  << " | chunks: " << cullStats.visibleChunks << "/" << cullStats.chunkCount
+					  << " (" << cullStats.kernel << ")"
+					  << " | world chunks: " << streamStats.residentChunks
+					  << " (lod " << streamStats.lodLevel << ")" << std::endl;
+
+			/* Present intervals are only known when the driver reports them. */
+			VkExample::FramePacerStats paceStats = pacer->GetStats();
+			if (paceStats.presentSamples > 0 || paceStats.latencySamples > 0)
+			{
+				std::cout << "present ms mean: " << paceStats.presentMeanMs
+						  << " jitter: " << paceStats.presentJitterMs
+						  << " | latency ms mean: " << paceStats.latencyMeanMs
+						  << " p99: " << paceStats.latencyP99Ms << std::endl;
+			}
 			frameRate = 0;
 		}
 		/*-------------------------------------------------------------------*/
 
 		/* Render -----------------------------------------------------------*/
+		streamer->Update();
+		if (renderer->NeedsRedraw()) frameRate++;
 		renderer->Render();
 		/*-------------------------------------------------------------------*/
 
 		/* GLFW -------------------------------------------------------------*/
-		glfwPollEvents();
-		glfwSwapBuffers(window);
+		/*
+			Rendering on demand, this sleeps until there's something to
+			draw, but never while chunks are still loading in.
+		*/
+		renderer->WaitForEvents(streamer->GetStats().pendingChunks > 0 ? 0.0 : IDLE_WAIT_SECONDS);
 		/*-------------------------------------------------------------------*/
 	}
 
@@ -77,6 +174,16 @@ void main()
 	/* Shutdown         													 */
 	/*-----------------------------------------------------------------------*/
 	std::cout << "Shutting down VkExample. Have a wonderful day!" << std::endl;
+	std::cout << renderer->GetMemoryReport();
+
+	if (ENABLE_PROFILING && VkExample::Profiler::ExportChromeTrace(TRACE_PATH))
+	{
+		std::cout << "Wrote frame trace to " << TRACE_PATH << "." << std::endl;
+	}
 
+	delete(streamer);
 	delete(renderer);
+	delete(pacer);
+
+	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,845 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Allocator.cpp																										 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "allocator.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Utility Functions																		   */
+	/*---------------------------------------------------------------------------------------------*/
+	/* Bit Scans ------------------------------------------------------------*/
+	/*
+		Index of the highest and lowest set bit. Callers never pass zero.
+	*/
+	static uint32_t HighestBit(uint64_t v)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse64(&index, v);
+		return (uint32_t)index;
+#else
+		return 63u - (uint32_t)__builtin_clzll(v);
+#endif
+	}
+
+	static uint32_t LowestBit(uint64_t v)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, v);
+		return (uint32_t)index;
+#else
+		return (uint32_t)__builtin_ctzll(v);
+#endif
+	}
+
+	/* Count Bits -----------------------------------------------------------*/
+	static uint32_t CountBits(uint32_t v)
+	{
+		uint32_t count = 0;
+		for (; v != 0; v &= v - 1) count++;
+		return count;
+	}
+
+	/* Align Up -------------------------------------------------------------*/
+	static VkDeviceSize AlignUp(VkDeviceSize v, VkDeviceSize alignment)
+	{
+		return (v + alignment - 1) / alignment * alignment;
+	}
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Memory Allocator																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* TLSF Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Map Size -------------------------------------------------------------*/
+	/*
+		The first level is the power of two a size falls in; the second
+		level splits each power of two into 2^ALLOCATOR_SL_BITS linear
+		classes. Every size we deal with is a multiple of
+		ALLOCATOR_MIN_ALIGNMENT, so the first level is never smaller than
+		ALLOCATOR_SL_BITS.
+	*/
+	void MemoryAllocator::MapSize(VkDeviceSize size, uint32_t& fl, uint32_t& sl)
+	{
+		fl = HighestBit(size);
+		sl = (uint32_t)(size >> (fl - ALLOCATOR_SL_BITS)) ^ (1u << ALLOCATOR_SL_BITS);
+	}
+
+	/* New Node -------------------------------------------------------------*/
+	uint32_t MemoryAllocator::NewNode(Block* block)
+	{
+		if (!block->unusedNodes.empty())
+		{
+			uint32_t node = block->unusedNodes.back();
+			block->unusedNodes.pop_back();
+			return node;
+		}
+
+		block->nodes.push_back({});
+		return (uint32_t)(block->nodes.size() - 1);
+	}
+
+	/* Insert Free ----------------------------------------------------------*/
+	void MemoryAllocator::InsertFree(Block* block, uint32_t node)
+	{
+		uint32_t fl, sl;
+		MapSize(block->nodes[node].size, fl, sl);
+
+		uint32_t head = block->freeHeads[fl][sl];
+		block->nodes[node].free = true;
+		block->nodes[node].prevFree = ALLOCATOR_NULL_INDEX;
+		block->nodes[node].nextFree = head;
+		if (head != ALLOCATOR_NULL_INDEX) block->nodes[head].prevFree = node;
+
+		block->freeHeads[fl][sl] = node;
+		block->slBitmaps[fl] |= 1u << sl;
+		block->flBitmap |= 1ull << fl;
+	}
+
+	/* Remove Free ----------------------------------------------------------*/
+	void MemoryAllocator::RemoveFree(Block* block, uint32_t node)
+	{
+		uint32_t fl, sl;
+		MapSize(block->nodes[node].size, fl, sl);
+
+		Node& n = block->nodes[node];
+		if (n.prevFree != ALLOCATOR_NULL_INDEX) block->nodes[n.prevFree].nextFree = n.nextFree;
+		else block->freeHeads[fl][sl] = n.nextFree;
+		if (n.nextFree != ALLOCATOR_NULL_INDEX) block->nodes[n.nextFree].prevFree = n.prevFree;
+
+		if (block->freeHeads[fl][sl] == ALLOCATOR_NULL_INDEX)
+		{
+			block->slBitmaps[fl] &= ~(1u << sl);
+			if (block->slBitmaps[fl] == 0) block->flBitmap &= ~(1ull << fl);
+		}
+
+		n.free = false;
+		n.prevFree = ALLOCATOR_NULL_INDEX;
+		n.nextFree = ALLOCATOR_NULL_INDEX;
+	}
+
+	/* Find Free ------------------------------------------------------------*/
+	/*
+		We round the request up to the next size class so that any range in
+		the class we land on is guaranteed to be large enough (good fit),
+		then look for the first non-empty class at or above it.
+	*/
+	uint32_t MemoryAllocator::FindFree(Block* block, VkDeviceSize size)
+	{
+		VkDeviceSize rounded = size + (1ull << (HighestBit(size) - ALLOCATOR_SL_BITS)) - 1;
+
+		uint32_t fl, sl;
+		MapSize(rounded, fl, sl);
+
+		uint32_t slMap = block->slBitmaps[fl] & (~0u << sl);
+		if (slMap == 0)
+		{
+			uint64_t flMap = (fl + 1 < ALLOCATOR_FL_COUNT) ? block->flBitmap & (~0ull << (fl + 1)) : 0;
+			if (flMap == 0) return ALLOCATOR_NULL_INDEX;
+
+			fl = LowestBit(flMap);
+			slMap = block->slBitmaps[fl];
+		}
+
+		sl = LowestBit(slMap);
+		return block->freeHeads[fl][sl];
+	}
+
+	/* Allocate From Block --------------------------------------------------*/
+	bool MemoryAllocator::AllocateFromBlock(uint32_t blockIndex, VkDeviceSize size, VkDeviceSize alignment, Allocation& allocation)
+	{
+		Block* block = blocks[blockIndex].get();
+		if (block == nullptr || block->flBitmap == 0) return false;
+
+		/*
+			The good-fit search ignores alignment. If the range it finds
+			cannot hold the request once aligned, search again with enough
+			slack for the worst-case padding.
+		*/
+		uint32_t node = FindFree(block, size);
+		if (node != ALLOCATOR_NULL_INDEX)
+		{
+			Node& n = block->nodes[node];
+			if (AlignUp(n.offset, alignment) + size > n.offset + n.size) node = ALLOCATOR_NULL_INDEX;
+		}
+
+		if (node == ALLOCATOR_NULL_INDEX && alignment > ALLOCATOR_MIN_ALIGNMENT)
+		{
+			node = FindFree(block, size + alignment - ALLOCATOR_MIN_ALIGNMENT);
+		}
+
+		if (node == ALLOCATOR_NULL_INDEX) return false;
+
+		RemoveFree(block, node);
+
+		/*
+			Any padding in front of the aligned offset becomes its own free
+			range. Its physical predecessor cannot be free (free neighbours
+			are always merged), so there is nothing to merge it with.
+		*/
+		VkDeviceSize alignedOffset = AlignUp(block->nodes[node].offset, alignment);
+		VkDeviceSize padding = alignedOffset - block->nodes[node].offset;
+		if (padding > 0)
+		{
+			uint32_t front = NewNode(block);
+			Node& n = block->nodes[node];
+			Node& f = block->nodes[front];
+			f.offset = n.offset;
+			f.size = padding;
+			f.prevPhysical = n.prevPhysical;
+			f.nextPhysical = node;
+			if (n.prevPhysical != ALLOCATOR_NULL_INDEX) block->nodes[n.prevPhysical].nextPhysical = front;
+			n.prevPhysical = front;
+			n.offset = alignedOffset;
+			n.size -= padding;
+			InsertFree(block, front);
+		}
+
+		/* Likewise, whatever is left past the end becomes a free range. */
+		VkDeviceSize remainder = block->nodes[node].size - size;
+		if (remainder >= ALLOCATOR_MIN_ALIGNMENT)
+		{
+			uint32_t back = NewNode(block);
+			Node& n = block->nodes[node];
+			Node& b = block->nodes[back];
+			b.offset = n.offset + size;
+			b.size = remainder;
+			b.prevPhysical = node;
+			b.nextPhysical = n.nextPhysical;
+			if (n.nextPhysical != ALLOCATOR_NULL_INDEX) block->nodes[n.nextPhysical].prevPhysical = back;
+			n.nextPhysical = back;
+			n.size = size;
+			InsertFree(block, back);
+		}
+
+		Node& n = block->nodes[node];
+		block->allocationCount++;
+		block->bytesUsed += n.size;
+
+		allocation.memory = block->memory;
+		allocation.offset = n.offset;
+		allocation.size = n.size;
+		allocation.alignment = alignment;
+		allocation.mapped = (block->mapped != nullptr) ? (char*)block->mapped + n.offset : nullptr;
+		allocation.memoryType = block->memoryType;
+		allocation.block = blockIndex;
+		allocation.node = node;
+		return true;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Block Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Preferred Block Size -------------------------------------------------*/
+	/*
+		Small heaps (integrated GPUs, the 256 MB BAR window) get an eighth of
+		the heap per block so that one block cannot starve everybody else.
+	*/
+	VkDeviceSize MemoryAllocator::PreferredBlockSize(uint32_t memoryType)
+	{
+		VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryType].heapIndex].size;
+		VkDeviceSize blockSize = (heapSize <= ALLOCATOR_SMALL_HEAP_SIZE) ? heapSize / 8 : ALLOCATOR_BLOCK_SIZE;
+		return AlignUp(std::max<VkDeviceSize>(blockSize, ALLOCATOR_MIN_ALIGNMENT), ALLOCATOR_MIN_ALIGNMENT);
+	}
+
+	/* Create Block ---------------------------------------------------------*/
+	uint32_t MemoryAllocator::CreateBlock(uint32_t memoryType, VkDeviceSize size, bool dedicated)
+	{
+		if (deviceMemoryLimit > 0 && deviceMemoryCount >= deviceMemoryLimit)
+		{
+			throw std::runtime_error("Exceeded the device's memory allocation limit.");
+		}
+
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = size;
+		allocInfo.memoryTypeIndex = memoryType;
+
+		/*
+			If the driver turns us down, ask the pressure handlers to give
+			something back on this heap and try once more.
+		*/
+		std::unique_ptr<Block> block = std::make_unique<Block>();
+		VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, &block->memory);
+		if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY)
+		{
+			RelievePressure(GetHeapIndex(memoryType), size);
+			result = vkAllocateMemory(device, &allocInfo, nullptr, &block->memory);
+		}
+
+		if (result != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to allocate device memory block.");
+		}
+
+		/*
+			Host-visible blocks are mapped once for their whole lifetime.
+			A VkDeviceMemory can only be mapped once, so the allocations
+			inside it must share this mapping rather than map themselves.
+		*/
+		block->mapped = nullptr;
+		if (GetMemoryTypeFlags(memoryType) & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		{
+			if (vkMapMemory(device, block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped) != VK_SUCCESS)
+			{
+				vkFreeMemory(device, block->memory, nullptr);
+				throw std::runtime_error("Failed to map device memory block.");
+			}
+		}
+
+		block->size = size;
+		block->memoryType = memoryType;
+		block->dedicated = dedicated;
+		block->flBitmap = 0;
+		block->slBitmaps.fill(0);
+		for (int i = 0; i < ALLOCATOR_FL_COUNT; i++) block->freeHeads[i].fill(ALLOCATOR_NULL_INDEX);
+		block->allocationCount = 0;
+		block->bytesUsed = 0;
+
+		block->nodes.push_back({ 0, size, ALLOCATOR_NULL_INDEX, ALLOCATOR_NULL_INDEX, ALLOCATOR_NULL_INDEX, ALLOCATOR_NULL_INDEX, false });
+		InsertFree(block.get(), 0);
+
+		deviceMemoryCount++;
+		heapReserved[GetHeapIndex(memoryType)] += size;
+
+		for (int i = 0; i < blocks.size(); i++)
+		{
+			if (blocks[i] == nullptr)
+			{
+				blocks[i] = std::move(block);
+				return (uint32_t)i;
+			}
+		}
+
+		blocks.push_back(std::move(block));
+		return (uint32_t)(blocks.size() - 1);
+	}
+
+	/* Destroy Block --------------------------------------------------------*/
+	void MemoryAllocator::DestroyBlock(uint32_t blockIndex)
+	{
+		Block* block = blocks[blockIndex].get();
+		if (block == nullptr) return;
+
+		if (block->mapped != nullptr) vkUnmapMemory(device, block->memory);
+		vkFreeMemory(device, block->memory, nullptr);
+		heapReserved[GetHeapIndex(block->memoryType)] -= block->size;
+		blocks[blockIndex].reset();
+		deviceMemoryCount--;
+	}
+
+	/* Release Empty Blocks -------------------------------------------------*/
+	/*
+		Keeping one empty block around per memory type stops a single
+		allocation that comes and goes from allocating a block every time.
+	*/
+	void MemoryAllocator::ReleaseEmptyBlocks(uint32_t memoryType, bool keepOne)
+	{
+		bool kept = !keepOne;
+		for (int i = 0; i < blocks.size(); i++)
+		{
+			Block* block = blocks[i].get();
+			if (block == nullptr || block->memoryType != memoryType || block->allocationCount > 0) continue;
+
+			if (!kept && !block->dedicated)
+			{
+				kept = true;
+				continue;
+			}
+
+			DestroyBlock((uint32_t)i);
+		}
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Budget Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Estimate Heap Usage --------------------------------------------------*/
+	/*
+		The budget is only queried every so often. In between, we assume
+		that the only thing that changed on a heap is what we allocated or
+		freed ourselves.
+	*/
+	VkDeviceSize MemoryAllocator::EstimateHeapUsage(uint32_t heapIndex)
+	{
+		VkDeviceSize usage = budget.heaps[heapIndex].usage;
+		if (heapReserved[heapIndex] >= heapReservedAtQuery[heapIndex]) return usage + (heapReserved[heapIndex] - heapReservedAtQuery[heapIndex]);
+
+		VkDeviceSize released = heapReservedAtQuery[heapIndex] - heapReserved[heapIndex];
+		return (usage > released) ? usage - released : 0;
+	}
+
+	/* Check Budget ---------------------------------------------------------*/
+	/*
+		Called before we reserve a new block. If the block would take the
+		heap over budget, the pressure handlers get a chance to make room.
+		Returns true if they were asked, in which case some of our existing
+		blocks may have room again. The budget is soft: if the handlers
+		cannot make enough room, the block is allocated anyway and counted
+		as an overrun.
+	*/
+	bool MemoryAllocator::CheckBudget(uint32_t memoryType, VkDeviceSize size)
+	{
+		uint32_t heapIndex = GetHeapIndex(memoryType);
+		VkDeviceSize heapBudget = budget.heaps[heapIndex].budget;
+		VkDeviceSize usage = EstimateHeapUsage(heapIndex) + size;
+		if (usage <= heapBudget || relievingPressure) return false;
+
+		RelievePressure(heapIndex, usage - heapBudget);
+		if (EstimateHeapUsage(heapIndex) + size > heapBudget) budgetOverruns++;
+		return true;
+	}
+
+	/* Relieve Pressure -----------------------------------------------------*/
+	/*
+		Empty blocks we were keeping around for reuse are the cheapest thing
+		to give back, so they go first. After that, each handler whose
+		category has memory on the heap is asked in turn until enough has
+		been released.
+	*/
+	void MemoryAllocator::RelievePressure(uint32_t heapIndex, VkDeviceSize bytesNeeded)
+	{
+		if (relievingPressure) return;
+		relievingPressure = true;
+		pressureEvents++;
+
+		VkDeviceSize before = heapReserved[heapIndex];
+		for (int i = -1; i < (int)pressureHandlers.size(); i++)
+		{
+			if (i >= 0)
+			{
+				VkDeviceSize released = (before > heapReserved[heapIndex]) ? before - heapReserved[heapIndex] : 0;
+				if (released >= bytesNeeded) break;
+				if (heapCategoryBytes[heapIndex][pressureHandlers[i].first] == 0) continue;
+				pressureHandlers[i].second(heapIndex, bytesNeeded - released);
+			}
+
+			for (uint32_t memoryType = 0; memoryType < memoryProperties.memoryTypeCount; memoryType++)
+			{
+				if (GetHeapIndex(memoryType) == heapIndex) ReleaseEmptyBlocks(memoryType, false);
+			}
+		}
+
+		relievingPressure = false;
+	}
+
+	/* Track Allocation -----------------------------------------------------*/
+	void MemoryAllocator::TrackAllocation(const Allocation& allocation, bool add)
+	{
+		VkDeviceSize& heapBytes = heapCategoryBytes[GetHeapIndex(allocation.memoryType)][allocation.category];
+		if (add)
+		{
+			categoryBytes[allocation.category] += allocation.size;
+			categoryAllocations[allocation.category]++;
+			heapBytes += allocation.size;
+		}
+		else
+		{
+			categoryBytes[allocation.category] -= allocation.size;
+			categoryAllocations[allocation.category]--;
+			heapBytes -= allocation.size;
+		}
+	}
+
+	/* Update Budget --------------------------------------------------------*/
+	/*
+		UpdateBudget() re-reads the heap budgets from the driver. If a heap is
+		past ALLOCATOR_BUDGET_PRESSURE of its budget, the pressure handlers
+		are asked to bring it back under, before an allocation actually
+		fails or the driver starts paging.
+	*/
+	void MemoryAllocator::UpdateBudget()
+	{
+		budget.heapCount = memoryProperties.memoryHeapCount;
+		budget.fromDriver = (getMemoryProperties2 != nullptr);
+
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+		budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+		if (budget.fromDriver)
+		{
+			VkPhysicalDeviceMemoryProperties2KHR properties2{};
+			properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+			properties2.pNext = &budgetProperties;
+			getMemoryProperties2(physicalDevice, &properties2);
+		}
+
+		for (int i = 0; i < budget.heapCount; i++)
+		{
+			HeapBudget& heap = budget.heaps[i];
+			heap.size = memoryProperties.memoryHeaps[i].size;
+			heap.allocatorBytes = heapReserved[i];
+			heapReservedAtQuery[i] = heapReserved[i];
+
+			if (budget.fromDriver)
+			{
+				heap.budget = budgetProperties.heapBudget[i];
+				heap.usage = budgetProperties.heapUsage[i];
+			}
+			else
+			{
+				heap.budget = (VkDeviceSize)((double)heap.size * ALLOCATOR_FALLBACK_BUDGET);
+				heap.usage = heapReserved[i];
+			}
+		}
+
+		for (int i = 0; i < budget.heapCount; i++)
+		{
+			VkDeviceSize threshold = (VkDeviceSize)((double)budget.heaps[i].budget * ALLOCATOR_BUDGET_PRESSURE);
+			VkDeviceSize usage = EstimateHeapUsage(i);
+			if (usage > threshold) RelievePressure(i, usage - threshold);
+		}
+	}
+
+	/* Get Budget -----------------------------------------------------------*/
+	MemoryBudget MemoryAllocator::GetBudget()
+	{
+		MemoryBudget current = budget;
+		for (int i = 0; i < current.heapCount; i++)
+		{
+			current.heaps[i].usage = EstimateHeapUsage(i);
+			current.heaps[i].allocatorBytes = heapReserved[i];
+		}
+		return current;
+	}
+
+	/* Add Pressure Handler -------------------------------------------------*/
+	void MemoryAllocator::AddPressureHandler(MemoryCategory category, MemoryPressureFunction handler)
+	{
+		pressureHandlers.push_back({ category, handler });
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Memory Type Functions												 */
+	/*-----------------------------------------------------------------------*/
+	/* Find Memory Type -----------------------------------------------------*/
+	/*
+		Of the types that have every required flag, we want the one with the
+		most preferred flags. Between those, the one with the fewest flags
+		nobody asked for wins, so that plain device-local buffers stay out
+		of the host-visible BAR window and staging buffers stay out of
+		VRAM. Last of all, we go with the heap that has the most room left
+		in its budget.
+	*/
+	uint32_t MemoryAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred)
+	{
+		uint32_t bestType = ALLOCATOR_NULL_INDEX;
+		int bestScore = 0;
+		VkDeviceSize bestRoom = 0;
+
+		for (int i = 0; i < memoryProperties.memoryTypeCount; i++)
+		{
+			VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[i].propertyFlags;
+			if (!(typeFilter & (1 << i)) || (flags & required) != required) continue;
+
+			int score = (int)CountBits(flags & preferred) * 64 - (int)CountBits(flags & ~(required | preferred));
+
+			uint32_t heapIndex = GetHeapIndex(i);
+			VkDeviceSize usage = EstimateHeapUsage(heapIndex);
+			VkDeviceSize room = (budget.heaps[heapIndex].budget > usage) ? budget.heaps[heapIndex].budget - usage : 0;
+
+			if (bestType == ALLOCATOR_NULL_INDEX || score > bestScore || (score == bestScore && room > bestRoom))
+			{
+				bestType = i;
+				bestScore = score;
+				bestRoom = room;
+			}
+		}
+
+		if (bestType == ALLOCATOR_NULL_INDEX) throw std::runtime_error("Failed to find suitable memory type.");
+		return bestType;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Allocation Functions													 */
+	/*-----------------------------------------------------------------------*/
+	/* Allocate -------------------------------------------------------------*/
+	/*
+		Linear resources are buffers and linearly tiled images; everything
+		else (optimally tiled images) is non-linear. The two must not share
+		a bufferImageGranularity page, so non-linear allocations are padded
+		out to whole pages on both ends.
+	*/
+	Allocation MemoryAllocator::Allocate(VkMemoryRequirements requirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, bool linear, MemoryCategory category)
+	{
+		VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, ALLOCATOR_MIN_ALIGNMENT);
+		VkDeviceSize size = AlignUp(std::max<VkDeviceSize>(requirements.size, 1), ALLOCATOR_MIN_ALIGNMENT);
+
+		if (!linear && bufferImageGranularity > ALLOCATOR_MIN_ALIGNMENT)
+		{
+			alignment = std::max(alignment, bufferImageGranularity);
+			size = AlignUp(size, bufferImageGranularity);
+		}
+
+		uint32_t memoryType = FindMemoryType(requirements.memoryTypeBits, required, preferred);
+		VkDeviceSize blockSize = PreferredBlockSize(memoryType);
+
+		Allocation allocation;
+		allocation.category = category;
+
+		/* Large resources get a block of their own. */
+		if (size > blockSize / 2)
+		{
+			CheckBudget(memoryType, AlignUp(size, alignment));
+			uint32_t blockIndex = CreateBlock(memoryType, AlignUp(size, alignment), true);
+			AllocateFromBlock(blockIndex, size, alignment, allocation);
+			TrackAllocation(allocation, true);
+			return allocation;
+		}
+
+		/*
+			If there is no room in our blocks and a new one would go over
+			budget, the pressure handlers may free up room in the blocks we
+			already have, so look through them once more.
+		*/
+		for (int attempt = 0; attempt < 2; attempt++)
+		{
+			for (int i = 0; i < blocks.size(); i++)
+			{
+				Block* block = blocks[i].get();
+				if (block == nullptr || block->dedicated || block->memoryType != memoryType) continue;
+				if (AllocateFromBlock((uint32_t)i, size, alignment, allocation))
+				{
+					TrackAllocation(allocation, true);
+					return allocation;
+				}
+			}
+
+			if (attempt > 0 || !CheckBudget(memoryType, blockSize)) break;
+		}
+
+		uint32_t blockIndex = CreateBlock(memoryType, blockSize, false);
+		if (!AllocateFromBlock(blockIndex, size, alignment, allocation))
+		{
+			throw std::runtime_error("Failed to sub-allocate from a new memory block.");
+		}
+
+		TrackAllocation(allocation, true);
+		return allocation;
+	}
+
+	/* Free -----------------------------------------------------------------*/
+	void MemoryAllocator::Free(Allocation& allocation)
+	{
+		if (allocation.block == ALLOCATOR_NULL_INDEX) return;
+
+		Block* block = blocks[allocation.block].get();
+		uint32_t node = allocation.node;
+
+		TrackAllocation(allocation, false);
+		block->allocationCount--;
+		block->bytesUsed -= block->nodes[node].size;
+
+		/* Merge with the next range if it is free. */
+		uint32_t next = block->nodes[node].nextPhysical;
+		if (next != ALLOCATOR_NULL_INDEX && block->nodes[next].free)
+		{
+			RemoveFree(block, next);
+			block->nodes[node].size += block->nodes[next].size;
+			block->nodes[node].nextPhysical = block->nodes[next].nextPhysical;
+			if (block->nodes[next].nextPhysical != ALLOCATOR_NULL_INDEX) block->nodes[block->nodes[next].nextPhysical].prevPhysical = node;
+			block->nodes[next].size = 0;
+			block->unusedNodes.push_back(next);
+		}
+
+		/* And with the previous one. */
+		uint32_t prev = block->nodes[node].prevPhysical;
+		if (prev != ALLOCATOR_NULL_INDEX && block->nodes[prev].free)
+		{
+			RemoveFree(block, prev);
+			block->nodes[prev].size += block->nodes[node].size;
+			block->nodes[prev].nextPhysical = block->nodes[node].nextPhysical;
+			if (block->nodes[node].nextPhysical != ALLOCATOR_NULL_INDEX) block->nodes[block->nodes[node].nextPhysical].prevPhysical = prev;
+			block->nodes[node].size = 0;
+			block->unusedNodes.push_back(node);
+			node = prev;
+		}
+
+		InsertFree(block, node);
+
+		uint32_t memoryType = block->memoryType;
+		if (block->allocationCount == 0)
+		{
+			if (block->dedicated) DestroyBlock(allocation.block);
+			else ReleaseEmptyBlocks(memoryType, true);
+		}
+
+		allocation = Allocation();
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Stats & Defragmentation Functions									 */
+	/*-----------------------------------------------------------------------*/
+	/* Get Stats ------------------------------------------------------------*/
+	AllocatorStats MemoryAllocator::GetStats()
+	{
+		AllocatorStats stats{};
+		stats.deviceMemoryCount = deviceMemoryCount;
+		stats.deviceMemoryLimit = deviceMemoryLimit;
+		stats.pressureEvents = pressureEvents;
+		stats.budgetOverruns = budgetOverruns;
+		stats.categoryBytes = categoryBytes;
+		stats.categoryAllocations = categoryAllocations;
+
+		for (int i = 0; i < blocks.size(); i++)
+		{
+			Block* block = blocks[i].get();
+			if (block == nullptr) continue;
+
+			MemoryTypeStats& typeStats = stats.memoryTypes[block->memoryType];
+			typeStats.blockCount++;
+			typeStats.allocationCount += block->allocationCount;
+			typeStats.bytesReserved += block->size;
+			typeStats.bytesUsed += block->bytesUsed;
+
+			for (int j = 0; j < block->nodes.size(); j++)
+			{
+				const Node& n = block->nodes[j];
+				if (!n.free || n.size == 0) continue;
+				typeStats.freeRangeCount++;
+				typeStats.largestFreeRange = std::max(typeStats.largestFreeRange, n.size);
+			}
+
+			stats.allocationCount += block->allocationCount;
+			stats.bytesReserved += block->size;
+			stats.bytesUsed += block->bytesUsed;
+		}
+
+		return stats;
+	}
+
+	/* Defragment -----------------------------------------------------------*/
+	/*
+		Defragment() tries to empty the least-used blocks of each memory
+		type by moving the given allocations into the fuller ones, then
+		releases whatever blocks end up empty. Only the allocations passed
+		in are moved; the caller is responsible for making sure the GPU is
+		not using them. Returns the number of bytes moved.
+	*/
+	VkDeviceSize MemoryAllocator::Defragment(std::vector<Allocation*> allocations, DefragmentMoveFunction move)
+	{
+		VkDeviceSize bytesMoved = 0;
+
+		for (uint32_t memoryType = 0; memoryType < memoryProperties.memoryTypeCount; memoryType++)
+		{
+			std::vector<uint32_t> order;
+			for (int i = 0; i < blocks.size(); i++)
+			{
+				if (blocks[i] != nullptr && !blocks[i]->dedicated && blocks[i]->memoryType == memoryType) order.push_back((uint32_t)i);
+			}
+
+			if (order.size() < 2) continue;
+
+			std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return blocks[a]->bytesUsed > blocks[b]->bytesUsed; });
+
+			bool stuck = false;
+			for (int src = (int)order.size() - 1; src > 0 && !stuck; src--)
+			{
+				for (int i = 0; i < allocations.size() && !stuck; i++)
+				{
+					Allocation* allocation = allocations[i];
+					if (allocation->block != order[src]) continue;
+
+					Allocation moved;
+					bool placed = false;
+					for (int dst = 0; dst < src && !placed; dst++)
+					{
+						placed = AllocateFromBlock(order[dst], allocation->size, allocation->alignment, moved);
+					}
+
+					if (!placed)
+					{
+						stuck = true;
+						break;
+					}
+
+					moved.category = allocation->category;
+					TrackAllocation(moved, true);
+
+					move(*allocation, moved);
+					bytesMoved += allocation->size;
+					Free(*allocation);
+					*allocation = moved;
+				}
+			}
+
+			ReleaseEmptyBlocks(memoryType, false);
+		}
+
+		return bytesMoved;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Constructor															 */
+	/*-----------------------------------------------------------------------*/
+	MemoryAllocator::MemoryAllocator(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, bool memoryBudget)
+	{
+		this->physicalDevice = physicalDevice;
+		this->device = device;
+		this->deviceMemoryCount = 0;
+		this->relievingPressure = false;
+		this->pressureEvents = 0;
+		this->budgetOverruns = 0;
+
+		heapReserved.fill(0);
+		heapReservedAtQuery.fill(0);
+		categoryBytes.fill(0);
+		categoryAllocations.fill(0);
+		for (int i = 0; i < VK_MAX_MEMORY_HEAPS; i++) heapCategoryBytes[i].fill(0);
+
+		/*
+			VK_EXT_memory_budget is read through vkGetPhysicalDeviceMemoryProperties2,
+			which on a 1.0 instance comes from VK_KHR_get_physical_device_properties2.
+		*/
+		this->getMemoryProperties2 = nullptr;
+		if (memoryBudget)
+		{
+			getMemoryProperties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+		}
+
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		this->bufferImageGranularity = properties.limits.bufferImageGranularity;
+		this->deviceMemoryLimit = properties.limits.maxMemoryAllocationCount;
+
+		/*
+			Integrated GPUs and discrete GPUs with resizable BAR expose memory
+			that is both device-local and host-visible, and lots of it. Plain
+			discrete GPUs usually expose it too, but only through a 256 MB
+			window that is better left for small things like uniforms.
+		*/
+		this->directWriteTypes = 0;
+		VkMemoryPropertyFlags directFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		for (int i = 0; i < memoryProperties.memoryTypeCount; i++)
+		{
+			if ((memoryProperties.memoryTypes[i].propertyFlags & directFlags) != directFlags) continue;
+			if (memoryProperties.memoryHeaps[GetHeapIndex(i)].size > ALLOCATOR_BAR_WINDOW_SIZE) directWriteTypes |= 1u << i;
+		}
+
+		UpdateBudget();
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Deconstructor														 */
+	/*-----------------------------------------------------------------------*/
+	MemoryAllocator::~MemoryAllocator()
+	{
+		for (int i = 0; i < blocks.size(); i++) DestroyBlock((uint32_t)i);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,314 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Allocator.h																											 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Defines																						   */
+/*-------------------------------------------------------------------------------------------------*/
+
+#define ALLOCATOR_BLOCK_SIZE (64ull * 1024 * 1024)
+#define ALLOCATOR_SMALL_HEAP_SIZE (1024ull * 1024 * 1024)
+#define ALLOCATOR_MIN_ALIGNMENT 256ull
+#define ALLOCATOR_SL_BITS 4
+#define ALLOCATOR_FL_COUNT 64
+#define ALLOCATOR_NULL_INDEX 0xFFFFFFFFu
+#define ALLOCATOR_BUDGET_PRESSURE 0.9
+#define ALLOCATOR_FALLBACK_BUDGET 0.8
+#define ALLOCATOR_BAR_WINDOW_SIZE (256ull * 1024 * 1024)
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Helper Structs																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Memory Category														 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		Every allocation is tagged with what it is used for, so that usage
+		can be reported per category and pressure handlers know what they
+		are giving back.
+	*/
+	enum MemoryCategory
+	{
+		MEMORY_CATEGORY_VERTEX,
+		MEMORY_CATEGORY_STAGING,
+		MEMORY_CATEGORY_UNIFORM,
+		MEMORY_CATEGORY_TEXTURE,
+		MEMORY_CATEGORY_OTHER,
+		MEMORY_CATEGORY_COUNT
+	};
+
+	static const char* MemoryCategoryName(MemoryCategory category)
+	{
+		static const char* names[MEMORY_CATEGORY_COUNT] = { "Vertex", "Staging", "Uniform", "Texture", "Other" };
+		return names[category];
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Allocation															 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		An allocation is a range inside one of the allocator's blocks. The
+		memory, offset and mapped pointer are all a caller needs to bind and
+		write a resource; block and node let the allocator find its way
+		back when the allocation is freed.
+	*/
+	struct Allocation
+	{
+		VkDeviceMemory	memory = VK_NULL_HANDLE;
+		VkDeviceSize	offset = 0;
+		VkDeviceSize	size = 0;
+		VkDeviceSize	alignment = 0;
+		void*			mapped = nullptr;
+		uint32_t		memoryType = 0;
+		MemoryCategory	category = MEMORY_CATEGORY_OTHER;
+		uint32_t		block = ALLOCATOR_NULL_INDEX;
+		uint32_t		node = ALLOCATOR_NULL_INDEX;
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* Allocator Stats														 */
+	/*-----------------------------------------------------------------------*/
+	struct MemoryTypeStats
+	{
+		uint32_t		blockCount;
+		uint32_t		allocationCount;
+		uint32_t		freeRangeCount;
+		VkDeviceSize	bytesReserved;
+		VkDeviceSize	bytesUsed;
+		VkDeviceSize	largestFreeRange;
+	};
+
+	struct AllocatorStats
+	{
+		uint32_t										deviceMemoryCount;
+		uint32_t										deviceMemoryLimit;
+		uint32_t										allocationCount;
+		VkDeviceSize									bytesReserved;
+		VkDeviceSize									bytesUsed;
+		uint32_t										pressureEvents;
+		uint32_t										budgetOverruns;
+		std::array<MemoryTypeStats, VK_MAX_MEMORY_TYPES>	memoryTypes;
+		std::array<VkDeviceSize, MEMORY_CATEGORY_COUNT>	categoryBytes;
+		std::array<uint32_t, MEMORY_CATEGORY_COUNT>		categoryAllocations;
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* Memory Budget														 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		With VK_EXT_memory_budget the driver tells us how much of each heap
+		we may use (budget) and how much the whole process is using (usage),
+		which on integrated GPUs includes memory shared with the rest of the
+		system. Without it, we fall back to a fixed share of the heap size
+		and only know about our own blocks.
+	*/
+	struct HeapBudget
+	{
+		VkDeviceSize	size;
+		VkDeviceSize	budget;
+		VkDeviceSize	usage;
+		VkDeviceSize	allocatorBytes;
+	};
+
+	struct MemoryBudget
+	{
+		bool										fromDriver;
+		uint32_t									heapCount;
+		std::array<HeapBudget, VK_MAX_MEMORY_HEAPS>	heaps;
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* Memory Pressure														 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		Pressure handlers are asked to give memory on a heap back when usage
+		nears the budget: shrink a staging buffer, drop cold atlas pages and
+		so on. Each gives back memory of one category, and is only called
+		for heaps that category has allocations on. They are called in the
+		order they were added, so cheap things to lose should be added
+		first.
+	*/
+	typedef std::function<void(uint32_t heapIndex, VkDeviceSize bytesNeeded)> MemoryPressureFunction;
+
+	/*-----------------------------------------------------------------------*/
+	/* Defragmentation														 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		The allocator cannot move resources by itself: it only knows about
+		memory. During defragmentation it hands the caller the old and new
+		ranges, and the caller recreates/rebinds the resource and copies
+		its contents across before the old range is released.
+	*/
+	typedef std::function<void(const Allocation& from, const Allocation& to)> DefragmentMoveFunction;
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Memory Allocator																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		Rather than calling vkAllocateMemory for every resource, we reserve
+		large blocks per memory type and carve them up with a two-level
+		segregated fit (TLSF) allocator. Finding a free range and freeing
+		one are both constant time per block, and neighbouring free ranges
+		are merged on free.
+	*/
+	class MemoryAllocator
+	{
+	private:
+		/*-------------------------------------------------------------------*/
+		/* Nodes & Blocks													 */
+		/*-------------------------------------------------------------------*/
+		/*
+			A node is a contiguous range of a block, either free or in use.
+			Nodes are linked to their physical neighbours (for merging) and,
+			while free, into the free list of their size class.
+		*/
+		struct Node
+		{
+			VkDeviceSize	offset;
+			VkDeviceSize	size;
+			uint32_t		prevPhysical;
+			uint32_t		nextPhysical;
+			uint32_t		prevFree;
+			uint32_t		nextFree;
+			bool			free;
+		};
+
+		struct Block
+		{
+			VkDeviceMemory										memory;
+			VkDeviceSize										size;
+			void*												mapped;
+			uint32_t											memoryType;
+			bool												dedicated;
+
+			std::vector<Node>									nodes;
+			std::vector<uint32_t>								unusedNodes;
+
+			uint64_t											flBitmap;
+			std::array<uint32_t, ALLOCATOR_FL_COUNT>			slBitmaps;
+			std::array<std::array<uint32_t, 1 << ALLOCATOR_SL_BITS>, ALLOCATOR_FL_COUNT>	freeHeads;
+
+			uint32_t											allocationCount;
+			VkDeviceSize										bytesUsed;
+		};
+
+		/*-------------------------------------------------------------------*/
+		/* Vulkan															 */
+		/*-------------------------------------------------------------------*/
+		VkPhysicalDevice					physicalDevice;
+		VkDevice							device;
+		VkPhysicalDeviceMemoryProperties	memoryProperties;
+		VkDeviceSize						bufferImageGranularity;
+		uint32_t							deviceMemoryLimit;
+		uint32_t							deviceMemoryCount;
+		uint32_t							directWriteTypes;
+
+		/*-------------------------------------------------------------------*/
+		/* Budget															 */
+		/*-------------------------------------------------------------------*/
+		PFN_vkGetPhysicalDeviceMemoryProperties2KHR		getMemoryProperties2;
+		MemoryBudget									budget;
+		std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS>	heapReserved;
+		std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS>	heapReservedAtQuery;
+		std::array<VkDeviceSize, MEMORY_CATEGORY_COUNT>	categoryBytes;
+		std::array<uint32_t, MEMORY_CATEGORY_COUNT>		categoryAllocations;
+		std::array<std::array<VkDeviceSize, MEMORY_CATEGORY_COUNT>, VK_MAX_MEMORY_HEAPS>	heapCategoryBytes;
+
+		/*-------------------------------------------------------------------*/
+		/* Pressure															 */
+		/*-------------------------------------------------------------------*/
+		std::vector<std::pair<MemoryCategory, MemoryPressureFunction>>	pressureHandlers;
+		bool											relievingPressure;
+		uint32_t										pressureEvents;
+		uint32_t										budgetOverruns;
+
+		/*-------------------------------------------------------------------*/
+		/* Blocks															 */
+		/*-------------------------------------------------------------------*/
+		std::vector<std::unique_ptr<Block>>	blocks;
+
+		/*-------------------------------------------------------------------*/
+		/* TLSF Functions													 */
+		/*-------------------------------------------------------------------*/
+		void								MapSize(VkDeviceSize size, uint32_t& fl, uint32_t& sl);
+		uint32_t							NewNode(Block* block);
+		void								InsertFree(Block* block, uint32_t node);
+		void								RemoveFree(Block* block, uint32_t node);
+		uint32_t							FindFree(Block* block, VkDeviceSize size);
+		bool								AllocateFromBlock(uint32_t blockIndex, VkDeviceSize size, VkDeviceSize alignment, Allocation& allocation);
+
+		/*-------------------------------------------------------------------*/
+		/* Block Functions													 */
+		/*-------------------------------------------------------------------*/
+		VkDeviceSize						PreferredBlockSize(uint32_t memoryType);
+		uint32_t							CreateBlock(uint32_t memoryType, VkDeviceSize size, bool dedicated);
+		void								DestroyBlock(uint32_t blockIndex);
+		void								ReleaseEmptyBlocks(uint32_t memoryType, bool keepOne);
+
+		/*-------------------------------------------------------------------*/
+		/* Budget Functions													 */
+		/*-------------------------------------------------------------------*/
+		VkDeviceSize						EstimateHeapUsage(uint32_t heapIndex);
+		bool								CheckBudget(uint32_t memoryType, VkDeviceSize size);
+		void								RelievePressure(uint32_t heapIndex, VkDeviceSize bytesNeeded);
+		void								TrackAllocation(const Allocation& allocation, bool add);
+
+	public:
+		/*-------------------------------------------------------------------*/
+		/* Memory Type Functions											 */
+		/*-------------------------------------------------------------------*/
+		uint32_t							FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred);
+		bool								SupportsDirectWrite(uint32_t typeFilter) { return (directWriteTypes & typeFilter) != 0; }
+		VkMemoryPropertyFlags				GetMemoryTypeFlags(uint32_t memoryType) { return memoryProperties.memoryTypes[memoryType].propertyFlags; }
+		uint32_t							GetHeapIndex(uint32_t memoryType) { return memoryProperties.memoryTypes[memoryType].heapIndex; }
+
+		/*-------------------------------------------------------------------*/
+		/* Allocation Functions												 */
+		/*-------------------------------------------------------------------*/
+		Allocation							Allocate(VkMemoryRequirements requirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, bool linear, MemoryCategory category);
+		void								Free(Allocation& allocation);
+
+		/*-------------------------------------------------------------------*/
+		/* Budget Functions													 */
+		/*-------------------------------------------------------------------*/
+		void								UpdateBudget();
+		MemoryBudget						GetBudget();
+		void								AddPressureHandler(MemoryCategory category, MemoryPressureFunction handler);
+
+		/*-------------------------------------------------------------------*/
+		/* Stats & Defragmentation Functions								 */
+		/*-------------------------------------------------------------------*/
+		AllocatorStats						GetStats();
+		VkDeviceSize						Defragment(std::vector<Allocation*> allocations, DefragmentMoveFunction move);
+
+		/*-------------------------------------------------------------------*/
+		/* Constructor														 */
+		/*-------------------------------------------------------------------*/
+		MemoryAllocator(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, bool memoryBudget);
+
+		/*-------------------------------------------------------------------*/
+		/* Deconstructor													 */
+		/*-------------------------------------------------------------------*/
+		~MemoryAllocator();
+	};
+}
+
+#endif
\ No newline at end of file
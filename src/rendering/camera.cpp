@@ -24,7 +24,10 @@ namespace VkExample
 	{
 		float halfWidth = (viewport.width / 2.0f) * zoom;
 		float halfHeight = (viewport.height / 2.0f) * zoom;
-		projection = glm::ortho(-halfWidth, halfWidth, -halfWidth, halfHeight, nearClip, farClip);
+		projection = glm::ortho(-halfWidth, halfWidth, -halfHeight, halfHeight, nearClip, farClip);
+
+		projectionDirty = false;
+		viewProjectionDirty = true;
 	}
 
 	/* Update View ----------------------------------------------------------*/
@@ -33,6 +36,24 @@ namespace VkExample
 		glm::vec3 forward = glm::vec3(0.0f, 0.0f, 1.0f) * rotation;
 		glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f) * rotation;
 		view = glm::lookAt(position, position + forward, up);
+
+		viewDirty = false;
+		viewProjectionDirty = true;
+	}
+
+	/* Get View Projection --------------------------------------------------*/
+	glm::mat4 Camera::GetViewProjection()
+	{
+		if (projectionDirty) UpdateProjection();
+		if (viewDirty) UpdateView();
+
+		if (viewProjectionDirty)
+		{
+			viewProjection = projection * view;
+			viewProjectionDirty = false;
+		}
+
+		return viewProjection;
 	}
 
 	/*-----------------------------------------------------------------------*/
@@ -51,5 +72,9 @@ namespace VkExample
 
 		this->view = glm::mat4(0);
 		this->projection = glm::mat4(0);
+		this->viewProjection = glm::mat4(0);
+		this->projectionDirty = true;
+		this->viewDirty = true;
+		this->viewProjectionDirty = true;
 	}
 }
\ No newline at end of file
@@ -38,8 +38,16 @@ namespace VkExample
 		/*-------------------------------------------------------------------*/
 		/* Projection & View												 */
 		/*-------------------------------------------------------------------*/
+		/*
+			Cached, and only rebuilt when something they're built from has
+			changed since: the setters just mark them dirty.
+		*/
 		glm::mat4						projection;
 		glm::mat4						view;
+		glm::mat4						viewProjection;
+		bool							projectionDirty;
+		bool							viewDirty;
+		bool							viewProjectionDirty;
 
 		/*-------------------------------------------------------------------*/
 		/* Viewport & Scissor												 */
@@ -48,13 +56,27 @@ namespace VkExample
 		VkRect2D						scissor;
 
 	public:
+		/*-------------------------------------------------------------------*/
+		/* Position & Zoom Functions										 */
+		/*-------------------------------------------------------------------*/
+		glm::vec3						GetPosition() { return position; }
+		void							SetPosition(glm::vec3 p) { position = p; viewDirty = true; }
+		glm::quat						GetRotation() { return rotation; }
+		void							SetRotation(glm::quat r) { rotation = r; viewDirty = true; }
+		float							GetZoom() { return zoom; }
+		void							SetZoom(float z) { zoom = z; projectionDirty = true; }
+
 		/*-------------------------------------------------------------------*/
 		/* View & Projection Functions										 */
 		/*-------------------------------------------------------------------*/
+		/*
+			The matrices rebuild themselves when asked for after a change;
+			calling these only does it sooner.
+		*/
 		void							UpdateProjection();
 		void							UpdateView();
 
-		glm::mat4						GetViewProjection() { return projection * view; }
+		glm::mat4						GetViewProjection();
 
 		/*-------------------------------------------------------------------*/
 		/* Viewport & Scissor Functions										 */
@@ -62,8 +84,13 @@ namespace VkExample
 		VkViewport						GetViewport() { return viewport; }
 		VkRect2D						GetScissor() { return scissor; };
 
-		void							SetViewportWidth(float width) { viewport.width = width; }
-		void							SetViewportHeight(float height) { viewport.height = height; }
+		/*
+			The viewport's offset places the view in the window; its size
+			is also how much of the world the projection covers at zoom 1.
+		*/
+		void							SetViewportOffset(float x, float y) { viewport.x = x; viewport.y = y; }
+		void							SetViewportWidth(float width) { viewport.width = width; projectionDirty = true; }
+		void							SetViewportHeight(float height) { viewport.height = height; projectionDirty = true; }
 
 		void							SetScissorOffset(VkOffset2D o) { scissor.offset = o; }
 		void							SetScissorExtent(VkExtent2D e) { scissor.extent = e; }
@@ -0,0 +1,352 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Culling.cpp																											 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <cfloat>
+
+#include "culling.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Cull Kernels																				   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		Each kernel writes one byte per 8 chunks, bit i set if chunk i of
+		those 8 overlaps the view. Counts are always a multiple of 8 (see
+		the padding in Resize()).
+	*/
+	/* Scalar ---------------------------------------------------------------*/
+	static void CullScalar(	const float* minX, const float* minY, const float* maxX, const float* maxY,
+							uint32_t count, ViewBounds view, uint8_t* masks)
+	{
+		for (uint32_t i = 0; i < count; i += 8)
+		{
+			uint8_t mask = 0;
+			for (uint32_t j = 0; j < 8; j++)
+			{
+				uint32_t k = i + j;
+				bool visible = maxX[k] >= view.minX && minX[k] <= view.maxX && maxY[k] >= view.minY && minY[k] <= view.maxY;
+				mask |= (uint8_t)visible << j;
+			}
+			masks[i / 8] = mask;
+		}
+	}
+
+#if SIMD_X86
+	/* SSE ------------------------------------------------------------------*/
+	static void CullSSE(const float* minX, const float* minY, const float* maxX, const float* maxY,
+						uint32_t count, ViewBounds view, uint8_t* masks)
+	{
+		__m128 viewMinX = _mm_set1_ps(view.minX);
+		__m128 viewMinY = _mm_set1_ps(view.minY);
+		__m128 viewMaxX = _mm_set1_ps(view.maxX);
+		__m128 viewMaxY = _mm_set1_ps(view.maxY);
+
+		for (uint32_t i = 0; i < count; i += 8)
+		{
+			int halves[2];
+			for (uint32_t h = 0; h < 2; h++)
+			{
+				uint32_t k = i + h * 4;
+				__m128 x = _mm_and_ps(_mm_cmpge_ps(_mm_loadu_ps(maxX + k), viewMinX), _mm_cmple_ps(_mm_loadu_ps(minX + k), viewMaxX));
+				__m128 y = _mm_and_ps(_mm_cmpge_ps(_mm_loadu_ps(maxY + k), viewMinY), _mm_cmple_ps(_mm_loadu_ps(minY + k), viewMaxY));
+				halves[h] = _mm_movemask_ps(_mm_and_ps(x, y));
+			}
+			masks[i / 8] = (uint8_t)(halves[0] | (halves[1] << 4));
+		}
+	}
+
+	/* AVX ------------------------------------------------------------------*/
+	SIMD_TARGET_AVX
+	static void CullAVX(const float* minX, const float* minY, const float* maxX, const float* maxY,
+						uint32_t count, ViewBounds view, uint8_t* masks)
+	{
+		__m256 viewMinX = _mm256_set1_ps(view.minX);
+		__m256 viewMinY = _mm256_set1_ps(view.minY);
+		__m256 viewMaxX = _mm256_set1_ps(view.maxX);
+		__m256 viewMaxY = _mm256_set1_ps(view.maxY);
+
+		for (uint32_t i = 0; i < count; i += 8)
+		{
+			__m256 x = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(maxX + i), viewMinX, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_loadu_ps(minX + i), viewMaxX, _CMP_LE_OQ));
+			__m256 y = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(maxY + i), viewMinY, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_loadu_ps(minY + i), viewMaxY, _CMP_LE_OQ));
+			masks[i / 8] = (uint8_t)_mm256_movemask_ps(_mm256_and_ps(x, y));
+		}
+	}
+#endif
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Culler																					   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Chunk Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Resize ---------------------------------------------------------------*/
+	void Culler::Resize(uint32_t count)
+	{
+		uint32_t padded = (count + 7) & ~7u;
+
+		minX.resize(padded, FLT_MAX);
+		minY.resize(padded, FLT_MAX);
+		maxX.resize(padded, -FLT_MAX);
+		maxY.resize(padded, -FLT_MAX);
+		chunkRanges.resize(count, { 0, 0 });
+		nearZ.resize(count, FLT_MAX);
+		masks.resize(padded / 8, 0);
+
+		/* Chunks dropped off the end become padding again. */
+		for (uint32_t i = count; i < padded; i++)
+		{
+			minX[i] = FLT_MAX;
+			minY[i] = FLT_MAX;
+			maxX[i] = -FLT_MAX;
+			maxY[i] = -FLT_MAX;
+		}
+
+		chunkCount = count;
+		depthOrderDirty = true;
+	}
+
+	/* Set Chunk ------------------------------------------------------------*/
+	void Culler::SetChunk(uint32_t index, DrawRange range, glm::vec3 min, glm::vec3 max)
+	{
+		chunkRanges[index] = range;
+		minX[index] = min.x;
+		minY[index] = min.y;
+		maxX[index] = max.x;
+		maxY[index] = max.y;
+
+		if (nearZ[index] != min.z)
+		{
+			nearZ[index] = min.z;
+			depthOrderDirty = true;
+		}
+	}
+
+	/* Build Chunks ---------------------------------------------------------*/
+	/*
+		Rebuilds the chunks covering a write of nVertices vertices at
+		firstVertex. With truncate, everything after the write is dropped
+		(matching what the renderer draws); without it, chunks past the
+		write are left alone. If the write only covers part of a chunk, we
+		no longer have the rest of that chunk's vertices, so its old box is
+		grown rather than replaced.
+	*/
+	void Culler::BuildChunks(const Vertex* vertices, uint32_t nVertices, uint32_t firstVertex, bool truncate)
+	{
+		uint32_t end = firstVertex + nVertices;
+		uint32_t firstChunk = firstVertex / CULL_CHUNK_VERTICES;
+		uint32_t lastChunk = (end + CULL_CHUNK_VERTICES - 1) / CULL_CHUNK_VERTICES;
+		uint32_t oldCount = chunkCount;
+
+		if (truncate || lastChunk > chunkCount) Resize(lastChunk);
+
+		for (uint32_t chunk = firstChunk; chunk < lastChunk; chunk++)
+		{
+			uint32_t chunkStart = chunk * CULL_CHUNK_VERTICES;
+			uint32_t writeStart = std::max(chunkStart, firstVertex);
+			uint32_t writeEnd = std::min(chunkStart + CULL_CHUNK_VERTICES, end);
+
+			uint32_t chunkEnd = writeEnd;
+			if (!truncate && chunk < oldCount) chunkEnd = std::max(chunkEnd, chunkRanges[chunk].firstVertex + chunkRanges[chunk].vertexCount);
+
+			glm::vec3 lo(FLT_MAX, FLT_MAX, FLT_MAX);
+			glm::vec3 hi(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+			if ((writeStart > chunkStart || writeEnd < chunkEnd) && chunk < oldCount)
+			{
+				lo = { minX[chunk], minY[chunk], nearZ[chunk] };
+				hi = { maxX[chunk], maxY[chunk], -FLT_MAX };
+			}
+
+			for (uint32_t v = writeStart; v < writeEnd; v++)
+			{
+				const glm::vec3& p = vertices[v - firstVertex].position;
+				lo.x = std::min(lo.x, p.x);
+				lo.y = std::min(lo.y, p.y);
+				lo.z = std::min(lo.z, p.z);
+				hi.x = std::max(hi.x, p.x);
+				hi.y = std::max(hi.y, p.y);
+			}
+
+			SetChunk(chunk, { chunkStart, chunkEnd - chunkStart }, lo, hi);
+		}
+	}
+
+	/* Get Bounds -----------------------------------------------------------*/
+	/*
+		The box around chunks firstChunk up to (not including) lastChunk.
+		Empty, with min > max, if none of them hold anything.
+	*/
+	ViewBounds Culler::GetBounds(uint32_t firstChunk, uint32_t lastChunk)
+	{
+		ViewBounds bounds = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+		lastChunk = std::min(lastChunk, chunkCount);
+
+		for (uint32_t chunk = firstChunk; chunk < lastChunk; chunk++)
+		{
+			bounds.minX = std::min(bounds.minX, minX[chunk]);
+			bounds.minY = std::min(bounds.minY, minY[chunk]);
+			bounds.maxX = std::max(bounds.maxX, maxX[chunk]);
+			bounds.maxY = std::max(bounds.maxY, maxY[chunk]);
+		}
+
+		return bounds;
+	}
+
+	/* Write GPU Chunks -----------------------------------------------------*/
+	/*
+		Copies every chunk into dst in the layout cull.comp expects. dst must
+		have room for GetChunkCount() chunks.
+
+		With front-to-back ordering the chunks go in nearest first. cull.comp
+		compacts its output with atomics, so the draws only roughly keep
+		that order, which is still enough for most of the early rejection.
+	*/
+	void Culler::WriteGpuChunks(GpuChunk* dst)
+	{
+		const std::vector<uint32_t>* order = frontToBack ? &GetDepthOrder() : nullptr;
+
+		for (uint32_t n = 0; n < chunkCount; n++)
+		{
+			uint32_t i = order ? (*order)[n] : n;
+			dst[n].bounds = glm::vec4(minX[i], minY[i], maxX[i], maxY[i]);
+			dst[n].firstVertex = chunkRanges[i].firstVertex;
+			dst[n].vertexCount = chunkRanges[i].vertexCount;
+			dst[n].padding[0] = 0;
+			dst[n].padding[1] = 0;
+		}
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Culling Functions													 */
+	/*-----------------------------------------------------------------------*/
+	/* Compute View Bounds --------------------------------------------------*/
+	/*
+		Takes the corners of clip space back into the world and returns the
+		box around them. The near and far corners are both included, so a
+		tilted camera still gets a conservative box.
+	*/
+	ViewBounds Culler::ComputeViewBounds(glm::mat4 viewProjection)
+	{
+		glm::mat4 inverse = glm::inverse(viewProjection);
+		ViewBounds view = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		for (int i = 0; i < 8; i++)
+		{
+			glm::vec4 corner = inverse * glm::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : 0.0f, 1.0f);
+			corner = corner * (1.0f / corner.w);
+
+			view.minX = std::min(view.minX, corner.x);
+			view.minY = std::min(view.minY, corner.y);
+			view.maxX = std::max(view.maxX, corner.x);
+			view.maxY = std::max(view.maxY, corner.y);
+		}
+
+		return view;
+	}
+
+	/* Cull -----------------------------------------------------------------*/
+	/*
+		Culls for the main view. GetDrawRanges() and GetStats() report on
+		this one.
+	*/
+	const std::vector<DrawRange>& Culler::Cull(ViewBounds view)
+	{
+		visibleChunks = Cull(view, drawRanges);
+		return drawRanges;
+	}
+
+	/*
+		Culls for any other view into ranges, which the caller keeps, and
+		returns how many chunks were visible. The chunks are shared, so
+		every view culls the same vertex buffer.
+	*/
+	uint32_t Culler::Cull(ViewBounds view, std::vector<DrawRange>& ranges)
+	{
+		ranges.clear();
+		uint32_t visible = 0;
+		if (chunkCount == 0) return 0;
+
+		kernel(minX.data(), minY.data(), maxX.data(), maxY.data(), (uint32_t)minX.size(), view, masks.data());
+
+		const std::vector<uint32_t>* order = frontToBack ? &GetDepthOrder() : nullptr;
+
+		for (uint32_t n = 0; n < chunkCount; n++)
+		{
+			uint32_t i = order ? (*order)[n] : n;
+			if (!((masks[i / 8] >> (i % 8)) & 1)) continue;
+
+			visible++;
+			DrawRange range = chunkRanges[i];
+			if (range.vertexCount == 0) continue;
+
+			if (!ranges.empty() && ranges.back().firstVertex + ranges.back().vertexCount == range.firstVertex)
+			{
+				ranges.back().vertexCount += range.vertexCount;
+			}
+			else ranges.push_back(range);
+		}
+
+		return visible;
+	}
+
+	/* Get Stats ------------------------------------------------------------*/
+	CullStats Culler::GetStats()
+	{
+		return { chunkCount, visibleChunks, (uint32_t)drawRanges.size(), kernelName };
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Ordering Functions													 */
+	/*-----------------------------------------------------------------------*/
+	/* Get Depth Order ------------------------------------------------------*/
+	const std::vector<uint32_t>& Culler::GetDepthOrder()
+	{
+		if (!depthOrderDirty) return depthOrder;
+
+		depthOrder.resize(chunkCount);
+		for (uint32_t i = 0; i < chunkCount; i++) depthOrder[i] = i;
+
+		std::stable_sort(depthOrder.begin(), depthOrder.end(), [this](uint32_t a, uint32_t b)
+		{
+			return nearZ[a] < nearZ[b];
+		});
+
+		depthOrderDirty = false;
+		return depthOrder;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Constructor															 */
+	/*-----------------------------------------------------------------------*/
+	Culler::Culler()
+	{
+		this->chunkCount = 0;
+		this->visibleChunks = 0;
+		this->frontToBack = false;
+		this->depthOrderDirty = false;
+
+		this->kernel = CullScalar;
+		this->kernelName = "scalar";
+
+#if SIMD_X86
+		const CpuFeatures& cpu = GetCpuFeatures();
+		if (cpu.avx)
+		{
+			kernel = CullAVX;
+			kernelName = "avx";
+		}
+		else if (cpu.sse2)
+		{
+			kernel = CullSSE;
+			kernelName = "sse";
+		}
+#endif
+	}
+}
\ No newline at end of file
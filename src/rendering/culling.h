@@ -0,0 +1,175 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Culling.h																											 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "../util/polygons.h"
+#include "../util/simd.h"
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Defines																						   */
+/*-------------------------------------------------------------------------------------------------*/
+
+#define CULL_CHUNK_VERTICES 1536
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Helper Structs																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Draw Range															 */
+	/*-----------------------------------------------------------------------*/
+	struct DrawRange
+	{
+		uint32_t	firstVertex;
+		uint32_t	vertexCount;
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* View Bounds															 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		The world-space rectangle the camera can see. Our projection is
+		orthographic, so this is the whole frustum as far as x and y go.
+	*/
+	struct ViewBounds
+	{
+		float		minX;
+		float		minY;
+		float		maxX;
+		float		maxY;
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* GPU Chunk															 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		A chunk as the cull compute shader reads it (std430, 32 bytes).
+	*/
+	struct GpuChunk
+	{
+		glm::vec4	bounds;
+		uint32_t	firstVertex;
+		uint32_t	vertexCount;
+		uint32_t	padding[2];
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* Cull Stats															 */
+	/*-----------------------------------------------------------------------*/
+	struct CullStats
+	{
+		uint32_t	chunkCount;
+		uint32_t	visibleChunks;
+		uint32_t	drawCount;
+		const char*	kernel;
+	};
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Culler																					   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		The culler splits the vertex buffer into chunks of
+		CULL_CHUNK_VERTICES vertices and keeps a 2D bounding box for each.
+		The boxes are stored as separate min/max arrays (structure of
+		arrays) so that 4 (SSE) or 8 (AVX) of them can be tested against
+		the view at once. Visible chunks that sit next to each other in the
+		vertex buffer are merged into a single draw.
+
+		Content that is written in spatial order (rows of a map, say) gets
+		tight boxes; content that isn't still works, it just culls less.
+
+		Each chunk also keeps the smallest z of its vertices, the part of
+		it nearest the camera. With front-to-back ordering on, visible
+		chunks come out nearest first, so the depth test can reject what
+		they cover before it is shaded.
+	*/
+	class Culler
+	{
+	private:
+		/*-------------------------------------------------------------------*/
+		/* Kernel															 */
+		/*-------------------------------------------------------------------*/
+		typedef void (*CullKernel)(const float* minX, const float* minY, const float* maxX, const float* maxY,
+								   uint32_t count, ViewBounds view, uint8_t* masks);
+
+		CullKernel						kernel;
+		const char*						kernelName;
+
+		/*-------------------------------------------------------------------*/
+		/* Chunks															 */
+		/*-------------------------------------------------------------------*/
+		/*
+			The bounds arrays are padded to a multiple of 8 with empty
+			boxes (min > max), which no view can ever overlap.
+		*/
+		uint32_t						chunkCount;
+		std::vector<float>				minX;
+		std::vector<float>				minY;
+		std::vector<float>				maxX;
+		std::vector<float>				maxY;
+		std::vector<DrawRange>			chunkRanges;
+		std::vector<float>				nearZ;
+
+		/*
+			Chunk indices sorted by nearZ, rebuilt when a chunk's nearZ
+			changes. The sort is stable, so chunks at the same depth stay in
+			buffer order and still merge into one draw.
+		*/
+		bool							frontToBack;
+		bool							depthOrderDirty;
+		std::vector<uint32_t>			depthOrder;
+
+		/*-------------------------------------------------------------------*/
+		/* Results															 */
+		/*-------------------------------------------------------------------*/
+		std::vector<uint8_t>			masks;
+		std::vector<DrawRange>			drawRanges;
+		uint32_t						visibleChunks;
+
+		/*-------------------------------------------------------------------*/
+		/* Ordering Functions												 */
+		/*-------------------------------------------------------------------*/
+		const std::vector<uint32_t>&	GetDepthOrder();
+
+	public:
+		/*-------------------------------------------------------------------*/
+		/* Chunk Functions													 */
+		/*-------------------------------------------------------------------*/
+		void							Resize(uint32_t count);
+		void							SetChunk(uint32_t index, DrawRange range, glm::vec3 min, glm::vec3 max);
+		void							BuildChunks(const Vertex* vertices, uint32_t nVertices, uint32_t firstVertex, bool truncate);
+		uint32_t						GetChunkCount() { return chunkCount; }
+		ViewBounds						GetBounds(uint32_t firstChunk, uint32_t lastChunk);
+		void							WriteGpuChunks(GpuChunk* dst);
+
+		/*-------------------------------------------------------------------*/
+		/* Culling Functions												 */
+		/*-------------------------------------------------------------------*/
+		static ViewBounds				ComputeViewBounds(glm::mat4 viewProjection);
+		const std::vector<DrawRange>&	Cull(ViewBounds view);
+		uint32_t						Cull(ViewBounds view, std::vector<DrawRange>& ranges);
+		const std::vector<DrawRange>&	GetDrawRanges() { return drawRanges; }
+		CullStats						GetStats();
+		void							SetFrontToBack(bool v) { frontToBack = v; }
+		bool							GetFrontToBack() { return frontToBack; }
+
+		/*-------------------------------------------------------------------*/
+		/* Constructor														 */
+		/*-------------------------------------------------------------------*/
+		Culler();
+	};
+}
+
+#endif
\ No newline at end of file
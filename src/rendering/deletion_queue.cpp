@@ -0,0 +1,140 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Deletion_Queue.cpp																									 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include "deletion_queue.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Deletion Queue																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Push Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Push -----------------------------------------------------------------*/
+	/*
+		Queues any clean up; the typed pushes below cover the common cases.
+	*/
+	void DeletionQueue::Push(std::function<void()> destroy)
+	{
+		entries.push_back({ frameValue, destroy });
+	}
+
+	/* Push Buffer ----------------------------------------------------------*/
+	/*
+		Image and buffer memory goes back to the allocator along with the
+		object, so it can't be reused while the GPU still reads it.
+	*/
+	void DeletionQueue::PushBuffer(VkBuffer buffer, Allocation allocation)
+	{
+		VkDevice device = this->device;
+		MemoryAllocator* allocator = this->allocator;
+
+		Push([device, allocator, buffer, allocation]() mutable
+		{
+			vkDestroyBuffer(device, buffer, nullptr);
+			allocator->Free(allocation);
+		});
+	}
+
+	/* Push Image -----------------------------------------------------------*/
+	void DeletionQueue::PushImage(VkImage image, Allocation allocation)
+	{
+		VkDevice device = this->device;
+		MemoryAllocator* allocator = this->allocator;
+
+		Push([device, allocator, image, allocation]() mutable
+		{
+			vkDestroyImage(device, image, nullptr);
+			if (allocation.memory != VK_NULL_HANDLE) allocator->Free(allocation);
+		});
+	}
+
+	/* Push Image View ------------------------------------------------------*/
+	void DeletionQueue::PushImageView(VkImageView view)
+	{
+		VkDevice device = this->device;
+		Push([device, view]() { vkDestroyImageView(device, view, nullptr); });
+	}
+
+	/* Push Framebuffer -----------------------------------------------------*/
+	void DeletionQueue::PushFramebuffer(VkFramebuffer framebuffer)
+	{
+		VkDevice device = this->device;
+		Push([device, framebuffer]() { vkDestroyFramebuffer(device, framebuffer, nullptr); });
+	}
+
+	/* Push Pipeline --------------------------------------------------------*/
+	void DeletionQueue::PushPipeline(VkPipeline pipeline)
+	{
+		VkDevice device = this->device;
+		Push([device, pipeline]() { vkDestroyPipeline(device, pipeline, nullptr); });
+	}
+
+	/* Push Swap Chain ------------------------------------------------------*/
+	/*
+		For a swap chain that has been passed as oldSwapchain to its
+		replacement, whose images the last frames may still be drawing to.
+	*/
+	void DeletionQueue::PushSwapChain(VkSwapchainKHR swapChain)
+	{
+		VkDevice device = this->device;
+		Push([device, swapChain]() { vkDestroySwapchainKHR(device, swapChain, nullptr); });
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Flush Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Flush ----------------------------------------------------------------*/
+	/*
+		Destroys everything whose frame has completed.
+	*/
+	void DeletionQueue::Flush(uint64_t completedValue)
+	{
+		while (!entries.empty() && entries.front().frameValue <= completedValue)
+		{
+			entries.front().destroy();
+			entries.pop_front();
+		}
+	}
+
+	/* Flush All ------------------------------------------------------------*/
+	/*
+		Destroys everything. Only safe once the device is idle.
+	*/
+	void DeletionQueue::FlushAll()
+	{
+		while (!entries.empty())
+		{
+			entries.front().destroy();
+			entries.pop_front();
+		}
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Constructor															 */
+	/*-----------------------------------------------------------------------*/
+	DeletionQueue::DeletionQueue(VkDevice device, MemoryAllocator* allocator)
+	{
+		this->device = device;
+		this->allocator = allocator;
+		this->frameValue = 1;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Deconstructor														 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		The owner is expected to have waited for the device, as it does
+		before destroying anything else.
+	*/
+	DeletionQueue::~DeletionQueue()
+	{
+		FlushAll();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#ifndef DELETION_QUEUE_H
+#define DELETION_QUEUE_H
+
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Deletion_Queue.h																										 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+#include "allocator.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Deletion Queue																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		Holds Vulkan objects that have been replaced but may still be used
+		by frames in flight, and destroys them once those frames have
+		finished.
+
+		Each object is tagged with the frame value of the frame being
+		recorded when it was pushed, the last one that could have used it.
+		The renderer moves that value on with SetFrameValue() after every
+		submit, and calls Flush() with the newest value the GPU is known to
+		have finished. Frame values only go up, so the queue stays in
+		order and objects are destroyed in the order they were pushed.
+
+		Nothing here waits on the GPU: resizing, reloading and streaming
+		can let go of objects without a vkDeviceWaitIdle().
+	*/
+	class DeletionQueue
+	{
+	private:
+		struct Entry
+		{
+			uint64_t						frameValue;
+			std::function<void()>			destroy;
+		};
+
+		std::deque<Entry>				entries;
+		uint64_t						frameValue;
+
+		/*-------------------------------------------------------------------*/
+		/* Vulkan															 */
+		/*-------------------------------------------------------------------*/
+		VkDevice						device;
+		MemoryAllocator*				allocator;
+
+	public:
+		/*-------------------------------------------------------------------*/
+		/* Push Functions													 */
+		/*-------------------------------------------------------------------*/
+		void							Push(std::function<void()> destroy);
+		void							PushBuffer(VkBuffer buffer, Allocation allocation);
+		void							PushImage(VkImage image, Allocation allocation);
+		void							PushImageView(VkImageView view);
+		void							PushFramebuffer(VkFramebuffer framebuffer);
+		void							PushPipeline(VkPipeline pipeline);
+		void							PushSwapChain(VkSwapchainKHR swapChain);
+
+		/*-------------------------------------------------------------------*/
+		/* Flush Functions													 */
+		/*-------------------------------------------------------------------*/
+		void							SetFrameValue(uint64_t value) { frameValue = value; }
+		void							Flush(uint64_t completedValue);
+		void							FlushAll();
+
+		/*-------------------------------------------------------------------*/
+		/* Getters															 */
+		/*-------------------------------------------------------------------*/
+		size_t							GetPendingCount() { return entries.size(); }
+
+		/*-------------------------------------------------------------------*/
+		/* Constructor														 */
+		/*-------------------------------------------------------------------*/
+		DeletionQueue(VkDevice device, MemoryAllocator* allocator);
+
+		/*-------------------------------------------------------------------*/
+		/* Deconstructor													 */
+		/*-------------------------------------------------------------------*/
+		~DeletionQueue();
+	};
+}
+
+#endif
\ No newline at end of file
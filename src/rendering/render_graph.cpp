@@ -0,0 +1,1092 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Render_Graph.cpp																										 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+#include "render_graph.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Access Info																				   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		What a GraphAccess means to the pipeline.
+	*/
+	struct AccessInfo
+	{
+		VkPipelineStageFlags	stage;
+		VkAccessFlags			access;
+		VkImageLayout			layout;
+		bool					write;
+	};
+
+	static AccessInfo GetAccessInfo(GraphAccess access)
+	{
+		switch (access)
+		{
+		case GRAPH_ACCESS_COLOR_ATTACHMENT:
+			return {	VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+						VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+						VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true };
+		case GRAPH_ACCESS_DEPTH_ATTACHMENT:
+			return {	VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+						VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+						VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true };
+		case GRAPH_ACCESS_SAMPLED:
+			return { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+		case GRAPH_ACCESS_TRANSFER_READ:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false };
+		case GRAPH_ACCESS_TRANSFER_WRITE:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true };
+		case GRAPH_ACCESS_COMPUTE_READ:
+			return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false };
+		case GRAPH_ACCESS_COMPUTE_WRITE:
+			return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true };
+		case GRAPH_ACCESS_VERTEX_READ:
+			return { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+		case GRAPH_ACCESS_INDIRECT_READ:
+			return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+		}
+
+		throw std::runtime_error("Unknown render graph access.");
+	}
+
+	/*
+		The image usage a GraphAccess needs.
+	*/
+	static VkImageUsageFlags GetAccessUsage(GraphAccess access)
+	{
+		switch (access)
+		{
+		case GRAPH_ACCESS_COLOR_ATTACHMENT: return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		case GRAPH_ACCESS_DEPTH_ATTACHMENT: return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		case GRAPH_ACCESS_SAMPLED: return VK_IMAGE_USAGE_SAMPLED_BIT;
+		case GRAPH_ACCESS_TRANSFER_READ: return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		case GRAPH_ACCESS_TRANSFER_WRITE: return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		case GRAPH_ACCESS_COMPUTE_READ: return VK_IMAGE_USAGE_STORAGE_BIT;
+		case GRAPH_ACCESS_COMPUTE_WRITE: return VK_IMAGE_USAGE_STORAGE_BIT;
+		default: return 0;
+		}
+	}
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Resource State																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		What has happened to a resource so far in the frame: the last
+		write, which stages have since been made to wait on it, and which
+		have read it since.
+	*/
+	struct ResourceState
+	{
+		VkImageLayout			layout;
+		VkPipelineStageFlags	writeStages;
+		VkAccessFlags			writeAccess;
+		VkPipelineStageFlags	syncedStages;
+		VkPipelineStageFlags	readStages;
+	};
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Render Graph																				   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Declaration Functions												 */
+	/*-----------------------------------------------------------------------*/
+	/* Import Image ---------------------------------------------------------*/
+	/*
+		An image owned outside the graph, such as the swap chain's. It may
+		be a set of images, one of which is used each frame; see
+		SetImages() and SetImageIndex(). Each frame it starts in
+		initialLayout, after initialStage (the stage a semaphore wait
+		blocks), and is left in finalLayout.
+	*/
+	GraphResource RenderGraph::ImportImage(	std::string name, VkFormat format, VkImageAspectFlags aspect,
+											VkImageLayout initialLayout, VkPipelineStageFlags initialStage, VkImageLayout finalLayout)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.imported = true;
+		resource.isImage = true;
+		resource.format = format;
+		resource.aspect = aspect;
+		resource.initialLayout = initialLayout;
+		resource.initialStage = initialStage;
+		resource.finalLayout = finalLayout;
+		resource.imageIndex = 0;
+		resource.buffer = VK_NULL_HANDLE;
+
+		resources.push_back(resource);
+		return resources.size() - 1;
+	}
+
+	/* Import Buffer --------------------------------------------------------*/
+	/*
+		A buffer owned outside the graph. The handle is given each frame
+		with SetBuffer(), so it may change when the buffer is replaced.
+	*/
+	GraphResource RenderGraph::ImportBuffer(std::string name)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.imported = true;
+		resource.isImage = false;
+		resource.buffer = VK_NULL_HANDLE;
+
+		resources.push_back(resource);
+		return resources.size() - 1;
+	}
+
+	/* Create Image ---------------------------------------------------------*/
+	/*
+		An image that only lives within the frame, created by the graph at
+		its extent.
+	*/
+	GraphResource RenderGraph::CreateImage(std::string name, VkFormat format, VkImageAspectFlags aspect)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.imported = false;
+		resource.isImage = true;
+		resource.format = format;
+		resource.aspect = aspect;
+		resource.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		resource.finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		resource.imageIndex = 0;
+		resource.buffer = VK_NULL_HANDLE;
+
+		resources.push_back(resource);
+		return resources.size() - 1;
+	}
+
+	/* Create Persistent Image ----------------------------------------------*/
+	/*
+		Like CreateImage(), but its contents carry over from one frame to
+		the next: each frame finds it as the last one left it. Resize()
+		replaces it with an undefined image, which the caller has to
+		redraw in full.
+	*/
+	GraphResource RenderGraph::CreatePersistentImage(std::string name, VkFormat format, VkImageAspectFlags aspect)
+	{
+		GraphResource resource = CreateImage(name, format, aspect);
+		resources[resource].persistent = true;
+		return resource;
+	}
+
+	/* Add Pass -------------------------------------------------------------*/
+	/*
+		Passes run in the order they are added. A graphics pass's record
+		function is called inside its render pass.
+	*/
+	GraphPass RenderGraph::AddPass(std::string name, bool graphics, std::function<void(VkCommandBuffer)> record)
+	{
+		Pass pass{};
+		pass.name = name;
+		pass.graphics = graphics;
+		pass.record = record;
+		pass.culled = false;
+		pass.renderPass = VK_NULL_HANDLE;
+		pass.renderArea = { 0, 0 };
+
+		passes.push_back(pass);
+		return passes.size() - 1;
+	}
+
+	/* Use ------------------------------------------------------------------*/
+	/*
+		Declares that the pass accesses the resource. Each resource is
+		used at most once per pass.
+	*/
+	void RenderGraph::Use(GraphPass pass, GraphResource resource, GraphAccess access)
+	{
+		passes[pass].uses.push_back({ resource, access, {}, false });
+	}
+
+	/* Use Attachment -------------------------------------------------------*/
+	/*
+		Like Use(), for an attachment that is cleared to clear at the
+		start of the pass.
+	*/
+	void RenderGraph::UseAttachment(GraphPass pass, GraphResource resource, GraphAccess access, VkClearValue clear)
+	{
+		passes[pass].uses.push_back({ resource, access, clear, true });
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Compile Functions													 */
+	/*-----------------------------------------------------------------------*/
+	/* Build ----------------------------------------------------------------*/
+	/*
+		Culls the passes nothing needs, plans the barriers, shares memory
+		between transient images and creates the render passes. Called
+		once, after every pass and resource has been declared.
+	*/
+	void RenderGraph::Build()
+	{
+		CullPasses();
+
+		/* Lifetimes ----------------------------------------------------*/
+		for (int i = 0; i < resources.size(); i++)
+		{
+			resources[i].firstUse = -1;
+			resources[i].lastUse = -1;
+			resources[i].usage = 0;
+		}
+
+		for (int p = 0; p < passes.size(); p++)
+		{
+			if (passes[p].culled) continue;
+
+			for (int u = 0; u < passes[p].uses.size(); u++)
+			{
+				Resource& resource = resources[passes[p].uses[u].resource];
+				if (resource.firstUse < 0) resource.firstUse = p;
+				resource.lastUse = p;
+				resource.usage |= GetAccessUsage(passes[p].uses[u].access);
+			}
+		}
+
+		/* Memory Slots -------------------------------------------------*/
+		/*
+			Transient images take the first slot whose last user is done
+			before they are first used, in order of first use. A
+			persistent image's slot is never done with.
+		*/
+		std::vector<uint32_t> transients;
+		for (int i = 0; i < resources.size(); i++)
+		{
+			resources[i].memorySlot = -1;
+			if (!resources[i].imported && resources[i].firstUse >= 0) transients.push_back(i);
+		}
+
+		std::sort(transients.begin(), transients.end(), [this](uint32_t a, uint32_t b)
+		{
+			return resources[a].firstUse < resources[b].firstUse;
+		});
+
+		std::vector<int> slotEnds;
+		for (int i = 0; i < transients.size(); i++)
+		{
+			Resource& resource = resources[transients[i]];
+
+			int slot = 0;
+			while (slot < slotEnds.size() && slotEnds[slot] >= resource.firstUse) slot++;
+			if (resource.persistent) slot = slotEnds.size();
+			if (slot == slotEnds.size()) slotEnds.push_back(0);
+
+			slotEnds[slot] = resource.persistent ? INT_MAX : resource.lastUse;
+			resource.memorySlot = slot;
+		}
+
+		memorySlots.resize(slotEnds.size());
+
+		PlanTransitions();
+
+		for (int p = 0; p < passes.size(); p++)
+		{
+			if (!passes[p].graphics || passes[p].culled) continue;
+
+			PlanAttachments(passes[p]);
+			if (!dynamicRendering) CreateRenderPass(passes[p]);
+		}
+
+		built = true;
+	}
+
+	/* Cull Passes ----------------------------------------------------------*/
+	/*
+		Walks the passes backwards. A pass is kept if it writes an imported
+		or persistent resource, or a transient one a kept pass later reads.
+	*/
+	void RenderGraph::CullPasses()
+	{
+		std::vector<bool> needed(resources.size(), false);
+
+		for (int p = passes.size() - 1; p >= 0; p--)
+		{
+			Pass& pass = passes[p];
+			bool keep = false;
+
+			for (int u = 0; u < pass.uses.size(); u++)
+			{
+				GraphResource r = pass.uses[u].resource;
+				if (GetAccessInfo(pass.uses[u].access).write && (resources[r].imported || resources[r].persistent || needed[r])) keep = true;
+			}
+
+			pass.culled = !keep;
+			if (!keep) continue;
+
+			/*
+				What this pass reads has to be produced earlier; what it
+				overwrites outright doesn't.
+			*/
+			for (int u = 0; u < pass.uses.size(); u++)
+			{
+				const ResourceUse& use = pass.uses[u];
+				bool overwrites = use.cleared || use.access == GRAPH_ACCESS_TRANSFER_WRITE;
+				needed[use.resource] = !overwrites;
+			}
+		}
+	}
+
+	/* Plan Transitions -----------------------------------------------------*/
+	/*
+		Steps through the frame tracking each resource's state, and records
+		a transition wherever a use has to wait on an earlier one or needs
+		a new layout. The frame is stepped through twice: the first time
+		only to find the state each resource is left in, which is where
+		the next frame picks it up.
+
+		A transient image starts each frame undefined, after whatever last
+		touched its memory slot. A persistent one starts where the last
+		frame left it, which is remembered as its initial layout.
+	*/
+	void RenderGraph::PlanTransitions()
+	{
+		std::vector<ResourceState> start(resources.size());
+		std::vector<ResourceState> state;
+
+		for (int i = 0; i < resources.size(); i++)
+		{
+			start[i] = {};
+			start[i].layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		}
+
+		for (int run = 0; run < 2; run++)
+		{
+			state = start;
+
+			for (int p = 0; p < passes.size(); p++)
+			{
+				Pass& pass = passes[p];
+				if (pass.culled) continue;
+
+				pass.transitions.clear();
+				pass.srcStages = 0;
+				pass.dstStages = 0;
+
+				for (int u = 0; u < pass.uses.size(); u++)
+				{
+					GraphResource r = pass.uses[u].resource;
+					AccessInfo info = GetAccessInfo(pass.uses[u].access);
+					ResourceState& s = state[r];
+
+					bool relayout = resources[r].isImage && s.layout != info.layout;
+
+					if (info.write || relayout)
+					{
+						/* Writes wait on the last write and every read since. */
+						VkPipelineStageFlags waitStages = s.writeStages | s.readStages;
+						if (waitStages != 0 || relayout)
+						{
+							pass.transitions.push_back({ r, s.writeAccess, info.access, s.layout, info.layout });
+							pass.srcStages |= waitStages;
+							pass.dstStages |= info.stage;
+						}
+
+						s.layout = info.layout;
+						s.writeStages = info.stage;
+						s.writeAccess = info.write ? info.access : 0;
+						s.syncedStages = info.write ? 0 : info.stage;
+						s.readStages = info.write ? 0 : info.stage;
+					}
+					else
+					{
+						/* Reads wait on the last write, once per stage. */
+						if (s.writeStages != 0 && (info.stage & ~s.syncedStages))
+						{
+							pass.transitions.push_back({ r, s.writeAccess, info.access, s.layout, info.layout });
+							pass.srcStages |= s.writeStages;
+							pass.dstStages |= info.stage;
+							s.syncedStages |= info.stage;
+						}
+
+						s.readStages |= info.stage;
+					}
+				}
+			}
+
+			/* Final Layouts --------------------------------------------*/
+			finalTransitions.clear();
+			finalSrcStages = 0;
+
+			for (int i = 0; i < resources.size(); i++)
+			{
+				Resource& resource = resources[i];
+				ResourceState& s = state[i];
+
+				if (!resource.imported || !resource.isImage || resource.firstUse < 0) continue;
+				if (resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || resource.finalLayout == s.layout) continue;
+
+				finalTransitions.push_back({ (GraphResource)i, s.writeAccess, 0, s.layout, resource.finalLayout });
+				finalSrcStages |= s.writeStages | s.readStages;
+
+				s.layout = resource.finalLayout;
+				s.writeStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+				s.writeAccess = 0;
+				s.syncedStages = 0;
+				s.readStages = 0;
+			}
+
+			/* Next Frame -----------------------------------------------*/
+			for (int i = 0; i < resources.size(); i++)
+			{
+				Resource& resource = resources[i];
+				start[i] = state[i];
+				start[i].syncedStages = 0;
+
+				if (resource.imported && resource.isImage)
+				{
+					start[i].layout = resource.initialLayout;
+					start[i].writeStages = resource.initialStage;
+					start[i].writeAccess = 0;
+					start[i].readStages = 0;
+				}
+				else if (resource.persistent)
+				{
+					resource.initialLayout = start[i].layout;
+				}
+				else if (resource.isImage)
+				{
+					start[i].layout = VK_IMAGE_LAYOUT_UNDEFINED;
+					start[i].writeStages = 0;
+					start[i].writeAccess = 0;
+					start[i].readStages = 0;
+
+					for (int j = 0; j < resources.size(); j++)
+					{
+						if (resources[j].imported || resources[j].memorySlot != resource.memorySlot || resource.memorySlot < 0) continue;
+
+						start[i].writeStages |= state[j].writeStages | state[j].readStages;
+						start[i].writeAccess |= state[j].writeAccess;
+					}
+				}
+			}
+		}
+	}
+
+	/* Plan Attachments -----------------------------------------------------*/
+	/*
+		Works out a graphics pass's attachments. Layouts are already handled
+		by the graph's barriers, so attachments stay in one layout
+		throughout. Contents are only loaded or stored when something
+		needs them.
+	*/
+	void RenderGraph::PlanAttachments(Pass& pass)
+	{
+		pass.attachments.clear();
+		pass.clearValues.clear();
+		pass.colorFormats.clear();
+		pass.depthFormat = VK_FORMAT_UNDEFINED;
+		int passIndex = &pass - passes.data();
+
+		for (int u = 0; u < pass.uses.size(); u++)
+		{
+			const ResourceUse& use = pass.uses[u];
+			if (use.access != GRAPH_ACCESS_COLOR_ATTACHMENT && use.access != GRAPH_ACCESS_DEPTH_ATTACHMENT) continue;
+
+			const Resource& resource = resources[use.resource];
+
+			bool undefinedBefore =	resource.firstUse == passIndex && !resource.persistent &&
+									(!resource.imported || resource.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+			bool readAfter = resource.imported || resource.persistent || resource.lastUse > passIndex;
+
+			Attachment attachment{};
+			attachment.resource = use.resource;
+			attachment.depth = use.access == GRAPH_ACCESS_DEPTH_ATTACHMENT;
+			attachment.layout = GetAccessInfo(use.access).layout;
+			attachment.loadOp = use.cleared ? VK_ATTACHMENT_LOAD_OP_CLEAR : (undefinedBefore ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_LOAD);
+			attachment.storeOp = readAfter ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			attachment.clear = use.clear;
+
+			if (attachment.depth) pass.depthFormat = resource.format;
+			else pass.colorFormats.push_back(resource.format);
+
+			pass.attachments.push_back(attachment);
+			pass.clearValues.push_back(use.clear);
+		}
+	}
+
+	/* Create Render Pass ---------------------------------------------------*/
+	/*
+		A single-subpass render pass over the pass's attachments. The
+		graph's barriers come before it, so it needs no dependencies.
+	*/
+	void RenderGraph::CreateRenderPass(Pass& pass)
+	{
+		std::vector<VkAttachmentDescription> attachments;
+		std::vector<VkAttachmentReference> colorRefs;
+		VkAttachmentReference depthRef{};
+		bool hasDepth = false;
+
+		for (int i = 0; i < pass.attachments.size(); i++)
+		{
+			const Attachment& planned = pass.attachments[i];
+
+			VkAttachmentDescription attachment{};
+			attachment.format = resources[planned.resource].format;
+			attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+			attachment.loadOp = planned.loadOp;
+			attachment.storeOp = planned.storeOp;
+			attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			attachment.initialLayout = planned.layout;
+			attachment.finalLayout = planned.layout;
+
+			VkAttachmentReference ref{};
+			ref.attachment = i;
+			ref.layout = planned.layout;
+
+			if (planned.depth)
+			{
+				depthRef = ref;
+				hasDepth = true;
+			}
+			else colorRefs.push_back(ref);
+
+			attachments.push_back(attachment);
+		}
+
+		VkSubpassDescription subpass{};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = colorRefs.size();
+		subpass.pColorAttachments = colorRefs.data();
+		subpass.pDepthStencilAttachment = hasDepth ? &depthRef : nullptr;
+
+		VkRenderPassCreateInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = attachments.size();
+		renderPassInfo.pAttachments = attachments.data();
+		renderPassInfo.subpassCount = 1;
+		renderPassInfo.pSubpasses = &subpass;
+		renderPassInfo.dependencyCount = 0;
+		renderPassInfo.pDependencies = nullptr;
+
+		if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &pass.renderPass) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create render pass for " + pass.name + ".");
+		}
+	}
+
+	/* Get Pipeline Rendering Info ------------------------------------------*/
+	/*
+		With dynamic rendering, pipelines describe the attachment formats
+		they draw to instead of naming a render pass. The info points into
+		the graph, so it is only valid while the graph is.
+	*/
+	void RenderGraph::GetPipelineRenderingInfo(GraphPass pass, VkPipelineRenderingCreateInfoKHR& info)
+	{
+		info = {};
+		info.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+		info.colorAttachmentCount = passes[pass].colorFormats.size();
+		info.pColorAttachmentFormats = passes[pass].colorFormats.data();
+		info.depthAttachmentFormat = passes[pass].depthFormat;
+		info.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+	}
+
+	/* Get Image ------------------------------------------------------------*/
+	/*
+		The image a resource is this frame: for an imported set, the one
+		SetImageIndex() picked. For passes that record their own commands
+		against it (a blit, say); the graph still does the barriers.
+	*/
+	VkImage RenderGraph::GetImage(GraphResource resource)
+	{
+		const Resource& r = resources[resource];
+		if (r.images.empty()) return VK_NULL_HANDLE;
+		return r.images[r.imageIndex % r.images.size()];
+	}
+
+	/* Resize ---------------------------------------------------------------*/
+	/*
+		(Re)creates the transient images and framebuffers at a new extent.
+		Imported images must already have been given with SetImages().
+	*/
+	void RenderGraph::Resize(VkExtent2D extent)
+	{
+		if (!built) throw std::runtime_error("Render graph resized before it was built.");
+
+		DestroySizedResources();
+		this->extent = extent;
+
+		CreateTransientImages();
+
+		for (int p = 0; p < passes.size(); p++)
+		{
+			if (passes[p].graphics && !passes[p].culled && !dynamicRendering) CreateFramebuffers(passes[p]);
+		}
+	}
+
+	/* Create Transient Images ----------------------------------------------*/
+	/*
+		Creates the transient images, then one allocation per memory slot,
+		big enough and aligned for every image sharing it. Images that are
+		only ever attachments never need their contents in memory, so
+		they are created transient, unless they are persistent.
+	*/
+	void RenderGraph::CreateTransientImages()
+	{
+		std::vector<VkMemoryRequirements> slotRequirements(memorySlots.size());
+		for (int i = 0; i < slotRequirements.size(); i++) slotRequirements[i] = { 0, 1, ~0u };
+
+		for (int i = 0; i < resources.size(); i++)
+		{
+			Resource& resource = resources[i];
+			if (resource.imported || resource.memorySlot < 0) continue;
+
+			VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+			VkImageUsageFlags usage = resource.usage;
+			if ((usage & ~attachmentUsage) == 0 && !resource.persistent) usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+			resource.fresh = resource.persistent;
+
+			VkImageCreateInfo imageInfo{};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.extent = { extent.width, extent.height, 1 };
+			imageInfo.mipLevels = 1;
+			imageInfo.arrayLayers = 1;
+			imageInfo.format = resource.format;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageInfo.usage = usage;
+			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			resource.images.resize(1);
+			if (vkCreateImage(device, &imageInfo, nullptr, &resource.images[0]) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create render graph image " + resource.name + ".");
+			}
+
+			VkMemoryRequirements memRequirements;
+			vkGetImageMemoryRequirements(device, resource.images[0], &memRequirements);
+
+			VkMemoryRequirements& slot = slotRequirements[resource.memorySlot];
+			slot.size = std::max(slot.size, memRequirements.size);
+			slot.alignment = std::max(slot.alignment, memRequirements.alignment);
+			slot.memoryTypeBits &= memRequirements.memoryTypeBits;
+		}
+
+		for (int i = 0; i < memorySlots.size(); i++)
+		{
+			if (slotRequirements[i].memoryTypeBits == 0)
+			{
+				throw std::runtime_error("Render graph images sharing memory have no memory type in common.");
+			}
+
+			memorySlots[i] = allocator->Allocate(slotRequirements[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, false, MEMORY_CATEGORY_TEXTURE);
+		}
+
+		for (int i = 0; i < resources.size(); i++)
+		{
+			Resource& resource = resources[i];
+			if (resource.imported || resource.memorySlot < 0) continue;
+
+			const Allocation& memory = memorySlots[resource.memorySlot];
+			if (vkBindImageMemory(device, resource.images[0], memory.memory, memory.offset) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to bind render graph image " + resource.name + ".");
+			}
+
+			VkImageViewCreateInfo viewInfo{};
+			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			viewInfo.image = resource.images[0];
+			viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			viewInfo.format = resource.format;
+			viewInfo.subresourceRange.aspectMask = resource.aspect;
+			viewInfo.subresourceRange.baseMipLevel = 0;
+			viewInfo.subresourceRange.levelCount = 1;
+			viewInfo.subresourceRange.baseArrayLayer = 0;
+			viewInfo.subresourceRange.layerCount = 1;
+
+			resource.views.resize(1);
+			if (vkCreateImageView(device, &viewInfo, nullptr, &resource.views[0]) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create render graph image view " + resource.name + ".");
+			}
+		}
+	}
+
+	/* Create Framebuffers --------------------------------------------------*/
+	/*
+		One framebuffer per image of the largest imported image set among
+		the pass's attachments; transient attachments are the same in all.
+	*/
+	void RenderGraph::CreateFramebuffers(Pass& pass)
+	{
+		size_t count = 1;
+		for (int u = 0; u < pass.uses.size(); u++)
+		{
+			const Resource& resource = resources[pass.uses[u].resource];
+			if (resource.isImage) count = std::max(count, resource.views.size());
+		}
+
+		pass.framebuffers.resize(count);
+
+		for (int i = 0; i < count; i++)
+		{
+			std::vector<VkImageView> attachments;
+			for (int u = 0; u < pass.uses.size(); u++)
+			{
+				const ResourceUse& use = pass.uses[u];
+				if (use.access != GRAPH_ACCESS_COLOR_ATTACHMENT && use.access != GRAPH_ACCESS_DEPTH_ATTACHMENT) continue;
+
+				const std::vector<VkImageView>& views = resources[use.resource].views;
+				attachments.push_back(views[i % views.size()]);
+			}
+
+			VkFramebufferCreateInfo framebufferInfo{};
+			framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+			framebufferInfo.renderPass = pass.renderPass;
+			framebufferInfo.attachmentCount = attachments.size();
+			framebufferInfo.pAttachments = attachments.data();
+			framebufferInfo.width = extent.width;
+			framebufferInfo.height = extent.height;
+			framebufferInfo.layers = 1;
+
+			if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &pass.framebuffers[i]) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create framebuffer for " + pass.name + ".");
+			}
+		}
+	}
+
+	/* Destroy Sized Resources ----------------------------------------------*/
+	/*
+		Everything Resize() creates. With a deletion queue it is destroyed
+		once the frames that used it finish; without one the caller makes
+		sure the GPU is done with it.
+	*/
+	void RenderGraph::DestroySizedResources()
+	{
+		for (int p = 0; p < passes.size(); p++)
+		{
+			for (int i = 0; i < passes[p].framebuffers.size(); i++)
+			{
+				if (deletionQueue != nullptr) deletionQueue->PushFramebuffer(passes[p].framebuffers[i]);
+				else vkDestroyFramebuffer(device, passes[p].framebuffers[i], nullptr);
+			}
+			passes[p].framebuffers.clear();
+		}
+
+		for (int i = 0; i < resources.size(); i++)
+		{
+			Resource& resource = resources[i];
+			if (resource.imported) continue;
+
+			for (int j = 0; j < resource.views.size(); j++)
+			{
+				if (deletionQueue != nullptr) deletionQueue->PushImageView(resource.views[j]);
+				else vkDestroyImageView(device, resource.views[j], nullptr);
+			}
+
+			/* The memory is the slot's, freed below. */
+			for (int j = 0; j < resource.images.size(); j++)
+			{
+				if (deletionQueue != nullptr) deletionQueue->PushImage(resource.images[j], Allocation{});
+				else vkDestroyImage(device, resource.images[j], nullptr);
+			}
+
+			resource.views.clear();
+			resource.images.clear();
+		}
+
+		for (int i = 0; i < memorySlots.size(); i++)
+		{
+			if (memorySlots[i].memory != VK_NULL_HANDLE)
+			{
+				if (deletionQueue != nullptr)
+				{
+					MemoryAllocator* allocator = this->allocator;
+					Allocation slot = memorySlots[i];
+					deletionQueue->Push([allocator, slot]() mutable { allocator->Free(slot); });
+				}
+				else allocator->Free(memorySlots[i]);
+			}
+			memorySlots[i] = Allocation{};
+		}
+	}
+
+	/* Set Dynamic Rendering ------------------------------------------------*/
+	/*
+		Draws graphics passes with vkCmdBeginRendering instead of render
+		passes and framebuffers, so Resize() only has to replace the
+		transient images. Must be called before Build().
+	*/
+	void RenderGraph::SetDynamicRendering(PFN_vkCmdBeginRenderingKHR begin, PFN_vkCmdEndRenderingKHR end)
+	{
+		if (built) throw std::runtime_error("Render graph switched to dynamic rendering after it was built.");
+
+		dynamicRendering = true;
+		cmdBeginRendering = begin;
+		cmdEndRendering = end;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Frame Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Set Images -----------------------------------------------------------*/
+	void RenderGraph::SetImages(GraphResource resource, const std::vector<VkImage>& images, const std::vector<VkImageView>& views)
+	{
+		resources[resource].images = images;
+		resources[resource].views = views;
+		resources[resource].imageIndex = 0;
+	}
+
+	/* Set Image Index ------------------------------------------------------*/
+	void RenderGraph::SetImageIndex(GraphResource resource, uint32_t index)
+	{
+		resources[resource].imageIndex = index;
+	}
+
+	/* Set Buffer -----------------------------------------------------------*/
+	void RenderGraph::SetBuffer(GraphResource resource, VkBuffer buffer)
+	{
+		resources[resource].buffer = buffer;
+	}
+
+	/* Set Render Area ------------------------------------------------------*/
+	/*
+		Limits a graphics pass to the top-left area of its attachments,
+		from the next Execute() on; { 0, 0 } goes back to the whole
+		extent. Only the area is cleared and drawn, so what's outside it
+		is left as it was.
+	*/
+	void RenderGraph::SetRenderArea(GraphPass pass, VkExtent2D area)
+	{
+		passes[pass].renderArea = area;
+	}
+
+	/* Execute --------------------------------------------------------------*/
+	/*
+		Records the frame: each pass behind its barriers, graphics passes
+		inside their render pass, then the final layout transitions.
+	*/
+	void RenderGraph::Execute(VkCommandBuffer commandBuffer)
+	{
+		RecordFreshTransitions(commandBuffer);
+
+		for (int p = 0; p < passes.size(); p++)
+		{
+			Pass& pass = passes[p];
+			if (pass.culled) continue;
+
+			RecordBarrier(commandBuffer, pass.transitions, pass.srcStages, pass.dstStages);
+
+			if (!pass.graphics)
+			{
+				pass.record(commandBuffer);
+				continue;
+			}
+
+			if (dynamicRendering)
+			{
+				BeginRendering(commandBuffer, pass);
+				pass.record(commandBuffer);
+				cmdEndRendering(commandBuffer);
+				continue;
+			}
+
+			uint32_t framebufferIndex = 0;
+			for (int u = 0; u < pass.uses.size(); u++)
+			{
+				const Resource& resource = resources[pass.uses[u].resource];
+				if (resource.imported && resource.isImage) framebufferIndex = resource.imageIndex;
+			}
+
+			VkRenderPassBeginInfo renderPassInfo{};
+			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			renderPassInfo.renderPass = pass.renderPass;
+			renderPassInfo.framebuffer = pass.framebuffers[framebufferIndex % pass.framebuffers.size()];
+			renderPassInfo.renderArea.offset = { 0, 0 };
+			renderPassInfo.renderArea.extent = GetRenderArea(pass);
+			renderPassInfo.clearValueCount = pass.clearValues.size();
+			renderPassInfo.pClearValues = pass.clearValues.data();
+
+			vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+			pass.record(commandBuffer);
+			vkCmdEndRenderPass(commandBuffer);
+		}
+
+		RecordBarrier(commandBuffer, finalTransitions, finalSrcStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Execute Functions													 */
+	/*-----------------------------------------------------------------------*/
+	/* Begin Rendering ------------------------------------------------------*/
+	/*
+		The dynamic rendering counterpart of beginning the pass's render
+		pass: the attachments are given directly, with this frame's views.
+	*/
+	void RenderGraph::BeginRendering(VkCommandBuffer commandBuffer, const Pass& pass)
+	{
+		std::vector<VkRenderingAttachmentInfoKHR> colorAttachments;
+		VkRenderingAttachmentInfoKHR depthAttachment{};
+		bool hasDepth = false;
+
+		for (int i = 0; i < pass.attachments.size(); i++)
+		{
+			const Attachment& planned = pass.attachments[i];
+			const Resource& resource = resources[planned.resource];
+
+			VkRenderingAttachmentInfoKHR attachment{};
+			attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+			attachment.imageView = resource.views[resource.imageIndex % resource.views.size()];
+			attachment.imageLayout = planned.layout;
+			attachment.resolveMode = VK_RESOLVE_MODE_NONE;
+			attachment.loadOp = planned.loadOp;
+			attachment.storeOp = planned.storeOp;
+			attachment.clearValue = planned.clear;
+
+			if (planned.depth)
+			{
+				depthAttachment = attachment;
+				hasDepth = true;
+			}
+			else colorAttachments.push_back(attachment);
+		}
+
+		VkRenderingInfoKHR renderingInfo{};
+		renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+		renderingInfo.renderArea.offset = { 0, 0 };
+		renderingInfo.renderArea.extent = GetRenderArea(pass);
+		renderingInfo.layerCount = 1;
+		renderingInfo.colorAttachmentCount = colorAttachments.size();
+		renderingInfo.pColorAttachments = colorAttachments.data();
+		renderingInfo.pDepthAttachment = hasDepth ? &depthAttachment : nullptr;
+		renderingInfo.pStencilAttachment = nullptr;
+
+		cmdBeginRendering(commandBuffer, &renderingInfo);
+	}
+
+	/* Record Fresh Transitions ---------------------------------------------*/
+	/*
+		The barriers were planned for persistent images that are already
+		in the layout the last frame left them in. A newly created one is
+		undefined, so it is moved into that layout first. Waiting on every
+		stage lets the frame's own barriers, whatever their stages, chain
+		on from this one.
+	*/
+	void RenderGraph::RecordFreshTransitions(VkCommandBuffer commandBuffer)
+	{
+		std::vector<Transition> transitions;
+		for (int i = 0; i < resources.size(); i++)
+		{
+			Resource& resource = resources[i];
+			if (!resource.fresh) continue;
+
+			resource.fresh = false;
+			if (resource.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED) continue;
+
+			transitions.push_back({ (GraphResource)i, 0, 0, VK_IMAGE_LAYOUT_UNDEFINED, resource.initialLayout });
+		}
+
+		RecordBarrier(commandBuffer, transitions, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+	}
+
+	/* Get Render Area ------------------------------------------------------*/
+	VkExtent2D RenderGraph::GetRenderArea(const Pass& pass)
+	{
+		if (pass.renderArea.width == 0 || pass.renderArea.height == 0) return extent;
+		return { std::min(pass.renderArea.width, extent.width), std::min(pass.renderArea.height, extent.height) };
+	}
+
+	/* Record Barrier -------------------------------------------------------*/
+	/*
+		All of a pass's transitions go into one vkCmdPipelineBarrier.
+	*/
+	void RenderGraph::RecordBarrier(	VkCommandBuffer commandBuffer, const std::vector<Transition>& transitions,
+										VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages)
+	{
+		if (transitions.empty()) return;
+
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+		std::vector<VkBufferMemoryBarrier> bufferBarriers;
+
+		for (int i = 0; i < transitions.size(); i++)
+		{
+			const Transition& transition = transitions[i];
+			const Resource& resource = resources[transition.resource];
+
+			if (resource.isImage)
+			{
+				if (resource.images.empty()) continue;
+
+				VkImageMemoryBarrier barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				barrier.srcAccessMask = transition.srcAccess;
+				barrier.dstAccessMask = transition.dstAccess;
+				barrier.oldLayout = transition.oldLayout;
+				barrier.newLayout = transition.newLayout;
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.image = resource.images[resource.imageIndex % resource.images.size()];
+				barrier.subresourceRange.aspectMask = resource.aspect;
+				barrier.subresourceRange.baseMipLevel = 0;
+				barrier.subresourceRange.levelCount = 1;
+				barrier.subresourceRange.baseArrayLayer = 0;
+				barrier.subresourceRange.layerCount = 1;
+				imageBarriers.push_back(barrier);
+			}
+			else
+			{
+				if (resource.buffer == VK_NULL_HANDLE) continue;
+
+				VkBufferMemoryBarrier barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				barrier.srcAccessMask = transition.srcAccess;
+				barrier.dstAccessMask = transition.dstAccess;
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.buffer = resource.buffer;
+				barrier.offset = 0;
+				barrier.size = VK_WHOLE_SIZE;
+				bufferBarriers.push_back(barrier);
+			}
+		}
+
+		if (srcStages == 0) srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		if (dstStages == 0) dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+		vkCmdPipelineBarrier(	commandBuffer, srcStages, dstStages, 0, 0, nullptr,
+								bufferBarriers.size(), bufferBarriers.data(),
+								imageBarriers.size(), imageBarriers.data());
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Constructor															 */
+	/*-----------------------------------------------------------------------*/
+	RenderGraph::RenderGraph(VkDevice device, MemoryAllocator* allocator)
+	{
+		this->device = device;
+		this->allocator = allocator;
+		this->extent = { 0, 0 };
+		this->built = false;
+		this->dynamicRendering = false;
+		this->cmdBeginRendering = nullptr;
+		this->cmdEndRendering = nullptr;
+		this->deletionQueue = nullptr;
+		this->finalSrcStages = 0;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Deconstructor														 */
+	/*-----------------------------------------------------------------------*/
+	RenderGraph::~RenderGraph()
+	{
+		DestroySizedResources();
+
+		for (int p = 0; p < passes.size(); p++)
+		{
+			if (passes[p].renderPass != VK_NULL_HANDLE) vkDestroyRenderPass(device, passes[p].renderPass, nullptr);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,286 @@
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Render_Graph.h																										 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "allocator.h"
+#include "deletion_queue.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Graph Handles																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		Resources and passes are referred to by their index in the graph.
+	*/
+	typedef uint32_t GraphResource;
+	typedef uint32_t GraphPass;
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Graph Access																				   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		How a pass uses a resource. The graph turns each one into the
+		pipeline stage, access mask and image layout it needs, so passes
+		never write barriers of their own.
+	*/
+	enum GraphAccess
+	{
+		GRAPH_ACCESS_COLOR_ATTACHMENT,
+		GRAPH_ACCESS_DEPTH_ATTACHMENT,
+		GRAPH_ACCESS_SAMPLED,
+		GRAPH_ACCESS_TRANSFER_READ,
+		GRAPH_ACCESS_TRANSFER_WRITE,
+		GRAPH_ACCESS_COMPUTE_READ,
+		GRAPH_ACCESS_COMPUTE_WRITE,
+		GRAPH_ACCESS_VERTEX_READ,
+		GRAPH_ACCESS_INDIRECT_READ
+	};
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Render Graph																				   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		Describes a frame as a list of passes and the resources each one
+		reads and writes, and works out everything in between: the barriers
+		and layout transitions before each pass, the render passes and
+		framebuffers of the graphics passes, and the memory of the images
+		that only live within a frame.
+
+		Resources are either imported (swap chain images, and buffers the
+		renderer owns), transient or persistent. Transient images are
+		created by the graph at its extent; ones whose lifetimes don't
+		overlap share memory, and ones that are only ever attachments are
+		created with the transient usage, since their contents never leave
+		the pass. Persistent images are created the same way but keep
+		their contents from one frame to the next, so they get memory of
+		their own and are loaded rather than discarded.
+
+		Passes that only write transient resources nobody reads are culled.
+		Imported and persistent resources outlive the frame, so writing one
+		keeps a pass.
+
+		Every frame runs the same graph, so a resource's first use in a
+		frame is synchronised against its last use in the frame before.
+
+		Build() compiles the passes once; Resize() (re)creates everything
+		that depends on the extent. A graphics pass can draw to less than
+		the extent (see SetRenderArea()), which changes nothing else, so
+		it can differ from frame to frame. Graphics passes' render passes survive
+		Resize(), so pipelines built against them stay valid. With dynamic
+		rendering there are no render passes or framebuffers at all. Given
+		a deletion queue, Resize() hands the old images and framebuffers to
+		it instead of destroying them, so frames in flight can finish with
+		them.
+	*/
+	class RenderGraph
+	{
+	private:
+		/*-------------------------------------------------------------------*/
+		/* Resources														 */
+		/*-------------------------------------------------------------------*/
+		struct Resource
+		{
+			std::string					name;
+			bool						imported;
+			bool						persistent;
+			bool						isImage;
+
+			/* Images --------------------------------------------------*/
+			VkFormat					format;
+			VkImageAspectFlags			aspect;
+			VkImageUsageFlags			usage;
+			VkImageLayout				initialLayout;
+			VkPipelineStageFlags		initialStage;
+			VkImageLayout				finalLayout;
+			std::vector<VkImage>		images;
+			std::vector<VkImageView>	views;
+			uint32_t					imageIndex;
+
+			/* A persistent image created since the last Execute(). */
+			bool						fresh;
+
+			/* Buffers -------------------------------------------------*/
+			VkBuffer					buffer;
+
+			/* Lifetime ------------------------------------------------*/
+			int							firstUse;
+			int							lastUse;
+			int							memorySlot;
+		};
+
+		std::vector<Resource>			resources;
+
+		/*-------------------------------------------------------------------*/
+		/* Passes															 */
+		/*-------------------------------------------------------------------*/
+		struct ResourceUse
+		{
+			GraphResource				resource;
+			GraphAccess					access;
+			VkClearValue				clear;
+			bool						cleared;
+		};
+
+		/*
+			One barrier the graph has decided on. Handles are filled in
+			at execution, since imported resources change from frame to
+			frame.
+		*/
+		struct Transition
+		{
+			GraphResource				resource;
+			VkAccessFlags				srcAccess;
+			VkAccessFlags				dstAccess;
+			VkImageLayout				oldLayout;
+			VkImageLayout				newLayout;
+		};
+
+		struct Attachment
+		{
+			GraphResource				resource;
+			bool						depth;
+			VkImageLayout				layout;
+			VkAttachmentLoadOp			loadOp;
+			VkAttachmentStoreOp			storeOp;
+			VkClearValue				clear;
+		};
+
+		struct Pass
+		{
+			std::string					name;
+			bool						graphics;
+			std::vector<ResourceUse>	uses;
+			std::function<void(VkCommandBuffer)> record;
+			bool						culled;
+
+			std::vector<Transition>		transitions;
+			VkPipelineStageFlags		srcStages;
+			VkPipelineStageFlags		dstStages;
+
+			std::vector<Attachment>		attachments;
+			std::vector<VkClearValue>	clearValues;
+			std::vector<VkFormat>		colorFormats;
+			VkFormat					depthFormat;
+			VkExtent2D					renderArea;
+
+			VkRenderPass				renderPass;
+			std::vector<VkFramebuffer>	framebuffers;
+		};
+
+		std::vector<Pass>				passes;
+
+		/*
+			The transitions that take imported images to their final
+			layout after the last pass.
+		*/
+		std::vector<Transition>			finalTransitions;
+		VkPipelineStageFlags			finalSrcStages;
+
+		/*-------------------------------------------------------------------*/
+		/* Memory															 */
+		/*-------------------------------------------------------------------*/
+		std::vector<Allocation>			memorySlots;
+		VkExtent2D						extent;
+		bool							built;
+
+		/*-------------------------------------------------------------------*/
+		/* Dynamic Rendering												 */
+		/*-------------------------------------------------------------------*/
+		bool							dynamicRendering;
+		PFN_vkCmdBeginRenderingKHR		cmdBeginRendering;
+		PFN_vkCmdEndRenderingKHR		cmdEndRendering;
+
+		/*-------------------------------------------------------------------*/
+		/* Vulkan															 */
+		/*-------------------------------------------------------------------*/
+		VkDevice						device;
+		MemoryAllocator*				allocator;
+		DeletionQueue*					deletionQueue;
+
+		/*-------------------------------------------------------------------*/
+		/* Build Helpers													 */
+		/*-------------------------------------------------------------------*/
+		void							CullPasses();
+		void							PlanTransitions();
+		void							PlanAttachments(Pass& pass);
+		void							CreateRenderPass(Pass& pass);
+		void							CreateTransientImages();
+		void							CreateFramebuffers(Pass& pass);
+		void							DestroySizedResources();
+		void							RecordFreshTransitions(VkCommandBuffer commandBuffer);
+
+		/*-------------------------------------------------------------------*/
+		/* Execute Functions												 */
+		/*-------------------------------------------------------------------*/
+		void							BeginRendering(VkCommandBuffer commandBuffer, const Pass& pass);
+		VkExtent2D						GetRenderArea(const Pass& pass);
+		void							RecordBarrier(	VkCommandBuffer commandBuffer, const std::vector<Transition>& transitions,
+														VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages);
+
+	public:
+		/*-------------------------------------------------------------------*/
+		/* Declaration Functions											 */
+		/*-------------------------------------------------------------------*/
+		GraphResource					ImportImage(std::string name, VkFormat format, VkImageAspectFlags aspect,
+													VkImageLayout initialLayout, VkPipelineStageFlags initialStage, VkImageLayout finalLayout);
+		GraphResource					ImportBuffer(std::string name);
+		GraphResource					CreateImage(std::string name, VkFormat format, VkImageAspectFlags aspect);
+		GraphResource					CreatePersistentImage(std::string name, VkFormat format, VkImageAspectFlags aspect);
+		GraphPass						AddPass(std::string name, bool graphics, std::function<void(VkCommandBuffer)> record);
+		void							Use(GraphPass pass, GraphResource resource, GraphAccess access);
+		void							UseAttachment(GraphPass pass, GraphResource resource, GraphAccess access, VkClearValue clear);
+
+		/*-------------------------------------------------------------------*/
+		/* Compile Functions												 */
+		/*-------------------------------------------------------------------*/
+		void							SetDynamicRendering(PFN_vkCmdBeginRenderingKHR begin, PFN_vkCmdEndRenderingKHR end);
+		void							SetDeletionQueue(DeletionQueue* queue) { deletionQueue = queue; }
+		void							Build();
+		void							Resize(VkExtent2D extent);
+
+		/*-------------------------------------------------------------------*/
+		/* Frame Functions													 */
+		/*-------------------------------------------------------------------*/
+		void							SetImages(GraphResource resource, const std::vector<VkImage>& images, const std::vector<VkImageView>& views);
+		void							SetImageIndex(GraphResource resource, uint32_t index);
+		void							SetBuffer(GraphResource resource, VkBuffer buffer);
+		void							SetRenderArea(GraphPass pass, VkExtent2D area);
+		void							Execute(VkCommandBuffer commandBuffer);
+
+		/*-------------------------------------------------------------------*/
+		/* Getters															 */
+		/*-------------------------------------------------------------------*/
+		VkRenderPass					GetRenderPass(GraphPass pass) { return passes[pass].renderPass; }
+		void							GetPipelineRenderingInfo(GraphPass pass, VkPipelineRenderingCreateInfoKHR& info);
+		bool							GetPassCulled(GraphPass pass) { return passes[pass].culled; }
+		VkExtent2D						GetExtent() { return extent; }
+		VkImage							GetImage(GraphResource resource);
+
+		/*-------------------------------------------------------------------*/
+		/* Constructor														 */
+		/*-------------------------------------------------------------------*/
+		RenderGraph(VkDevice device, MemoryAllocator* allocator);
+
+		/*-------------------------------------------------------------------*/
+		/* Deconstructor													 */
+		/*-------------------------------------------------------------------*/
+		~RenderGraph();
+	};
+}
+
+#endif
\ No newline at end of file
@@ -18,6 +18,106 @@ namespace VkExample
 	/*-----------------------------------------------------------------------*/
 	/* Command Functions													 */
 	/*-----------------------------------------------------------------------*/
+	/* Record Upload Commands -----------------------------------------------*/
+	/*
+		Copies everything pending into the vertex buffer: vertices queued
+		with QueueVertexUpload() or staged by WriteVertexBuffer(), and what
+		a grow kept from the old buffer. The render graph keeps the copies
+		from overwriting vertices earlier frames are still drawing, and
+		makes the new ones visible to this frame's draws.
+
+		Once this frame finishes, the staging buffer is free again.
+	*/
+	void Renderer::RecordUploadCommands(VkCommandBuffer commandBuffer)
+	{
+		VkDeviceSize extent = (VkDeviceSize)vertexCount * sizeof(Vertex);
+		for (int i = 0; i < pendingCopies.size(); i++)
+		{
+			extent = std::max(extent, pendingCopies[i].region.dstOffset + pendingCopies[i].region.size);
+		}
+
+		frameVertexBuffers[frame] = vertexBuffer;
+		frameVertexExtents[frame] = extent;
+
+		if (stagingOffset > 0)
+		{
+			stagingFrameValue = submittedFrameValue + 1;
+			stagingOffset = 0;
+		}
+
+		RecordVertexCopies(commandBuffer);
+	}
+
+	/* Record Vertex Copies -------------------------------------------------*/
+	/*
+		Records the pending copies, one vkCmdCopyBuffer per run with the
+		same source. A grow copy reads an old vertex buffer that an earlier
+		frame may have copied into, so that write is made visible first.
+	*/
+	void Renderer::RecordVertexCopies(VkCommandBuffer commandBuffer)
+	{
+		if (pendingCopies.empty()) return;
+
+		if (growCopiesPending)
+		{
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+			growCopiesPending = false;
+		}
+
+		std::vector<VkBufferCopy> regions;
+		for (int i = 0; i < pendingCopies.size(); i++)
+		{
+			regions.push_back(pendingCopies[i].region);
+			if (i + 1 < pendingCopies.size() && pendingCopies[i + 1].source == pendingCopies[i].source) continue;
+
+			vkCmdCopyBuffer(commandBuffer, pendingCopies[i].source, vertexBuffer, regions.size(), regions.data());
+			regions.clear();
+		}
+
+		pendingCopies.clear();
+	}
+
+	/* Record Indirect Reset Commands ---------------------------------------*/
+	/*
+		Zeroes this frame's indirect buffer before cull.comp appends to it.
+		Without a draw count buffer every command slot gets drawn, so the
+		ones the shader doesn't write this frame must be zeroed too.
+	*/
+	void Renderer::RecordIndirectResetCommands(VkCommandBuffer commandBuffer)
+	{
+		uint32_t cullChunkCount = cullChunkCounts[frame];
+		if (!GetGpuCullingActive() || cullChunkCount == 0) return;
+
+		VkDeviceSize clearSize = sizeof(IndirectDrawHeader);
+		if (!drawIndirectCountSupported) clearSize += (VkDeviceSize)cullChunkCount * sizeof(VkDrawIndirectCommand);
+		vkCmdFillBuffer(commandBuffer, indirectBuffers[frame], 0, clearSize, 0);
+	}
+
+	/* Record Cull Commands -------------------------------------------------*/
+	/*
+		Runs cull.comp over every chunk. Nothing is read back; the CPU never
+		learns how many chunks survived.
+	*/
+	void Renderer::RecordCullCommands(VkCommandBuffer commandBuffer)
+	{
+		uint32_t cullChunkCount = cullChunkCounts[frame];
+		if (!GetGpuCullingActive() || cullChunkCount == 0) return;
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0, 1, &cullDescriptorSets[frame], 0, nullptr);
+		vkCmdPushConstants(commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &cullChunkCount);
+		vkCmdDispatch(commandBuffer, (cullChunkCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+	}
+
+	/* Record Command Buffer ------------------------------------------------*/
+	/*
+		Points the render graph at this frame's swap chain image and
+		buffers, and lets it record the frame.
+	*/
 	void Renderer::RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 	{
 		VkCommandBufferBeginInfo beginInfo{};
@@ -30,133 +130,1463 @@ namespace VkExample
 			throw std::runtime_error("Failed to begin recording command buffer.");
 		}
 
-		VkRenderPassBeginInfo renderPassInfo{};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = renderPass;
-		renderPassInfo.framebuffer = framebuffers[imageIndex];
-		renderPassInfo.renderArea.offset = { 0, 0 };
-		renderPassInfo.renderArea.extent = swapChain.extent;
+		if (gpuTiming)
+		{
+			vkCmdResetQueryPool(commandBuffer, timestampPool, frame * 2, 2);
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, frame * 2);
+		}
+
+		renderGraph->SetImageIndex(swapChainTarget, imageIndex);
+		if (dynamicResolution) renderGraph->SetRenderArea(scenePass, GetRenderExtent());
+		renderGraph->SetBuffer(vertexBufferResource, vertexBuffer);
+		renderGraph->SetBuffer(cullChunkResource, cullChunkBuffers[frame]);
+		renderGraph->SetBuffer(indirectResource, indirectBuffers[frame]);
+		renderGraph->Execute(commandBuffer);
+
+		if (gpuTiming)
+		{
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, frame * 2 + 1);
+			timestampsWritten[frame] = true;
+		}
+
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to record command buffer.");
+		}
+	}
+
+	/* Record Upscale Commands ----------------------------------------------*/
+	/*
+		Stretches the drawn part of the scene target over the whole swap
+		chain image, filtered; at full scale it's a plain copy. The render
+		graph has already put both in transfer layouts.
+	*/
+	void Renderer::RecordUpscaleCommands(VkCommandBuffer commandBuffer)
+	{
+		VkExtent2D renderExtent = GetRenderExtent();
+
+		if (renderExtent.width == swapChain.extent.width && renderExtent.height == swapChain.extent.height)
+		{
+			VkImageCopy copy{};
+			copy.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+			copy.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+			copy.extent = { renderExtent.width, renderExtent.height, 1 };
+
+			vkCmdCopyImage(	commandBuffer,
+							renderGraph->GetImage(sceneTarget), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+							renderGraph->GetImage(swapChainTarget), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+							1, &copy);
+			return;
+		}
+
+		VkImageBlit blit{};
+		blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		blit.srcOffsets[0] = { 0, 0, 0 };
+		blit.srcOffsets[1] = { (int32_t)renderExtent.width, (int32_t)renderExtent.height, 1 };
+		blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		blit.dstOffsets[0] = { 0, 0, 0 };
+		blit.dstOffsets[1] = { (int32_t)swapChain.extent.width, (int32_t)swapChain.extent.height, 1 };
+
+		vkCmdBlitImage(	commandBuffer,
+						renderGraph->GetImage(sceneTarget), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						renderGraph->GetImage(swapChainTarget), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						1, &blit, VK_FILTER_LINEAR);
+	}
+
+	/* Get Scene Viewport ---------------------------------------------------*/
+	/*
+		A view's viewport and scissor are in window pixels; with dynamic
+		resolution they're scaled down onto the part of the scene target
+		drawn to. The projection doesn't change, so neither does what's
+		visible.
+	*/
+	void Renderer::GetSceneViewport(Camera* viewCamera, VkViewport& viewport, VkRect2D& scissor)
+	{
+		viewport = viewCamera->GetViewport();
+		scissor = viewCamera->GetScissor();
+		if (!dynamicResolution) return;
+
+		VkExtent2D renderExtent = GetRenderExtent();
+		float scaleX = (float)renderExtent.width / swapChain.extent.width;
+		float scaleY = (float)renderExtent.height / swapChain.extent.height;
+
+		viewport.x *= scaleX;
+		viewport.y *= scaleY;
+		viewport.width *= scaleX;
+		viewport.height *= scaleY;
+
+		scissor.offset = { (int32_t)(scissor.offset.x * scaleX), (int32_t)(scissor.offset.y * scaleY) };
+		scissor.extent = {	std::min((uint32_t)ceil(scissor.extent.width * scaleX), renderExtent.width),
+							std::min((uint32_t)ceil(scissor.extent.height * scaleY), renderExtent.height) };
+	}
+
+	/* Record Scene Commands ------------------------------------------------*/
+	/*
+		The scene pass: every view in turn. Runs inside the render pass
+		the render graph begins.
+	*/
+	void Renderer::RecordSceneCommands(VkCommandBuffer commandBuffer)
+	{
+		/*
+			With damage tracking the target still holds the last frame, so
+			only the damaged part is cleared, and drawing is cut to it.
+		*/
+		if (damageTracking)
+		{
+			if (damageRect.extent.width == 0 || damageRect.extent.height == 0) return;
+
+			VkClearAttachment clear{};
+			clear.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			clear.colorAttachment = 0;
+			clear.clearValue = clearColor;
+
+			VkClearRect clearRect{};
+			clearRect.rect = damageRect;
+			clearRect.baseArrayLayer = 0;
+			clearRect.layerCount = 1;
+			vkCmdClearAttachments(commandBuffer, 1, &clear, 1, &clearRect);
+		}
+
+		for (uint32_t i = 0; i < views.size(); i++) RecordViewCommands(commandBuffer, i);
+	}
+
+	/* Record View Commands -------------------------------------------------*/
+	/*
+		One view: opaque chunks, then transparent geometry, cut to the
+		view's scissor. Views after the first are drawn over the main one,
+		so their part of the target is cleared first, depth included, to
+		give each a background of its own.
+	*/
+	void Renderer::RecordViewCommands(VkCommandBuffer commandBuffer, uint32_t viewIndex)
+	{
+		RenderView& view = views[viewIndex];
+
+		VkViewport viewport;
+		VkRect2D scissor;
+		GetSceneViewport(view.camera, viewport, scissor);
+
+		scissor = IntersectRects(scissor, { { 0, 0 }, GetRenderExtent() });
+		if (damageTracking) scissor = IntersectRects(scissor, damageRect);
+		if (scissor.extent.width == 0 || scissor.extent.height == 0) return;
+
+		if (viewIndex > 0)
+		{
+			VkClearAttachment clears[2]{};
+			clears[0].aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			clears[0].colorAttachment = 0;
+			clears[0].clearValue = clearColor;
+			clears[1].aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+			clears[1].clearValue.depthStencil = { 1.0f, 0 };
+
+			VkClearRect clearRect{};
+			clearRect.rect = scissor;
+			clearRect.baseArrayLayer = 0;
+			clearRect.layerCount = 1;
+			vkCmdClearAttachments(commandBuffer, depthFormat != VK_FORMAT_UNDEFINED ? 2 : 1, clears, 1, &clearRect);
+		}
 
-		VkClearValue clearColor = { { { 1.0f, 1.0f, 1.0f, 1.0f } } };
-		renderPassInfo.clearValueCount = 1;
-		renderPassInfo.pClearValues = &clearColor;
+		/* Each view reads its own slice of the uniform buffer. */
+		uint32_t uniformOffset = (uint32_t)(viewIndex * uniformStride);
 
-		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depthTesting ? depthPipeline : graphicsPipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[frame], 1, &uniformOffset);
 
-		vkCmdSetViewport(commandBuffer, 0, 1, &camera->GetViewport());
-		vkCmdSetScissor(commandBuffer, 0, 1, &camera->GetScissor());
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
 		VkBuffer vertexBuffers[] = { vertexBuffer };
 		VkDeviceSize offsets[] = { 0 };
 		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 
-		vkCmdDraw(commandBuffer, MAX_TRIANGLES * 3, 1, 0, 0);
-		vkCmdEndRenderPass(commandBuffer);
+		/* cull.comp only culls for the main view; the others are culled on the CPU. */
+		if (viewIndex == 0 && GetGpuCullingActive())
+		{
+			/*
+				cull.comp has written one command per visible chunk. With a
+				draw count buffer the GPU issues exactly that many; otherwise
+				we issue one per chunk and the unused ones draw nothing.
+			*/
+			VkBuffer indirectBuffer = indirectBuffers[frame];
+			uint32_t cullChunkCount = cullChunkCounts[frame];
+			VkDeviceSize commandsOffset = sizeof(IndirectDrawHeader);
+			uint32_t stride = sizeof(VkDrawIndirectCommand);
+
+			if (drawIndirectCountSupported)
+			{
+				cmdDrawIndirectCount(commandBuffer, indirectBuffer, commandsOffset, indirectBuffer, 0, cullChunkCount, stride);
+			}
+			else if (multiDrawIndirectSupported)
+			{
+				vkCmdDrawIndirect(commandBuffer, indirectBuffer, commandsOffset, cullChunkCount, stride);
+			}
+			else
+			{
+				for (uint32_t i = 0; i < cullChunkCount; i++)
+				{
+					vkCmdDrawIndirect(commandBuffer, indirectBuffer, commandsOffset + (VkDeviceSize)i * stride, 1, stride);
+				}
+			}
+		}
+		else
+		{
+			/*
+				Only the chunks the culler found in the view are drawn, one
+				draw per run of neighbouring visible chunks.
+			*/
+			const std::vector<DrawRange>& drawRanges = viewIndex == 0 ? culler->GetDrawRanges() : view.drawRanges;
+			for (int i = 0; i < drawRanges.size(); i++)
+			{
+				vkCmdDraw(commandBuffer, drawRanges[i].vertexCount, 1, drawRanges[i].firstVertex, 0);
+			}
+		}
+
+		/*
+			Transparent geometry goes last, already sorted back to front,
+			in a single draw.
+		*/
+		if (transparentVertexCount > 0)
+		{
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, transparentPipeline);
+
+			VkBuffer transparentBuffer[] = { transparentBuffers[frame] };
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, transparentBuffer, offsets);
+			vkCmdDraw(commandBuffer, transparentVertexCount, 1, 0, 0);
+		}
+	}
 
-		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+	/* Intersect Rects ------------------------------------------------------*/
+	/*
+		The part of a inside b; empty if they don't overlap.
+	*/
+	VkRect2D Renderer::IntersectRects(VkRect2D a, VkRect2D b)
+	{
+		int32_t x0 = std::max(a.offset.x, b.offset.x);
+		int32_t y0 = std::max(a.offset.y, b.offset.y);
+		int32_t x1 = std::min(a.offset.x + (int32_t)a.extent.width, b.offset.x + (int32_t)b.extent.width);
+		int32_t y1 = std::min(a.offset.y + (int32_t)a.extent.height, b.offset.y + (int32_t)b.extent.height);
+		if (x1 <= x0 || y1 <= y0) return {};
+
+		return { { x0, y0 }, { (uint32_t)(x1 - x0), (uint32_t)(y1 - y0) } };
+	}
+
+	/* Same View Rect -------------------------------------------------------*/
+	/*
+		Whether a view's camera still has the viewport and scissor it had
+		when they were stored.
+	*/
+	bool Renderer::SameViewRect(Camera* viewCamera, VkViewport viewport, VkRect2D scissor)
+	{
+		VkViewport currentViewport = viewCamera->GetViewport();
+		VkRect2D currentScissor = viewCamera->GetScissor();
+		return	memcmp(&currentViewport, &viewport, sizeof(VkViewport)) == 0 &&
+				memcmp(&currentScissor, &scissor, sizeof(VkRect2D)) == 0;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Frame Completion Functions											 */
+	/*-----------------------------------------------------------------------*/
+	/* Submit Frame ---------------------------------------------------------*/
+	/*
+		Submits this frame's command buffer, signalling the next frame
+		value: on the frame timeline if there is one, and otherwise through
+		this slot's fence. With synchronization2 this goes through
+		vkQueueSubmit2, where every semaphore carries its own stage and
+		value, and the binary and timeline semaphores sit side by side.
+	*/
+	void Renderer::SubmitFrame()
+	{
+		uint64_t frameValue = submittedFrameValue + 1;
+		VkFence fence = timelineSupported ? VK_NULL_HANDLE : inFlights[frame];
+		VkResult result;
+
+		if (synchronization2Supported)
 		{
-			throw std::runtime_error("Failed to record command buffer.");
+			VkSemaphoreSubmitInfoKHR waitInfo{};
+			waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+			waitInfo.semaphore = imagesAvailable[frame];
+			waitInfo.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+			VkCommandBufferSubmitInfoKHR commandBufferInfo{};
+			commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+			commandBufferInfo.commandBuffer = commandBuffers[frame];
+
+			VkSemaphoreSubmitInfoKHR signalInfos[2] = {};
+			signalInfos[0].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+			signalInfos[0].semaphore = rendersFinished[frame];
+			signalInfos[0].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			signalInfos[1].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+			signalInfos[1].semaphore = frameTimeline;
+			signalInfos[1].value = frameValue;
+			signalInfos[1].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+			VkSubmitInfo2KHR submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+			submitInfo.waitSemaphoreInfoCount = 1;
+			submitInfo.pWaitSemaphoreInfos = &waitInfo;
+			submitInfo.commandBufferInfoCount = 1;
+			submitInfo.pCommandBufferInfos = &commandBufferInfo;
+			submitInfo.signalSemaphoreInfoCount = timelineSupported ? 2 : 1;
+			submitInfo.pSignalSemaphoreInfos = signalInfos;
+
+			result = queueSubmit2(graphicsQueue, 1, &submitInfo, fence);
+		}
+		else
+		{
+			VkSemaphore waitSemaphores[] = { imagesAvailable[frame] };
+			VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+			VkSemaphore signalSemaphores[] = { rendersFinished[frame], frameTimeline };
+
+			/*
+				Binary semaphores ignore their value, but the arrays have to
+				line up with the semaphores.
+			*/
+			uint64_t waitValues[] = { 0 };
+			uint64_t signalValues[] = { 0, frameValue };
+
+			VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+			timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			timelineInfo.waitSemaphoreValueCount = 1;
+			timelineInfo.pWaitSemaphoreValues = waitValues;
+			timelineInfo.signalSemaphoreValueCount = 2;
+			timelineInfo.pSignalSemaphoreValues = signalValues;
+
+			VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.pNext = timelineSupported ? &timelineInfo : nullptr;
+			submitInfo.waitSemaphoreCount = 1;
+			submitInfo.pWaitSemaphores = waitSemaphores;
+			submitInfo.pWaitDstStageMask = waitStages;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &commandBuffers[frame];
+			submitInfo.signalSemaphoreCount = timelineSupported ? 2 : 1;
+			submitInfo.pSignalSemaphores = signalSemaphores;
+
+			result = vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence);
 		}
+
+		if (result != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit draw command buffer!");
+		}
+
+		submittedFrameValue = frameValue;
+		frameValues[frame] = frameValue;
+		deletionQueue->SetFrameValue(submittedFrameValue + 1);
+	}
+
+	/* Wait For Frame Value -------------------------------------------------*/
+	/*
+		Blocks until every frame up to and including the one that signalled
+		value has finished on the GPU. Without timeline semaphores this
+		waits on the fence of the oldest frame slot at or past value;
+		frames finish in submission order, so that covers the rest.
+	*/
+	void Renderer::WaitForFrameValue(uint64_t value)
+	{
+		if (value <= completedFrameValue) return;
+
+		if (timelineSupported)
+		{
+			VkSemaphoreWaitInfoKHR waitInfo{};
+			waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+			waitInfo.semaphoreCount = 1;
+			waitInfo.pSemaphores = &frameTimeline;
+			waitInfo.pValues = &value;
+
+			waitSemaphores(device, &waitInfo, UINT64_MAX);
+			completedFrameValue = value;
+			return;
+		}
+
+		int slot = -1;
+		for (int i = 0; i < frameValues.size(); i++)
+		{
+			if (frameValues[i] >= value && (slot < 0 || frameValues[i] < frameValues[slot])) slot = i;
+		}
+
+		if (slot < 0) return;
+
+		vkWaitForFences(device, 1, &inFlights[slot], VK_TRUE, UINT64_MAX);
+		completedFrameValue = frameValues[slot];
+	}
+
+	/* Wait For Frame -------------------------------------------------------*/
+	/*
+		Waits until the frame slot's last submission has finished, so its
+		per-frame resources can be reused.
+	*/
+	void Renderer::WaitForFrame(unsigned int frameIndex)
+	{
+		WaitForFrameValue(frameValues[frameIndex]);
+	}
+
+	/* Wait For All Frames --------------------------------------------------*/
+	void Renderer::WaitForAllFrames()
+	{
+		WaitForFrameValue(submittedFrameValue);
+	}
+
+	/* Get Completed Frame Value --------------------------------------------*/
+	/*
+		The newest frame value the GPU is known to have finished, without
+		waiting. Anything last used by a frame at or below it is free.
+	*/
+	uint64_t Renderer::GetCompletedFrameValue()
+	{
+		if (timelineSupported)
+		{
+			uint64_t value = completedFrameValue;
+			getSemaphoreCounterValue(device, frameTimeline, &value);
+			completedFrameValue = std::max(completedFrameValue, value);
+			return completedFrameValue;
+		}
+
+		for (int i = 0; i < frameValues.size(); i++)
+		{
+			if (frameValues[i] > completedFrameValue && vkGetFenceStatus(device, inFlights[i]) == VK_SUCCESS)
+			{
+				completedFrameValue = frameValues[i];
+			}
+		}
+
+		return completedFrameValue;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* GPU Timing Functions													 */
+	/*-----------------------------------------------------------------------*/
+	/* Read Timestamps ------------------------------------------------------*/
+	/*
+		Reads back the GPU time of this slot's last frame. Must be called
+		after Render() has waited for the slot, so the results are ready
+		without waiting.
+	*/
+	void Renderer::ReadTimestamps()
+	{
+		if (!gpuTiming || !timestampsWritten[frame]) return;
+
+		uint64_t timestamps[2];
+		VkResult result = vkGetQueryPoolResults(device, timestampPool, frame * 2, 2, sizeof(timestamps), timestamps,
+												sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		timestampsWritten[frame] = false;
+		if (result != VK_SUCCESS) return;
+
+		uint64_t ticks = (timestamps[1] - timestamps[0]) & timestampMask;
+		gpuFrameMs = ticks * (double)timestampPeriod / 1000000.0;
+		gpuFrameSamples++;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Present Timing Functions												 */
+	/*-----------------------------------------------------------------------*/
+	/* Wait For Present -----------------------------------------------------*/
+	/*
+		Waits up to timeoutNs for the oldest pending present to finish,
+		then takes any later ones that have too. A present is timed when
+		its finish is seen, so the frame pacer calls this while it waits.
+		Says whether the oldest present finished.
+	*/
+	bool Renderer::WaitForPresent(uint64_t timeoutNs)
+	{
+		if (!presentWaitSupported || pendingPresents.empty()) return false;
+
+		bool finished = false;
+		while (!pendingPresents.empty())
+		{
+			VkResult result = waitForPresent(device, swapChain.base, pendingPresents.front().id, finished ? 0 : timeoutNs);
+			if (result != VK_SUCCESS) break;
+
+			uint64_t now = Profiler::Now();
+			if (framePacer != nullptr)
+			{
+				framePacer->RecordLatency(now - pendingPresents.front().frameStart);
+				if (!displayTimingSupported) framePacer->RecordPresent(now);
+			}
+
+			pendingPresents.pop_front();
+			finished = true;
+		}
+
+		return finished;
+	}
+
+	/* Read Present Timings -------------------------------------------------*/
+	/*
+		Hands the frame pacer what's known about finished presents: when
+		they reached the display, from display timing, and whatever present
+		wait has seen finish since the last look.
+	*/
+	void Renderer::ReadPresentTimings()
+	{
+		if (framePacer == nullptr) return;
+
+		WaitForPresent(0);
+
+		if (!displayTimingSupported) return;
+
+		uint32_t count = 0;
+		if (getPastPresentationTiming(device, swapChain.base, &count, nullptr) != VK_SUCCESS || count == 0) return;
+
+		std::vector<VkPastPresentationTimingGOOGLE> timings(count);
+		VkResult result = getPastPresentationTiming(device, swapChain.base, &count, timings.data());
+		if (result != VK_SUCCESS && result != VK_INCOMPLETE) return;
+
+		for (uint32_t i = 0; i < count; i++) framePacer->RecordPresent(timings[i].actualPresentTime);
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Frame Pacing Functions												 */
+	/*-----------------------------------------------------------------------*/
+	/* Set Frame Pacer ------------------------------------------------------*/
+	/*
+		Starts feeding the pacer present timings and, with present wait,
+		lets it wait on presents instead of sleeping. nullptr stops both.
+	*/
+	void Renderer::SetFramePacer(FramePacer* pacer)
+	{
+		if (framePacer != nullptr) framePacer->SetPresentWait(nullptr);
+
+		framePacer = pacer;
+		pendingPresents.clear();
+
+		if (framePacer != nullptr && presentWaitSupported)
+		{
+			framePacer->SetPresentWait([this](uint64_t timeoutNs) { return WaitForPresent(timeoutNs); });
+		}
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* On-Demand Functions													 */
+	/*-----------------------------------------------------------------------*/
+	/* Request Redraw -------------------------------------------------------*/
+	/*
+		Has the next Render() draw, for changes the renderer can't see
+		itself. Safe from any thread; it wakes WaitForEvents().
+	*/
+	void Renderer::RequestRedraw()
+	{
+		redrawRequested = true;
+		glfwPostEmptyEvent();
+	}
+
+	/* Needs Redraw ---------------------------------------------------------*/
+	/*
+		Whether the screen is out of date; always, unless rendering on
+		demand. Transparent geometry only lasts a frame, so a frame that
+		drew some needs another to clear it.
+	*/
+	bool Renderer::NeedsRedraw()
+	{
+		if (!onDemand || redrawRequested || windowResized ||
+			sceneRevision != drawnSceneRevision || cullVersion != drawnCullVersion || transparentVertexCount > 0)
+		{
+			return true;
+		}
+
+		for (int i = 0; i < views.size(); i++)
+		{
+			if (views[i].camera->GetViewProjection() != views[i].drawnViewProjection) return true;
+			if (!SameViewRect(views[i].camera, views[i].drawnViewport, views[i].drawnScissor)) return true;
+		}
+
+		return false;
+	}
+
+	/* Wait For Events ------------------------------------------------------*/
+	/*
+		Processes window events. When rendering on demand and nothing
+		needs drawing, it sleeps until an event arrives, RequestRedraw()
+		is called, or timeoutSeconds pass; otherwise it only polls.
+	*/
+	void Renderer::WaitForEvents(double timeoutSeconds)
+	{
+		if (!onDemand || NeedsRedraw() || timeoutSeconds <= 0.0) glfwPollEvents();
+		else glfwWaitEventsTimeout(timeoutSeconds);
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Dynamic Resolution													 */
+	/*-----------------------------------------------------------------------*/
+	/* Check Dynamic Resolution Support -------------------------------------*/
+	/*
+		Upscaling blits into the swap chain, so its images need to be
+		transfer destinations, and its format has to blit both ways with
+		linear filtering.
+	*/
+	bool Renderer::CheckDynamicResolutionSupport()
+	{
+		VkFormatProperties properties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, swapChain.format, &properties);
+
+		VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		if ((properties.optimalTilingFeatures & needed) != needed) return false;
+
+		SwapChainSupportDetails swapChainSupport = GetSwapChainSupportDetails(physicalDevice);
+		return (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0;
+	}
+
+	/* Update Render Scale --------------------------------------------------*/
+	/*
+		Folds the newest GPU frame time into the average, and rescales
+		towards the target. Cost goes with the area drawn, so the scale
+		moves by the square root of how far off the target the average
+		is. Small corrections are ignored so the scale doesn't wander
+		from frame to frame.
+	*/
+	void Renderer::UpdateRenderScale()
+	{
+		if (!dynamicResolution || !gpuTiming || gpuFrameSamples == scaledSamples) return;
+		scaledSamples = gpuFrameSamples;
+
+		if (gpuFrameAverageMs == 0.0) gpuFrameAverageMs = gpuFrameMs;
+		else gpuFrameAverageMs += (gpuFrameMs - gpuFrameAverageMs) * DYNAMIC_RESOLUTION_SMOOTHING;
+
+		if (gpuFrameAverageMs <= 0.0) return;
+
+		float wanted = renderScale * (float)sqrt(targetFrameMs / gpuFrameAverageMs);
+		wanted = std::min(std::max(wanted, minRenderScale), maxRenderScale);
+
+		if (fabs(wanted - renderScale) >= 0.05f || wanted == minRenderScale || wanted == maxRenderScale)
+		{
+			renderScale = wanted;
+		}
+	}
+
+	/* Get Render Extent ----------------------------------------------------*/
+	/*
+		The part of the scene target drawn to this frame; the swap chain's
+		extent without dynamic resolution.
+	*/
+	VkExtent2D Renderer::GetRenderExtent()
+	{
+		if (!dynamicResolution) return swapChain.extent;
+
+		return {	std::max(1u, (uint32_t)(swapChain.extent.width * renderScale + 0.5f)),
+					std::max(1u, (uint32_t)(swapChain.extent.height * renderScale + 0.5f)) };
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Damage Tracking														 */
+	/*-----------------------------------------------------------------------*/
+	/* Check Damage Tracking Support ----------------------------------------*/
+	/*
+		The scene target is copied (or, with dynamic resolution, blitted)
+		into the swap chain, so its images need to be transfer
+		destinations.
+	*/
+	bool Renderer::CheckDamageTrackingSupport()
+	{
+		SwapChainSupportDetails swapChainSupport = GetSwapChainSupportDetails(physicalDevice);
+		return (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0;
+	}
+
+	/* Add Damage -----------------------------------------------------------*/
+	/*
+		Marks a world-space box as changed, for changes the renderer can't
+		see itself. Vertex writes, hidden ranges and transparent geometry
+		are tracked already.
+	*/
+	void Renderer::AddDamage(glm::vec2 min, glm::vec2 max)
+	{
+		PushDamage({ min.x, min.y, max.x, max.y });
+		sceneRevision++;
+	}
+
+	/* Push Damage ----------------------------------------------------------*/
+	void Renderer::PushDamage(ViewBounds bounds)
+	{
+		if (!damageTracking || bounds.minX > bounds.maxX || bounds.minY > bounds.maxY) return;
+
+		if (damage.size() < DAMAGE_MAX_RECTS)
+		{
+			damage.push_back(bounds);
+			return;
+		}
+
+		ViewBounds& last = damage.back();
+		last.minX = std::min(last.minX, bounds.minX);
+		last.minY = std::min(last.minY, bounds.minY);
+		last.maxX = std::max(last.maxX, bounds.maxX);
+		last.maxY = std::max(last.maxY, bounds.maxY);
+	}
+
+	/* Damage Chunks --------------------------------------------------------*/
+	/*
+		Damages what the cull chunks firstChunk up to lastChunk cover. Vertex
+		writes call this both before and after rebuilding the chunks, for
+		where the geometry was and where it is now.
+	*/
+	void Renderer::DamageChunks(uint32_t firstChunk, uint32_t lastChunk)
+	{
+		if (damageTracking) PushDamage(culler->GetBounds(firstChunk, lastChunk));
+	}
+
+	/* Update Damage --------------------------------------------------------*/
+	/*
+		Works out this frame's damage from what has changed since the last
+		one, through every view. A camera or view moving, a view coming or
+		going, or a new extent or render scale changes every pixel, as does
+		anything without a box of its own; then damageRect is the whole
+		target and presentRects is empty, which presents the whole image.
+	*/
+	void Renderer::UpdateDamage()
+	{
+		if (!damageTracking) return;
+
+		PushDamage(transparentBounds);
+		PushDamage(drawnTransparentBounds);
+		drawnTransparentBounds = transparentBounds;
+		transparentBounds = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		VkExtent2D renderExtent = GetRenderExtent();
+
+		bool full = fullDamage || renderExtent.width != damagedExtent.width || renderExtent.height != damagedExtent.height;
+		for (int v = 0; v < views.size(); v++)
+		{
+			glm::mat4 viewProjection = views[v].camera->GetViewProjection();
+			if (viewProjection != views[v].damagedViewProjection) full = true;
+			views[v].damagedViewProjection = viewProjection;
+
+			/* A view that moved or changed size leaves stale pixels where it was. */
+			if (!SameViewRect(views[v].camera, views[v].damagedViewport, views[v].damagedScissor)) full = true;
+			views[v].damagedViewport = views[v].camera->GetViewport();
+			views[v].damagedScissor = views[v].camera->GetScissor();
+		}
+
+		fullDamage = false;
+		damagedExtent = renderExtent;
+		presentRects.clear();
+
+		if (full)
+		{
+			damage.clear();
+			damageRect = { { 0, 0 }, renderExtent };
+			return;
+		}
+
+		int32_t x0 = INT32_MAX, y0 = INT32_MAX, x1 = INT32_MIN, y1 = INT32_MIN;
+		for (int v = 0; v < views.size(); v++)
+		{
+			Camera* viewCamera = views[v].camera;
+			glm::mat4 viewProjection = viewCamera->GetViewProjection();
+
+			VkViewport viewport;
+			VkRect2D scissor;
+			GetSceneViewport(viewCamera, viewport, scissor);
+
+			for (int i = 0; i < damage.size(); i++)
+			{
+				VkRect2D rect = ProjectDamage(damage[i], viewProjection, viewport, scissor);
+				if (rect.extent.width == 0 || rect.extent.height == 0) continue;
+
+				x0 = std::min(x0, rect.offset.x);
+				y0 = std::min(y0, rect.offset.y);
+				x1 = std::max(x1, rect.offset.x + (int32_t)rect.extent.width);
+				y1 = std::max(y1, rect.offset.y + (int32_t)rect.extent.height);
+
+				/* Without dynamic resolution the scene target is the swap chain's size. */
+				if (dynamicResolution) rect = ProjectDamage(damage[i], viewProjection, viewCamera->GetViewport(), viewCamera->GetScissor());
+				presentRects.push_back({ rect.offset, rect.extent, 0 });
+			}
+		}
+
+		damage.clear();
+
+		if (x1 <= x0 || y1 <= y0)
+		{
+			/* Nothing changed; no rectangles would mean everything had, so name one pixel. */
+			damageRect = {};
+			presentRects.push_back({ { 0, 0 }, { 1, 1 }, 0 });
+			return;
+		}
+
+		damageRect = { { x0, y0 }, { (uint32_t)(x1 - x0), (uint32_t)(y1 - y0) } };
+	}
+
+	/* Project Damage -------------------------------------------------------*/
+	/*
+		The pixels a world-space box covers through the viewport, grown by
+		a pixel on each side for rasterisation and filtering, and clipped
+		to clip. Our projection is orthographic, so only x and y matter.
+	*/
+	VkRect2D Renderer::ProjectDamage(ViewBounds bounds, glm::mat4 viewProjection, VkViewport viewport, VkRect2D clip)
+	{
+		float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+		for (int i = 0; i < 4; i++)
+		{
+			glm::vec4 corner = viewProjection * glm::vec4((i & 1) ? bounds.maxX : bounds.minX, (i & 2) ? bounds.maxY : bounds.minY, 0.0f, 1.0f);
+			float x = viewport.x + (corner.x / corner.w * 0.5f + 0.5f) * viewport.width;
+			float y = viewport.y + (corner.y / corner.w * 0.5f + 0.5f) * viewport.height;
+
+			minX = std::min(minX, x);
+			minY = std::min(minY, y);
+			maxX = std::max(maxX, x);
+			maxY = std::max(maxY, y);
+		}
+
+		float clipX0 = (float)clip.offset.x;
+		float clipY0 = (float)clip.offset.y;
+		float clipX1 = (float)(clip.offset.x + (int32_t)clip.extent.width);
+		float clipY1 = (float)(clip.offset.y + (int32_t)clip.extent.height);
+
+		int32_t x0 = (int32_t)floor(std::max(minX - 1.0f, clipX0));
+		int32_t y0 = (int32_t)floor(std::max(minY - 1.0f, clipY0));
+		int32_t x1 = (int32_t)ceil(std::min(maxX + 1.0f, clipX1));
+		int32_t y1 = (int32_t)ceil(std::min(maxY + 1.0f, clipY1));
+		if (x1 <= x0 || y1 <= y0) return {};
+
+		return { { x0, y0 }, { (uint32_t)(x1 - x0), (uint32_t)(y1 - y0) } };
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Render Functions														 */
+	/*-----------------------------------------------------------------------*/
+	void Renderer::Render()
+	{
+		if (onDemand && !NeedsRedraw()) return;
+
+		PROFILE_SCOPE("Render");
+
+		/* What this frame shows, for NeedsRedraw() to compare against. */
+		redrawRequested = false;
+		drawnSceneRevision = sceneRevision;
+		drawnCullVersion = cullVersion;
+		for (int i = 0; i < views.size(); i++)
+		{
+			views[i].drawnViewProjection = views[i].camera->GetViewProjection();
+			views[i].drawnViewport = views[i].camera->GetViewport();
+			views[i].drawnScissor = views[i].camera->GetScissor();
+		}
+
+		{
+			PROFILE_SCOPE("WaitForFrame");
+			WaitForFrame(frame);
+		}
+
+		deletionQueue->Flush(GetCompletedFrameValue());
+		ReadTimestamps();
+		ReadPresentTimings();
+		UpdateRenderScale();
+		PollCullPipeline();
+
+		if (GetGpuCullingActive())
+		{
+			PROFILE_SCOPE("WriteCullChunks");
+			WriteCullChunks();
+		}
+
+		/*
+			The budget changes with what other applications are doing, so
+			we re-read it every so often rather than only at startup.
+		*/
+		if (budgetCountdown-- == 0)
+		{
+			PROFILE_SCOPE("UpdateBudget");
+			budgetCountdown = MEMORY_BUDGET_INTERVAL;
+			allocator->UpdateBudget();
+		}
+
+		uint32_t imageIndex;
+		VkResult result;
+		{
+			PROFILE_SCOPE("vkAcquireNextImageKHR");
+			result = vkAcquireNextImageKHR(device, swapChain.base, UINT64_MAX, imagesAvailable[frame], VK_NULL_HANDLE, &imageIndex);
+		}
+
+		/*
+			Nothing has been reset yet (without timeline semaphores, the
+			fence), so skipping the frame leaves the slot ready for the next
+			attempt. Transparent geometry is only ever for the frame it was
+			submitted for, so the skipped frame's is dropped with it.
+		*/
+		if (result == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			transparentVertices.clear();
+			transparentItems.clear();
+			transparentKeys.clear();
+
+			RecreateSwapChain();
+			redrawRequested = true;
+			return;
+		}
+
+		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+		{
+			throw std::runtime_error("Failed to acquire swap chain image.");
+		}
+
+		if (!timelineSupported) vkResetFences(device, 1, &inFlights[frame]);
+
+		{
+			PROFILE_SCOPE("Cull");
+			if (!GetGpuCullingActive()) culler->Cull(Culler::ComputeViewBounds(camera->GetViewProjection()));
+
+			for (int i = 1; i < views.size(); i++)
+			{
+				culler->Cull(Culler::ComputeViewBounds(views[i].camera->GetViewProjection()), views[i].drawRanges);
+			}
+		}
+
+		{
+			PROFILE_SCOPE("WriteTransparentVertices");
+			WriteTransparentVertices();
+		}
+
+		UpdateDamage();
+
+		vkResetCommandBuffer(commandBuffers[frame], 0);
+		{
+			PROFILE_SCOPE("RecordCommandBuffer");
+			RecordCommandBuffer(commandBuffers[frame], imageIndex);
+		}
+
+		{
+			PROFILE_SCOPE("WriteUniformBuffer");
+			WriteUniformBuffer(frame);
+		}
+
+		{
+			PROFILE_SCOPE("SubmitFrame");
+			SubmitFrame();
+		}
+
+		VkPresentInfoKHR presentInfo{};
+		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+
+		presentInfo.waitSemaphoreCount = 1;
+		presentInfo.pWaitSemaphores = &rendersFinished[frame];
+
+		VkSwapchainKHR swapchains[] = { swapChain.base };
+		presentInfo.swapchainCount = 1;
+		presentInfo.pSwapchains = swapchains;
+		presentInfo.pImageIndices = &imageIndex;
+		presentInfo.pResults = nullptr;
+
+		/*
+			Presents only carry IDs while a frame pacer is measuring them.
+			The chain is built back to front, so either struct can be
+			there alone.
+		*/
+		presentCount++;
+		uint64_t presentId = presentCount;
+
+		VkPresentTimeGOOGLE presentTime{};
+		presentTime.presentID = (uint32_t)presentId;
+		presentTime.desiredPresentTime = 0;
+
+		VkPresentTimesInfoGOOGLE presentTimesInfo{};
+		presentTimesInfo.sType = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE;
+		presentTimesInfo.swapchainCount = 1;
+		presentTimesInfo.pTimes = &presentTime;
+
+		VkPresentIdKHR presentIdInfo{};
+		presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+		presentIdInfo.swapchainCount = 1;
+		presentIdInfo.pPresentIds = &presentId;
+
+		/* With no rectangles the whole image is taken to have changed. */
+		VkPresentRegionKHR presentRegion{};
+		presentRegion.rectangleCount = presentRects.size();
+		presentRegion.pRectangles = presentRects.data();
+
+		VkPresentRegionsKHR presentRegions{};
+		presentRegions.sType = VK_STRUCTURE_TYPE_PRESENT_REGIONS_KHR;
+		presentRegions.swapchainCount = 1;
+		presentRegions.pRegions = &presentRegion;
+
+		const void* next = nullptr;
+		if (framePacer != nullptr)
+		{
+			if (displayTimingSupported) { presentTimesInfo.pNext = next; next = &presentTimesInfo; }
+			if (presentWaitSupported) { presentIdInfo.pNext = next; next = &presentIdInfo; }
+
+			if (presentWaitSupported) pendingPresents.push_back({ presentId, framePacer->GetFrameStart() });
+		}
+		if (incrementalPresentSupported && !presentRects.empty()) { presentRegions.pNext = next; next = &presentRegions; }
+		presentInfo.pNext = next;
+
+		{
+			PROFILE_SCOPE("vkQueuePresentKHR");
+			result = vkQueuePresentKHR(presentQueue, &presentInfo);
+		}
+
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || windowResized)
+		{
+			RecreateSwapChain();
+		}
+		else if (result != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to acquire swap chain image.");
+		}
+
+		frame = (frame + 1) % MAX_FRAMES_IN_FLIGHT;
+		uploadOffset = 0;
+		uploadBufferReady = false;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Buffer Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Write Vertex Buffer --------------------------------------------------*/
+	/*
+		Writes nVertices vertices starting at firstVertex; whatever was past
+		the end of the written range is no longer drawn. If the data doesn't
+		fit, the buffer grows first, keeping the vertices before firstVertex.
+		Uploads queued earlier for anything from firstVertex on are dropped,
+		so they can't land on top of these vertices next frame.
+
+		If the vertex buffer lives in memory the CPU can see, we write
+		straight into it wherever the frames in flight can't be reading.
+		The part they may still read goes through this frame's upload
+		buffer, and only if that is full do we wait for them.
+
+		Otherwise the vertices go through the staging buffer, and are copied
+		into the vertex buffer in the next frame's Upload pass.
+	*/
+	void Renderer::WriteVertexBuffer(Vertex* vertices, unsigned int nVertices, unsigned int firstVertex)
+	{
+		PROFILE_SCOPE("WriteVertexBuffer");
+
+		VkDeviceSize s = (VkDeviceSize)nVertices * sizeof(Vertex);
+		VkDeviceSize start = (VkDeviceSize)firstVertex * sizeof(Vertex);
+
+		if (start + s > vertexBufferSize) GrowVertexBuffer(start + s, start);
+		vertexCount = firstVertex + nVertices;
+		uploadedBytes += s;
+		ClipVertexCopies(pendingCopies, start, VK_WHOLE_SIZE);
+
+		{
+			PROFILE_SCOPE("BuildChunks");
+			uint32_t firstChunk = firstVertex / CULL_CHUNK_VERTICES;
+			DamageChunks(firstChunk, culler->GetChunkCount());
+			culler->BuildChunks(vertices, nVertices, firstVertex, true);
+			DamageChunks(firstChunk, culler->GetChunkCount());
+			cullVersion++;
+		}
+
+		if (directVertexWrites)
+		{
+			VkDeviceSize inFlight = GetVertexBytesInFlight();
+			VkDeviceSize queued = (inFlight > start) ? std::min(inFlight - start, s) : 0;
+
+			if (queued > 0 && !QueueUpload(vertices, queued, start))
+			{
+				WaitForAllFrames();
+				queued = 0;
+			}
+
+			memcpy((char*)vertexBufferAllocation.mapped + start + queued, (char*)vertices + queued, s - queued);
+			return;
+		}
+
+		StageVertexWrite(vertices, s, start);
+	}
+
+	/* Reserve Vertex Buffer ------------------------------------------------*/
+	/*
+		Makes room for (and starts drawing) nVertices vertices, for callers
+		that fill the buffer piecewise with QueueVertexUpload(). Vertices
+		that haven't been uploaded yet are never drawn, since the culler
+		has no bounds for them.
+	*/
+	void Renderer::ReserveVertexBuffer(unsigned int nVertices)
+	{
+		VkDeviceSize s = (VkDeviceSize)nVertices * sizeof(Vertex);
+		if (s > vertexBufferSize) GrowVertexBuffer(s, (VkDeviceSize)vertexCount * sizeof(Vertex));
+		vertexCount = std::max(vertexCount, nVertices);
+
+		uint32_t chunks = (nVertices + CULL_CHUNK_VERTICES - 1) / CULL_CHUNK_VERTICES;
+		if (chunks > culler->GetChunkCount())
+		{
+			culler->Resize(chunks);
+			cullVersion++;
+		}
+	}
+
+	/* Queue Vertex Upload --------------------------------------------------*/
+	/*
+		Writes nVertices vertices at firstVertex without waiting on the GPU
+		and without touching the rest of the buffer. The vertices are copied
+		into this frame's upload buffer now, and the copy into the vertex
+		buffer is recorded at the start of the next frame's command buffer.
+		With direct vertex writes, a range no frame in flight uses is
+		written in place instead and takes no upload space.
+
+		Returns false if this frame's upload buffer is full; the caller
+		should try again next frame.
+	*/
+	bool Renderer::QueueVertexUpload(Vertex* vertices, unsigned int nVertices, unsigned int firstVertex)
+	{
+		PROFILE_SCOPE("QueueVertexUpload");
+
+		VkDeviceSize s = (VkDeviceSize)nVertices * sizeof(Vertex);
+		VkDeviceSize start = (VkDeviceSize)firstVertex * sizeof(Vertex);
+		bool inPlace = directVertexWrites && start >= GetVertexBytesInFlight();
+		if (!inPlace && uploadOffset + s > UPLOAD_BUFFER_SIZE) return false;
+
+		if (start + s > vertexBufferSize) GrowVertexBuffer(start + s, (VkDeviceSize)vertexCount * sizeof(Vertex));
+		vertexCount = std::max(vertexCount, firstVertex + nVertices);
+
+		if (inPlace)
+		{
+			ClipVertexCopies(pendingCopies, start, start + s);
+			memcpy((char*)vertexBufferAllocation.mapped + start, vertices, s);
+		}
+		else
+		{
+			QueueUpload(vertices, s, start);
+		}
+
+		uploadedBytes += s;
+
+		{
+			PROFILE_SCOPE("BuildChunks");
+			uint32_t firstChunk = firstVertex / CULL_CHUNK_VERTICES;
+			uint32_t lastChunk = (firstVertex + nVertices + CULL_CHUNK_VERTICES - 1) / CULL_CHUNK_VERTICES;
+			DamageChunks(firstChunk, lastChunk);
+			culler->BuildChunks(vertices, nVertices, firstVertex, false);
+			DamageChunks(firstChunk, lastChunk);
+			cullVersion++;
+		}
+
+		return true;
+	}
+
+	/* Hide Vertex Range ----------------------------------------------------*/
+	/*
+		Stops drawing the cull chunks that lie wholly inside the range,
+		without touching the vertices. A later QueueVertexUpload() into the
+		range brings it back.
+	*/
+	void Renderer::HideVertexRange(unsigned int firstVertex, unsigned int nVertices)
+	{
+		uint32_t firstChunk = (firstVertex + CULL_CHUNK_VERTICES - 1) / CULL_CHUNK_VERTICES;
+		uint32_t lastChunk = std::min((firstVertex + nVertices) / CULL_CHUNK_VERTICES, culler->GetChunkCount());
+		DamageChunks(firstChunk, lastChunk);
+
+		for (uint32_t chunk = firstChunk; chunk < lastChunk; chunk++)
+		{
+			culler->SetChunk(chunk, { chunk * CULL_CHUNK_VERTICES, 0 }, glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max()));
+		}
+
+		cullVersion++;
+	}
+
+	/* Submit Transparent ---------------------------------------------------*/
+	/*
+		Queues vertices to be drawn blended in the next frame only; they
+		have to be submitted again every frame. Items are drawn after all
+		opaque geometry, lowest layer first, and within a layer from far
+		to near by the z of their first vertex.
+
+		The sort key packs the layer above the depth's bits, flipped so
+		that larger (farther) depths come first in an ascending sort.
+	*/
+	void Renderer::SubmitTransparent(const Vertex* vertices, unsigned int nVertices, uint16_t layer)
+	{
+		if (nVertices == 0) return;
+
+		uint32_t depthBits;
+		memcpy(&depthBits, &vertices[0].position.z, sizeof(uint32_t));
+
+		/* Float bits ordered like the floats they hold, negatives included. */
+		depthBits = (depthBits & 0x80000000u) ? ~depthBits : depthBits | 0x80000000u;
+
+		if (damageTracking)
+		{
+			for (unsigned int i = 0; i < nVertices; i++)
+			{
+				transparentBounds.minX = std::min(transparentBounds.minX, vertices[i].position.x);
+				transparentBounds.minY = std::min(transparentBounds.minY, vertices[i].position.y);
+				transparentBounds.maxX = std::max(transparentBounds.maxX, vertices[i].position.x);
+				transparentBounds.maxY = std::max(transparentBounds.maxY, vertices[i].position.y);
+			}
+		}
+
+		sceneRevision++;
+		transparentKeys.push_back(((uint64_t)layer << 32) | (uint32_t)~depthBits);
+		transparentItems.push_back({ (uint32_t)transparentVertices.size(), nVertices });
+		transparentVertices.insert(transparentVertices.end(), vertices, vertices + nVertices);
+	}
+
+	/* Write Transparent Vertices -------------------------------------------*/
+	/*
+		Sorts what was submitted this frame and copies it, in draw order,
+		into this frame's transparent buffer, growing it if needed. Must
+		be called after Render() has waited for this frame slot.
+	*/
+	void Renderer::WriteTransparentVertices()
+	{
+		transparentVertexCount = transparentVertices.size();
+		if (transparentVertexCount == 0) return;
+
+		transparentOrder.resize(transparentItems.size());
+		std::iota(transparentOrder.begin(), transparentOrder.end(), 0);
+		transparentSorter->Sort(transparentKeys, transparentOrder);
+
+		VkDeviceSize bytes = (VkDeviceSize)transparentVertexCount * sizeof(Vertex);
+		if (bytes > transparentBufferSizes[frame])
+		{
+			VkDeviceSize size = transparentBufferSizes[frame];
+			while (size < bytes) size *= 2;
+
+			DestroyBuffer(transparentBuffers[frame], transparentBuffersAllocation[frame]);
+			CreateBuffer(	size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+							VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0,
+							MEMORY_CATEGORY_VERTEX, transparentBuffers[frame], transparentBuffersAllocation[frame]);
+			transparentBufferSizes[frame] = size;
+		}
+
+		Vertex* destination = (Vertex*)transparentBuffersAllocation[frame].mapped;
+		for (int i = 0; i < transparentOrder.size(); i++)
+		{
+			const DrawRange& item = transparentItems[transparentOrder[i]];
+			memcpy(destination, &transparentVertices[item.firstVertex], item.vertexCount * sizeof(Vertex));
+			destination += item.vertexCount;
+		}
+
+		transparentVertices.clear();
+		transparentItems.clear();
+		transparentKeys.clear();
+	}
+
+	/* Write Cull Chunks ----------------------------------------------------*/
+	/*
+		Brings this frame's copy of the chunk boxes up to date with the
+		culler. Each frame in flight has its own copy, so this never has
+		to wait on the GPU, except when the chunks outgrow the buffers and
+		all of them are replaced. Must be called after Render() has waited
+		for this frame slot.
+	*/
+	void Renderer::WriteCullChunks()
+	{
+		if (cullChunkVersions[frame] == cullVersion) return;
+
+		uint32_t count = culler->GetChunkCount();
+		if (count > cullChunkCapacity)
+		{
+			WaitForAllFrames();
+
+			uint32_t capacity = cullChunkCapacity;
+			while (capacity < count) capacity *= 2;
+
+			DestroyCullBuffers();
+			CreateCullBuffers(capacity);
+			WriteDescriptorSets();
+		}
+
+		culler->WriteGpuChunks((GpuChunk*)cullChunkBuffersAllocation[frame].mapped);
+		cullChunkCounts[frame] = count;
+		cullChunkVersions[frame] = cullVersion;
+	}
+
+	/* Write Uniform Buffer -------------------------------------------------*/
+	/*
+		Uniform buffers (and their descriptor sets) are per frame in flight,
+		not per swapchain image, so this takes the frame index. Each view
+		gets its own slice.
+	*/
+	void Renderer::WriteUniformBuffer(uint32_t frameIndex)
+	{
+		for (int i = 0; i < views.size(); i++)
+		{
+			UniformBufferObject ubo = { views[i].camera->GetViewProjection(), { 0, 0 } };
+			memcpy((char*)uniformBuffersMapped[frameIndex] + i * uniformStride, &ubo, sizeof(ubo));
+		}
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Culling Functions													 */
+	/*-----------------------------------------------------------------------*/
+	/* Get Cull Stats -------------------------------------------------------*/
+	/*
+		GPU culling results are never read back, so in that mode only the
+		chunk count is known.
+	*/
+	CullStats Renderer::GetCullStats()
+	{
+		CullStats stats = culler->GetStats();
+		if (GetGpuCullingActive())
+		{
+			stats.visibleChunks = 0;
+			stats.drawCount = 0;
+			stats.kernel = "gpu";
+		}
+
+		return stats;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* View Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Add View -------------------------------------------------------------*/
+	/*
+		Draws the scene a second (or third...) time through viewCamera,
+		over the main view, inside the camera's own viewport and scissor.
+		Those are in window pixels and the caller's to set, and may be
+		changed between frames; unlike the main camera's, they're left
+		alone when the window is resized.
+	*/
+	void Renderer::AddView(Camera* viewCamera)
+	{
+		if (views.size() >= MAX_VIEWS) throw std::runtime_error("Too many views.");
+
+		views.push_back({ viewCamera, {}, glm::mat4(0), glm::mat4(0), {}, {}, {}, {} });
+		fullDamage = true;
+		RequestRedraw();
+	}
+
+	/* Remove View ----------------------------------------------------------*/
+	/*
+		The main view, the renderer's own camera, can't be removed.
+	*/
+	void Renderer::RemoveView(Camera* viewCamera)
+	{
+		for (int i = 1; i < views.size(); i++)
+		{
+			if (views[i].camera != viewCamera) continue;
+
+			views.erase(views.begin() + i);
+			fullDamage = true;
+			RequestRedraw();
+			return;
+		}
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Depth Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Set Depth Testing ----------------------------------------------------*/
+	/*
+		Switches between the depth-tested pipeline, with chunks drawn
+		nearest first, and the plain one, which draws in buffer order with
+		later vertices on top. Ignored without a depth buffer.
+	*/
+	void Renderer::SetDepthTesting(bool v)
+	{
+		depthTesting = v && depthFormat != VK_FORMAT_UNDEFINED;
+		culler->SetFrontToBack(depthTesting);
+		cullVersion++;
+		fullDamage = true;
 	}
 
 	/*-----------------------------------------------------------------------*/
-	/* Render Functions														 */
+	/* Memory Functions														 */
 	/*-----------------------------------------------------------------------*/
-	void Renderer::Render()
+	/* Get Memory Report ----------------------------------------------------*/
+	std::string Renderer::GetMemoryReport()
 	{
-		vkWaitForFences(device, 1, &inFlights[frame], VK_TRUE, UINT64_MAX);
+		const double mb = 1024.0 * 1024.0;
 
-		uint32_t imageIndex;
-		VkResult result = vkAcquireNextImageKHR(device, swapChain.base, UINT64_MAX, imagesAvailable[frame], VK_NULL_HANDLE, &imageIndex);
+		MemoryBudget budget = allocator->GetBudget();
+		AllocatorStats stats = allocator->GetStats();
 
-		/*if (result == VK_ERROR_OUT_OF_DATE_KHR || framebufferResized)
-		{
-			framebufferResized = false;
-			RepairSwapchain();
-			return;
-		}*/
+		std::ostringstream o;
+		o << std::fixed << std::setprecision(1);
+		o << "Memory budget (" << (budget.fromDriver ? "VK_EXT_memory_budget" : "estimated") << "):" << std::endl;
 
-		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+		VkPhysicalDeviceMemoryProperties memProperties;
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+
+		for (int i = 0; i < budget.heapCount; i++)
 		{
-			throw std::runtime_error("Failed to acquire swap chain image.");
+			HeapBudget& heap = budget.heaps[i];
+			bool deviceLocal = memProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+			o << "  Heap " << i << (deviceLocal ? " (device local)" : " (host)")
+			  << ": " << heap.usage / mb << " / " << heap.budget / mb << " MB used"
+			  << ", " << heap.allocatorBytes / mb << " MB ours"
+			  << ", " << heap.size / mb << " MB total" << std::endl;
 		}
 
-		vkResetFences(device, 1, &inFlights[frame]);
-
-		vkResetCommandBuffer(commandBuffers[frame], 0);
-		RecordCommandBuffer(commandBuffers[frame], imageIndex);
+		o << "Memory by category:" << std::endl;
+		for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++)
+		{
+			o << "  " << MemoryCategoryName((MemoryCategory)i) << ": " << stats.categoryBytes[i] / mb << " MB in "
+			  << stats.categoryAllocations[i] << " allocations" << std::endl;
+		}
 
-		WriteUniformBuffer(imageIndex);
+		o << "Blocks: " << stats.deviceMemoryCount << " / " << stats.deviceMemoryLimit
+		  << ", pressure events: " << stats.pressureEvents
+		  << ", budget overruns: " << stats.budgetOverruns
+		  << ", vertex uploads: " << (directVertexWrites ? "direct" : "staged")
+		  << ", staging: " << stagingBufferSize / mb << " MB" << std::endl;
 
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		return o.str();
+	}
 
-		VkSemaphore waitSemaphores[] = { imagesAvailable[frame] };
-		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-		submitInfo.waitSemaphoreCount = 1;
-		submitInfo.pWaitSemaphores = waitSemaphores;
-		submitInfo.pWaitDstStageMask = waitStages;
+	/* Defragment Memory ----------------------------------------------------*/
+	/*
+		DefragmentMemory() lets the allocator compact our buffers into as few
+		blocks as possible. Every moved buffer is recreated on its new range
+		and its contents copied across. This waits for the device to go
+		idle, so it is meant for loading screens and the like, not for
+		calling every frame. Pending vertex copies name the buffers being
+		moved, so they are flushed first.
+	*/
+	VkDeviceSize Renderer::DefragmentMemory()
+	{
+		struct MovableBuffer
+		{
+			Allocation*			allocation;
+			VkBuffer*			buffer;
+			VkBufferUsageFlags	usage;
+			VkDeviceSize		size;
+		};
 
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffers[frame];
+		std::vector<MovableBuffer> movable =
+		{
+			{ &vertexBufferAllocation, &vertexBuffer, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertexBufferSize }
+		};
 
-		VkSemaphore signalSemaphores[] = { rendersFinished[frame] };
-		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = signalSemaphores;
+		if (stagingBuffer != VK_NULL_HANDLE)
+		{
+			movable.push_back({ &stagingBufferAllocation, &stagingBuffer, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, stagingBufferSize });
+		}
 
-		if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlights[frame]) != VK_SUCCESS)
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
 		{
-			throw std::runtime_error("failed to submit draw command buffer!");
+			movable.push_back({ &uniformBuffersAllocation[i], &uniformBuffers[i], VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, uniformStride * MAX_VIEWS });
 		}
 
-		VkPresentInfoKHR presentInfo{};
-		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+		std::vector<Allocation*> allocations;
+		for (int i = 0; i < movable.size(); i++) allocations.push_back(movable[i].allocation);
 
-		presentInfo.waitSemaphoreCount = 1;
-		presentInfo.pWaitSemaphores = signalSemaphores;
+		FlushVertexCopies();
+		vkDeviceWaitIdle(device);
 
-		VkSwapchainKHR swapchains[] = { swapChain.base };
-		presentInfo.swapchainCount = 1;
-		presentInfo.pSwapchains = swapchains;
-		presentInfo.pImageIndices = &imageIndex;
-		presentInfo.pResults = nullptr;
+		VkDeviceSize moved = allocator->Defragment(allocations, [&](const Allocation& from, const Allocation& to)
+		{
+			for (int i = 0; i < movable.size(); i++)
+			{
+				if (movable[i].allocation->block != from.block || movable[i].allocation->node != from.node) continue;
 
-		result = vkQueuePresentKHR(presentQueue, &presentInfo);
+				VkBufferCreateInfo bufferInfo{};
+				bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+				bufferInfo.size = movable[i].size;
+				bufferInfo.usage = movable[i].usage;
+				bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
-		{
-			// RepairSwapchain();
-		}
-		else if (result != VK_SUCCESS)
-		{
-			throw std::runtime_error("Failed to acquire swap chain image.");
-		}
+				VkBuffer newBuffer;
+				if (vkCreateBuffer(device, &bufferInfo, nullptr, &newBuffer) != VK_SUCCESS)
+				{
+					throw std::runtime_error("Failed to create buffer.");
+				}
 
-		frame = (frame + 1) % MAX_FRAMES_IN_FLIGHT;
-	}
+				vkBindBufferMemory(device, newBuffer, to.memory, to.offset);
 
-	/*-----------------------------------------------------------------------*/
-	/* Buffer Functions														 */
-	/*-----------------------------------------------------------------------*/
-	/* Write Vertex Buffer --------------------------------------------------*/
-	void Renderer::WriteVertexBuffer(Vertex* vertices, unsigned int nVertices)
-	{
-		unsigned int s = nVertices * sizeof(Vertex);
-		void* data;
+				if (from.mapped != nullptr && to.mapped != nullptr) memcpy(to.mapped, from.mapped, movable[i].size);
+				else CopyBuffer(*movable[i].buffer, newBuffer, movable[i].size, 0, 0);
 
-		vkMapMemory(device, stagingBufferMemory, 0, VK_WHOLE_SIZE, 0, &data);
-		memcpy(data, vertices, s);
-		vkUnmapMemory(device, stagingBufferMemory);
+				vkDestroyBuffer(device, *movable[i].buffer, nullptr);
+				*movable[i].buffer = newBuffer;
+				return;
+			}
+		});
 
-		CopyBuffer(stagingBuffer, vertexBuffer, s);
-	}
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) uniformBuffersMapped[i] = uniformBuffersAllocation[i].mapped;
+		WriteDescriptorSets();
 
-	/* Write Uniform Buffer -------------------------------------------------*/
-	void Renderer::WriteUniformBuffer(uint32_t imageIndex)
-	{
-		UniformBufferObject ubo = { camera->GetViewProjection(), { 0, 0 } };
-		memcpy(uniformBuffersMapped[imageIndex], &ubo, sizeof(ubo));
+		return moved;
 	}
 
 	/*-----------------------------------------------------------------------*/
@@ -208,10 +1638,38 @@ namespace VkExample
 		const char** glfwExtensions;
 		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 		std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
-		if (ENABLE_VALIDATION_LAYERS) extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+		if (validationEnabled) extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 		return extensions;
 	}
 
+	/* Check Instance Extension Support -------------------------------------*/
+	bool Renderer::CheckInstanceExtensionSupport(std::vector<const char*> instanceExtensions)
+	{
+		uint32_t extensionCount;
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+
+		for (int i = 0; i < instanceExtensions.size(); i++)
+		{
+			bool extensionFound = false;
+
+			for (int j = 0; j < availableExtensions.size(); j++)
+			{
+				if (strcmp(instanceExtensions[i], availableExtensions[j].extensionName) == 0)
+				{
+					extensionFound = true;
+					break;
+				}
+			}
+
+			if (!extensionFound) return false;
+		}
+
+		return true;
+	}
+
 	/* Create Instance ------------------------------------------------------*/
 	void Renderer::CreateInstance(	std::string name,
 									std::vector<const char*> validationLayers,
@@ -227,7 +1685,18 @@ namespace VkExample
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "Untitled Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+
+		/*
+			We ask for the newest Vulkan we make use of (1.3, for dynamic
+			rendering) that the loader knows. A 1.0 loader doesn't have
+			vkEnumerateInstanceVersion, and fails anything newer than 1.0.
+		*/
+		apiVersion = VK_API_VERSION_1_0;
+		PFN_vkEnumerateInstanceVersion enumerateInstanceVersion = (PFN_vkEnumerateInstanceVersion)vkGetInstanceProcAddr(VK_NULL_HANDLE, "vkEnumerateInstanceVersion");
+		if (enumerateInstanceVersion != nullptr) enumerateInstanceVersion(&apiVersion);
+
+		apiVersion = std::min(VK_MAKE_API_VERSION(0, VK_API_VERSION_MAJOR(apiVersion), VK_API_VERSION_MINOR(apiVersion), 0), VK_API_VERSION_1_3);
+		appInfo.apiVersion = apiVersion;
 
 		/*
 			Next, we pass some more information about the instance we would like
@@ -245,7 +1714,7 @@ namespace VkExample
 		for (int i = 0; i < glfwExtensions.size(); i++) instanceExtensions.push_back(glfwExtensions[i]);
 		createInfo.enabledExtensionCount = instanceExtensions.size();
 		createInfo.ppEnabledExtensionNames = instanceExtensions.data();
-		if (ENABLE_VALIDATION_LAYERS)
+		if (validationEnabled)
 		{
 			createInfo.enabledLayerCount = validationLayers.size();
 			createInfo.ppEnabledLayerNames = validationLayers.data();
@@ -357,32 +1826,173 @@ namespace VkExample
 	}
 
 	/* Check Physical Device Suitability ------------------------------------*/
+	/*
+		Whether the renderer can run on the device at all. When it can't,
+		reason says why.
+	*/
 	bool Renderer::CheckPhysicalDeviceSuitability(	VkPhysicalDevice potentiate,
-													std::vector<const char*> deviceExtensions)
+													std::vector<const char*> deviceExtensions,
+													std::string& reason)
 	{
 		QueueFamilyIndices indices = FindQueueFamilies(potentiate);
-		if (!CheckDeviceExtensionSupport(potentiate, deviceExtensions)) return false;
-		SwapChainSupportDetails swapChainSupport = GetSwapChainSupportDetails(potentiate);
-		if (swapChainSupport.formats.empty() || swapChainSupport.presentModes.empty()) return false;
-		return (indices.IsComplete());
+		if (!indices.graphicsFamily.has_value()) reason = "no graphics queue";
+		else if (!indices.presentFamily.has_value()) reason = "can't present to the window";
+		else if (!CheckDeviceExtensionSupport(potentiate, deviceExtensions)) reason = "missing a required extension";
+		else
+		{
+			SwapChainSupportDetails swapChainSupport = GetSwapChainSupportDetails(potentiate);
+			if (swapChainSupport.formats.empty() || swapChainSupport.presentModes.empty()) reason = "no swap chain formats or present modes";
+		}
+
+		return reason.empty();
 	}
 
 	/* Rate Physical Device -------------------------------------------------*/
-	int Renderer::RatePhysicalDevice(VkPhysicalDevice potentiate)
+	/*
+		Scores a suitable device on what the renderer makes use of: the
+		kind of device first, then the size of its device-local memory,
+		presenting from the graphics queue (no shared swap chain images),
+		a transfer-only queue, and the features that let GPU culling draw
+		in one call. reasons lists what the score was made of.
+
+		Software devices score 1 whatever they support, below any GPU, so
+		they're only picked when nothing else is suitable (or by name).
+	*/
+	int Renderer::RatePhysicalDevice(VkPhysicalDevice potentiate, std::string& reasons)
 	{
 		VkPhysicalDeviceProperties deviceProperties;
 		VkPhysicalDeviceFeatures deviceFeatures;
+		VkPhysicalDeviceMemoryProperties memoryProperties;
 		vkGetPhysicalDeviceProperties(potentiate, &deviceProperties);
 		vkGetPhysicalDeviceFeatures(potentiate, &deviceFeatures);
-		if (!deviceFeatures.geometryShader) return 0;
+		vkGetPhysicalDeviceMemoryProperties(potentiate, &memoryProperties);
+
+		std::ostringstream log;
 		int score = 0;
-		if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) score += 1000;
-		score += deviceProperties.limits.maxImageDimension2D;
+
+		/* Device Type --------------------------------------------------*/
+		switch (deviceProperties.deviceType)
+		{
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:	score += 10000; log << "discrete"; break;
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:	score += 5000; log << "integrated"; break;
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:	score += 2000; log << "virtual"; break;
+		case VK_PHYSICAL_DEVICE_TYPE_CPU:			reasons = "software device"; return 1;
+		default:									score += 1000; log << "other"; break;
+		}
+
+		/* Memory -------------------------------------------------------*/
+		VkDeviceSize deviceLocal = 0;
+		for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+		{
+			if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			{
+				deviceLocal = std::max(deviceLocal, memoryProperties.memoryHeaps[i].size);
+			}
+		}
+
+		int deviceLocalMB = (int)(deviceLocal / (1024 * 1024));
+		score += std::min(deviceLocalMB / 16, 2000);
+		log << ", " << deviceLocalMB << " MB device-local";
+
+		/* Queues -------------------------------------------------------*/
+		QueueFamilyIndices indices = FindQueueFamilies(potentiate);
+		if (indices.graphicsFamily == indices.presentFamily)
+		{
+			score += 500;
+			log << ", presents from graphics queue";
+		}
+
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(potentiate, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(potentiate, &queueFamilyCount, queueFamilies.data());
+
+		for (int i = 0; i < queueFamilies.size(); i++)
+		{
+			VkQueueFlags flags = queueFamilies[i].queueFlags;
+			if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+			{
+				score += 100;
+				log << ", transfer queue";
+				break;
+			}
+		}
+
+		/* Features -----------------------------------------------------*/
+		if (deviceFeatures.multiDrawIndirect)
+		{
+			score += 200;
+			log << ", multiDrawIndirect";
+		}
+
+		if (CheckDeviceExtensionSupport(potentiate, { VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME }))
+		{
+			score += 100;
+			log << ", drawIndirectCount";
+		}
+
+		reasons = log.str();
 		return score;
 	}
 
+	/* Get Device UUID ------------------------------------------------------*/
+	/*
+		The device's UUID as 32 hex digits, or empty when the instance
+		can't tell us (it takes vkGetPhysicalDeviceProperties2).
+	*/
+	std::string Renderer::GetDeviceUUID(VkPhysicalDevice potentiate, PFN_vkGetPhysicalDeviceProperties2 getProperties2)
+	{
+		if (getProperties2 == nullptr) return "";
+
+		VkPhysicalDeviceIDProperties idProperties{};
+		idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+		VkPhysicalDeviceProperties2 properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties.pNext = &idProperties;
+		getProperties2(potentiate, &properties);
+
+		std::ostringstream uuid;
+		uuid << std::hex << std::setfill('0');
+		for (int i = 0; i < VK_UUID_SIZE; i++) uuid << std::setw(2) << (int)idProperties.deviceUUID[i];
+		return uuid.str();
+	}
+
+	/* Match Device Override ------------------------------------------------*/
+	/*
+		Whether deviceOverride names the device: its UUID (dashes
+		allowed), or any part of its name. Neither is case-sensitive.
+	*/
+	bool Renderer::MatchDeviceOverride(VkPhysicalDevice potentiate, std::string uuid, std::string deviceOverride)
+	{
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(potentiate, &deviceProperties);
+
+		std::string name = deviceProperties.deviceName;
+		std::string wanted;
+		std::string wantedHex;
+		for (int i = 0; i < deviceOverride.size(); i++)
+		{
+			char c = (char)tolower((unsigned char)deviceOverride[i]);
+			wanted += c;
+			if (c != '-') wantedHex += c;
+		}
+
+		for (int i = 0; i < name.size(); i++) name[i] = (char)tolower((unsigned char)name[i]);
+
+		if (!uuid.empty() && wantedHex == uuid) return true;
+		return name.find(wanted) != std::string::npos;
+	}
+
 	/* Get Physical Device --------------------------------------------------*/
-	void Renderer::GetPhysicalDevice(std::vector<const char*> deviceExtensions)
+	/*
+		Picks the highest-scoring suitable device, or, given an override,
+		the first suitable device it names. DEVICE_OVERRIDE_ENV takes the
+		place of deviceOverride when it's set, so runs on a machine with
+		several GPUs can each be pinned to one.
+	*/
+	void Renderer::GetPhysicalDevice(	std::vector<const char*> deviceExtensions, bool properties2Supported,
+										std::string deviceOverride)
 	{
 		uint32_t deviceCount = 0;
 		vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
@@ -394,29 +2004,72 @@ namespace VkExample
 		std::vector<VkPhysicalDevice> devices(deviceCount);
 		vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
 
-		int highestScore = 0;
+		const char* environmentOverride = getenv(DEVICE_OVERRIDE_ENV);
+		if (environmentOverride != nullptr && environmentOverride[0] != '\0') deviceOverride = environmentOverride;
+
+		PFN_vkGetPhysicalDeviceProperties2 getProperties2 = (PFN_vkGetPhysicalDeviceProperties2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2");
+		if (getProperties2 == nullptr && properties2Supported)
+		{
+			getProperties2 = (PFN_vkGetPhysicalDeviceProperties2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2KHR");
+		}
+
+		int highestScore = -1;
 		VkPhysicalDevice bestDevice = VK_NULL_HANDLE;
 
 		for (int i = 0; i < devices.size(); i++)
 		{
 			VkPhysicalDevice potentiate = devices[i];
-			if (CheckPhysicalDeviceSuitability(potentiate, deviceExtensions))
+
+			VkPhysicalDeviceProperties deviceProperties;
+			vkGetPhysicalDeviceProperties(potentiate, &deviceProperties);
+			std::string uuid = GetDeviceUUID(potentiate, getProperties2);
+
+			std::string reasons;
+			int score = -1;
+			if (CheckPhysicalDeviceSuitability(potentiate, deviceExtensions, reasons))
 			{
-				int score = RatePhysicalDevice(potentiate);
+				score = RatePhysicalDevice(potentiate, reasons);
 
-				if (score > highestScore)
+				/* An override takes the first device it names, whatever it scores. */
+				if (!deviceOverride.empty())
+				{
+					bool named = MatchDeviceOverride(potentiate, uuid, deviceOverride);
+					if (named && bestDevice == VK_NULL_HANDLE) bestDevice = potentiate;
+					if (!named) reasons += " (not " + deviceOverride + ")";
+				}
+				else if (score > highestScore && score > 0)
 				{
 					bestDevice = potentiate;
 					highestScore = score;
 				}
 			}
+
+			if (LOG_DEVICE_SELECTION)
+			{
+				std::cout << "Device " << i << ": " << deviceProperties.deviceName;
+				if (!uuid.empty()) std::cout << " [" << uuid << "]";
+				if (score >= 0) std::cout << ", score " << score;
+				else std::cout << ", unsuitable";
+				std::cout << " (" << reasons << ")" << std::endl;
+			}
 		}
 
 		// If the device is still null, that means we found no suitable GPU.
-		if (bestDevice == VK_NULL_HANDLE) throw std::runtime_error("Unable to find suitable GPU.");
+		if (bestDevice == VK_NULL_HANDLE)
+		{
+			if (!deviceOverride.empty()) throw std::runtime_error("No suitable GPU matches \"" + deviceOverride + "\".");
+			throw std::runtime_error("Unable to find suitable GPU.");
+		}
 
 		physicalDevice = bestDevice;
 		indices = FindQueueFamilies(physicalDevice);
+
+		if (LOG_DEVICE_SELECTION)
+		{
+			VkPhysicalDeviceProperties deviceProperties;
+			vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+			std::cout << "Using " << deviceProperties.deviceName << "." << std::endl;
+		}
 	}
 
 	/* Create Device --------------------------------------------------------*/
@@ -439,10 +2092,45 @@ namespace VkExample
 		}
 
 		VkPhysicalDeviceFeatures deviceFeatures{};
-		deviceFeatures.logicOp = VK_TRUE;
+		deviceFeatures.multiDrawIndirect = multiDrawIndirectSupported ? VK_TRUE : VK_FALSE;
+
+		/*
+			The optional features are turned on with the same structs
+			whether they are core or extensions.
+		*/
+		VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+		dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+		dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+
+		VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+		timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+		timelineFeatures.timelineSemaphore = VK_TRUE;
+
+		VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{};
+		synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+		synchronization2Features.synchronization2 = VK_TRUE;
+
+		VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+		presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+		presentIdFeatures.presentId = VK_TRUE;
+
+		VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+		presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+		presentWaitFeatures.presentWait = VK_TRUE;
 
 		VkDeviceCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+
+		const void** next = &createInfo.pNext;
+		if (dynamicRenderingSupported) { *next = &dynamicRenderingFeatures; next = (const void**)&dynamicRenderingFeatures.pNext; }
+		if (timelineSupported) { *next = &timelineFeatures; next = (const void**)&timelineFeatures.pNext; }
+		if (synchronization2Supported) { *next = &synchronization2Features; next = (const void**)&synchronization2Features.pNext; }
+		if (presentWaitSupported)
+		{
+			*next = &presentIdFeatures; next = (const void**)&presentIdFeatures.pNext;
+			*next = &presentWaitFeatures; next = (const void**)&presentWaitFeatures.pNext;
+		}
+
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 		createInfo.queueCreateInfoCount = queueCreateInfos.size();
 		createInfo.pEnabledFeatures = &deviceFeatures;
@@ -450,7 +2138,7 @@ namespace VkExample
 		createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 		createInfo.enabledLayerCount = 0;
 
-		if (ENABLE_VALIDATION_LAYERS)
+		if (validationEnabled)
 		{
 			createInfo.enabledLayerCount = validationLayers.size();
 			createInfo.ppEnabledLayerNames = validationLayers.data();
@@ -465,6 +2153,122 @@ namespace VkExample
 		device = logicalDevice;
 	}
 
+	/* Check Optional Features ----------------------------------------------*/
+	/*
+		Works out which newer features the device gives us: dynamic
+		rendering and synchronization2 (core in 1.3) and timeline
+		semaphores (core in 1.2). Before they were core each is an
+		extension, and dynamic rendering also needs
+		VK_KHR_depth_stencil_resolve and VK_KHR_create_renderpass2 on a 1.1
+		device. Either way the device has to report the feature, which
+		takes vkGetPhysicalDeviceFeatures2.
+	*/
+	void Renderer::CheckOptionalFeatures(bool properties2Supported, std::vector<const char*>& deviceExtensions)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		deviceApiVersion = std::min(apiVersion, properties.apiVersion);
+
+		dynamicRenderingSupported = false;
+		timelineSupported = false;
+		synchronization2Supported = false;
+		presentWaitSupported = false;
+		displayTimingSupported = false;
+		incrementalPresentSupported = false;
+
+		PFN_vkGetPhysicalDeviceFeatures2 getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2");
+		if (getFeatures2 == nullptr && properties2Supported)
+		{
+			getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR");
+		}
+		if (getFeatures2 == nullptr) return;
+
+		/* Availability -------------------------------------------------*/
+		bool dynamicRenderingCore = deviceApiVersion >= VK_API_VERSION_1_3;
+		std::vector<const char*> dynamicRenderingExtensions = { VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME };
+		if (deviceApiVersion < VK_API_VERSION_1_2)
+		{
+			dynamicRenderingExtensions.push_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+			dynamicRenderingExtensions.push_back(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+		}
+
+		bool dynamicRenderingAvailable = ENABLE_DYNAMIC_RENDERING && (dynamicRenderingCore ||
+			(deviceApiVersion >= VK_API_VERSION_1_1 && CheckDeviceExtensionSupport(physicalDevice, dynamicRenderingExtensions)));
+
+		bool timelineCore = deviceApiVersion >= VK_API_VERSION_1_2;
+		bool timelineAvailable = ENABLE_TIMELINE_SEMAPHORES && (timelineCore ||
+			CheckDeviceExtensionSupport(physicalDevice, { VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME }));
+
+		bool synchronization2Core = deviceApiVersion >= VK_API_VERSION_1_3;
+		bool synchronization2Available = ENABLE_SYNCHRONIZATION_2 && (synchronization2Core ||
+			CheckDeviceExtensionSupport(physicalDevice, { VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME }));
+
+		std::vector<const char*> presentWaitExtensions = { VK_KHR_PRESENT_ID_EXTENSION_NAME, VK_KHR_PRESENT_WAIT_EXTENSION_NAME };
+		bool presentWaitAvailable = ENABLE_PRESENT_TIMING && CheckDeviceExtensionSupport(physicalDevice, presentWaitExtensions);
+
+		/* Display timing is only an extension; it has no feature to ask for. */
+		displayTimingSupported = ENABLE_PRESENT_TIMING && CheckDeviceExtensionSupport(physicalDevice, { VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME });
+		if (displayTimingSupported) deviceExtensions.push_back(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+
+		/* Incremental present has no feature either; it's only any use with damage tracking. */
+		incrementalPresentSupported = damageTracking && CheckDeviceExtensionSupport(physicalDevice, { VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME });
+		if (incrementalPresentSupported) deviceExtensions.push_back(VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME);
+
+		/* Query --------------------------------------------------------*/
+		/*
+			Only the structs of features the device could have go in the
+			chain.
+		*/
+		VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+		dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+
+		VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+		timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+
+		VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{};
+		synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+
+		VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+		presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+
+		VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+		presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+		VkPhysicalDeviceFeatures2 features{};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+
+		void** next = &features.pNext;
+		if (dynamicRenderingAvailable) { *next = &dynamicRenderingFeatures; next = &dynamicRenderingFeatures.pNext; }
+		if (timelineAvailable) { *next = &timelineFeatures; next = &timelineFeatures.pNext; }
+		if (synchronization2Available) { *next = &synchronization2Features; next = &synchronization2Features.pNext; }
+		if (presentWaitAvailable)
+		{
+			*next = &presentIdFeatures; next = &presentIdFeatures.pNext;
+			*next = &presentWaitFeatures; next = &presentWaitFeatures.pNext;
+		}
+
+		getFeatures2(physicalDevice, &features);
+
+		/* Enable -------------------------------------------------------*/
+		dynamicRenderingSupported = dynamicRenderingAvailable && dynamicRenderingFeatures.dynamicRendering;
+		if (dynamicRenderingSupported && !dynamicRenderingCore)
+		{
+			for (int i = 0; i < dynamicRenderingExtensions.size(); i++) deviceExtensions.push_back(dynamicRenderingExtensions[i]);
+		}
+
+		timelineSupported = timelineAvailable && timelineFeatures.timelineSemaphore;
+		if (timelineSupported && !timelineCore) deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+
+		synchronization2Supported = synchronization2Available && synchronization2Features.synchronization2;
+		if (synchronization2Supported && !synchronization2Core) deviceExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+
+		presentWaitSupported = presentWaitAvailable && presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+		if (presentWaitSupported)
+		{
+			for (int i = 0; i < presentWaitExtensions.size(); i++) deviceExtensions.push_back(presentWaitExtensions[i]);
+		}
+	}
+
 	/* Get Graphics Queue ---------------------------------------------------*/
 	void Renderer::GetGraphicsQueue()
 	{
@@ -521,7 +2325,11 @@ namespace VkExample
 	}
 
 	/* Create SwapChain -----------------------------------------------------*/
-	void Renderer::CreateSwapChain()
+	/*
+		Passing the swap chain being replaced lets the driver hand its
+		resources over; the old one is still ours to destroy.
+	*/
+	void Renderer::CreateSwapChain(VkSwapchainKHR oldSwapChain)
 	{
 		SwapChainSupportDetails swapChainSupport = GetSwapChainSupportDetails(physicalDevice);
 		VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(swapChainSupport.formats);
@@ -543,6 +2351,7 @@ namespace VkExample
 		createInfo.imageExtent = extent;
 		createInfo.imageArrayLayers = 1;
 		createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		if (dynamicResolution || damageTracking) createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 		createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
 		uint32_t queueFamilyIndices[] = { indices.graphicsFamily.value(), indices.presentFamily.value() };
@@ -559,7 +2368,7 @@ namespace VkExample
 		createInfo.presentMode = presentMode;
 		createInfo.clipped = VK_TRUE;
 
-		createInfo.oldSwapchain = VK_NULL_HANDLE;
+		createInfo.oldSwapchain = oldSwapChain;
 
 		VkSwapchainKHR swapchainKHR;
 
@@ -601,82 +2410,182 @@ namespace VkExample
 		}
 	}
 
+	/* Destroy SwapChain ----------------------------------------------------*/
+	/*
+		Destroys the swap chain and its image views. What the render graph
+		sized to it is replaced by its next Resize().
+	*/
+	void Renderer::DestroySwapChain()
+	{
+		for (int i = 0; i < swapChain.imageViews.size(); i++) vkDestroyImageView(device, swapChain.imageViews[i], nullptr);
+		vkDestroySwapchainKHR(device, swapChain.base, nullptr);
+	}
+
+	/* Recreate SwapChain ---------------------------------------------------*/
+	/*
+		Called when the window is resized or the swap chain goes out of
+		date. While the window is minimised there is nothing to render to,
+		so we wait for it to come back.
+
+		Frames in flight may still be drawing to the old swap chain and
+		the render graph's old images, so those go on the deletion queue
+		and the device is never idled.
+	*/
+	void Renderer::RecreateSwapChain()
+	{
+		int width = 0, height = 0;
+		glfwGetFramebufferSize(window, &width, &height);
+		while (width == 0 || height == 0)
+		{
+			glfwWaitEvents();
+			glfwGetFramebufferSize(window, &width, &height);
+		}
+
+		SwapChain old = swapChain;
+		CreateSwapChain(old.base);
+
+		/* Presents to the old swap chain can't be waited on through the new one. */
+		pendingPresents.clear();
+
+		for (int i = 0; i < old.imageViews.size(); i++) deletionQueue->PushImageView(old.imageViews[i]);
+		deletionQueue->PushSwapChain(old.base);
+
+		renderGraph->SetImages(swapChainTarget, swapChain.images, swapChain.imageViews);
+		renderGraph->Resize(swapChain.extent);
+		fullDamage = true;
+
+		camera->SetViewportWidth((float)swapChain.extent.width);
+		camera->SetViewportHeight((float)swapChain.extent.height);
+		camera->SetScissorExtent(swapChain.extent);
+
+		windowResized = false;
+	}
+
 	/*-----------------------------------------------------------------------*/
-	/* Framebuffer Setup													 */
+	/* Depth Setup															 */
 	/*-----------------------------------------------------------------------*/
-	void Renderer::SetupFramebuffers()
+	/* Choose Depth Format --------------------------------------------------*/
+	/*
+		The most precise depth format the device can render to, or
+		VK_FORMAT_UNDEFINED if depth is turned off or none is supported.
+	*/
+	VkFormat Renderer::ChooseDepthFormat()
 	{
-		framebuffers.resize(swapChain.imageViews.size());
+		if (!ENABLE_DEPTH_BUFFER) return VK_FORMAT_UNDEFINED;
 
-		for (int i = 0; i < swapChain.imageViews.size(); i++)
-		{
-			VkImageView attachments[] = { swapChain.imageViews[i] };
+		VkFormat candidates[] = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT };
 
-			VkFramebufferCreateInfo framebufferInfo{};
-			framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferInfo.renderPass = renderPass;
-			framebufferInfo.attachmentCount = 1;
-			framebufferInfo.pAttachments = attachments;
-			framebufferInfo.width = swapChain.extent.width;
-			framebufferInfo.height = swapChain.extent.height;
-			framebufferInfo.layers = 1;
+		for (int i = 0; i < 3; i++)
+		{
+			VkFormatProperties properties;
+			vkGetPhysicalDeviceFormatProperties(physicalDevice, candidates[i], &properties);
 
-			if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffers[i]) != VK_SUCCESS)
-			{
-				throw std::runtime_error("Failed to create framebuffer.");
-			}
+			if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) return candidates[i];
 		}
+
+		return VK_FORMAT_UNDEFINED;
 	}
 
 	/*-----------------------------------------------------------------------*/
-	/* Render Pass Setup													 */
+	/* Render Graph Setup													 */
 	/*-----------------------------------------------------------------------*/
-	void Renderer::SetupRenderPasses()
+	/*
+		Declares the frame to the render graph: vertex uploads, the GPU
+		cull and the scene pass, with what each reads and writes. The
+		graph works out the barriers between them, the scene's render
+		pass and framebuffers, and the depth image, which lives only
+		within the frame.
+	*/
+	void Renderer::SetupRenderGraph()
 	{
-		/* Render Pass Setup ------------------------------------------------*/
+		renderGraph = new RenderGraph(device, allocator);
+		renderGraph->SetDeletionQueue(deletionQueue);
+
+		/* Resources ----------------------------------------------------*/
+		swapChainTarget = renderGraph->ImportImage(	"SwapChain", swapChain.format, VK_IMAGE_ASPECT_COLOR_BIT,
+													VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+													VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		vertexBufferResource = renderGraph->ImportBuffer("VertexBuffer");
+		cullChunkResource = renderGraph->ImportBuffer("CullChunks");
+		indirectResource = renderGraph->ImportBuffer("IndirectDraws");
+
+		if (depthFormat != VK_FORMAT_UNDEFINED)
+		{
+			depthTarget = renderGraph->CreateImage("Depth", depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+		}
+
 		/*
-			Next, we need to create our render pass.
+			With dynamic resolution the scene draws to its own target,
+			which the Upscale pass stretches over the swap chain image.
+			With damage tracking that target is persistent, since frames
+			only redraw part of it, and is copied over whole.
 		*/
-		VkAttachmentDescription colorAttachment{};
-		colorAttachment.format = swapChain.format;
-		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		GraphResource colorTarget = swapChainTarget;
+		if (damageTracking)
+		{
+			sceneTarget = renderGraph->CreatePersistentImage("SceneColor", swapChain.format, VK_IMAGE_ASPECT_COLOR_BIT);
+			colorTarget = sceneTarget;
+		}
+		else if (dynamicResolution)
+		{
+			sceneTarget = renderGraph->CreateImage("SceneColor", swapChain.format, VK_IMAGE_ASPECT_COLOR_BIT);
+			colorTarget = sceneTarget;
+		}
+
+		/* Passes -------------------------------------------------------*/
+		GraphPass uploadPass = renderGraph->AddPass("Upload", false, [this](VkCommandBuffer commandBuffer)
+		{
+			RecordUploadCommands(commandBuffer);
+		});
+		renderGraph->Use(uploadPass, vertexBufferResource, GRAPH_ACCESS_TRANSFER_WRITE);
+
+		GraphPass resetPass = renderGraph->AddPass("IndirectReset", false, [this](VkCommandBuffer commandBuffer)
+		{
+			RecordIndirectResetCommands(commandBuffer);
+		});
+		renderGraph->Use(resetPass, indirectResource, GRAPH_ACCESS_TRANSFER_WRITE);
+
+		GraphPass cullPass = renderGraph->AddPass("Cull", false, [this](VkCommandBuffer commandBuffer)
+		{
+			RecordCullCommands(commandBuffer);
+		});
+		renderGraph->Use(cullPass, cullChunkResource, GRAPH_ACCESS_COMPUTE_READ);
+		renderGraph->Use(cullPass, indirectResource, GRAPH_ACCESS_COMPUTE_WRITE);
 
-		VkAttachmentReference colorAttachmentRef{};
-		colorAttachmentRef.attachment = 0; // This index corresponds to the fragment shader input.
-		colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		scenePass = renderGraph->AddPass("Scene", true, [this](VkCommandBuffer commandBuffer)
+		{
+			RecordSceneCommands(commandBuffer);
+		});
 
-		VkSubpassDescription subpass{};
-		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass.colorAttachmentCount = 1;
-		subpass.pColorAttachments = &colorAttachmentRef;
+		/* Damage tracking clears the damaged part itself. */
+		clearColor = {};
+		clearColor.color = { { 1.0f, 1.0f, 1.0f, 1.0f } };
+		if (damageTracking) renderGraph->Use(scenePass, colorTarget, GRAPH_ACCESS_COLOR_ATTACHMENT);
+		else renderGraph->UseAttachment(scenePass, colorTarget, GRAPH_ACCESS_COLOR_ATTACHMENT, clearColor);
 
-		VkSubpassDependency dependency{};
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.dstSubpass = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.srcAccessMask = 0;
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		if (depthFormat != VK_FORMAT_UNDEFINED)
+		{
+			VkClearValue clearDepth{};
+			clearDepth.depthStencil = { 1.0f, 0 };
+			renderGraph->UseAttachment(scenePass, depthTarget, GRAPH_ACCESS_DEPTH_ATTACHMENT, clearDepth);
+		}
 
-		VkRenderPassCreateInfo renderPassInfo{};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		renderPassInfo.attachmentCount = 1;
-		renderPassInfo.pAttachments = &colorAttachment;
-		renderPassInfo.subpassCount = 1;
-		renderPassInfo.pSubpasses = &subpass;
-		renderPassInfo.dependencyCount = 1;
-		renderPassInfo.pDependencies = &dependency;
+		renderGraph->Use(scenePass, vertexBufferResource, GRAPH_ACCESS_VERTEX_READ);
+		renderGraph->Use(scenePass, indirectResource, GRAPH_ACCESS_INDIRECT_READ);
 
-		if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+		if (dynamicResolution || damageTracking)
 		{
-			throw std::runtime_error("Failed to create render pass.");
+			GraphPass upscalePass = renderGraph->AddPass("Upscale", false, [this](VkCommandBuffer commandBuffer)
+			{
+				RecordUpscaleCommands(commandBuffer);
+			});
+			renderGraph->Use(upscalePass, sceneTarget, GRAPH_ACCESS_TRANSFER_READ);
+			renderGraph->Use(upscalePass, swapChainTarget, GRAPH_ACCESS_TRANSFER_WRITE);
 		}
+
+		/* Compile ------------------------------------------------------*/
+		if (dynamicRenderingSupported) renderGraph->SetDynamicRendering(cmdBeginRendering, cmdEndRendering);
+		renderGraph->Build();
 	}
 
 	/*-----------------------------------------------------------------------*/
@@ -684,9 +2593,10 @@ namespace VkExample
 	/*-----------------------------------------------------------------------*/
 	void Renderer::SetupDescriptorLayout()
 	{
+		/* Dynamic, so each view can bind its own slice of the same set. */
 		VkDescriptorSetLayoutBinding uboLayoutBinding{};
 		uboLayoutBinding.binding = 0;
-		uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 		uboLayoutBinding.descriptorCount = 1;
 		uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 		uboLayoutBinding.pImmutableSamplers = nullptr;
@@ -700,6 +2610,133 @@ namespace VkExample
 		{
 			throw std::runtime_error("Failed to create descriptor set layout.");
 		}
+
+		/*
+			cull.comp reads the main view's UBO slice and the chunk boxes,
+			and writes the indirect draws.
+		*/
+		VkDescriptorSetLayoutBinding cullBindings[3]{};
+		VkDescriptorType cullTypes[3] = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER };
+		for (int i = 0; i < 3; i++)
+		{
+			cullBindings[i].binding = i;
+			cullBindings[i].descriptorType = cullTypes[i];
+			cullBindings[i].descriptorCount = 1;
+			cullBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			cullBindings[i].pImmutableSamplers = nullptr;
+		}
+
+		layoutInfo.bindingCount = 3;
+		layoutInfo.pBindings = cullBindings;
+
+		if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &cullDescriptorSetLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create cull descriptor set layout.");
+		}
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Descriptor Set Setup													 */
+	/*-----------------------------------------------------------------------*/
+	/* Setup Descriptor Sets ------------------------------------------------*/
+	void Renderer::SetupDescriptorSets()
+	{
+		/* One graphics set and one cull set per frame in flight. */
+		VkDescriptorPoolSize poolSizes[3]{};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		poolSizes[0].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		poolSizes[1].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+		poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[2].descriptorCount = 2 * MAX_FRAMES_IN_FLIGHT;
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = 3;
+		poolInfo.pPoolSizes = poolSizes;
+		poolInfo.maxSets = 2 * MAX_FRAMES_IN_FLIGHT;
+
+		if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create descriptor pool.");
+		}
+
+		std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = descriptorPool;
+		allocInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
+		allocInfo.pSetLayouts = layouts.data();
+
+		descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+		if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to allocate descriptor sets.");
+		}
+
+		std::vector<VkDescriptorSetLayout> cullLayouts(MAX_FRAMES_IN_FLIGHT, cullDescriptorSetLayout);
+		allocInfo.pSetLayouts = cullLayouts.data();
+
+		cullDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+		if (vkAllocateDescriptorSets(device, &allocInfo, cullDescriptorSets.data()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to allocate cull descriptor sets.");
+		}
+
+		WriteDescriptorSets();
+	}
+
+	/* Write Descriptor Sets ------------------------------------------------*/
+	/*
+		Points each frame's descriptor sets at that frame's uniform buffer
+		(and, for culling, the chunk and indirect buffers). This has to be
+		redone whenever any of those are recreated (e.g. when
+		defragmentation moves them, or the cull buffers grow).
+	*/
+	void Renderer::WriteDescriptorSets()
+	{
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			VkDescriptorBufferInfo bufferInfo{};
+			bufferInfo.buffer = uniformBuffers[i];
+			bufferInfo.offset = 0;
+			bufferInfo.range = sizeof(UniformBufferObject);
+
+			VkWriteDescriptorSet descriptorWrite{};
+			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrite.dstSet = descriptorSets[i];
+			descriptorWrite.dstBinding = 0;
+			descriptorWrite.dstArrayElement = 0;
+			descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			descriptorWrite.descriptorCount = 1;
+			descriptorWrite.pBufferInfo = &bufferInfo;
+
+			vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+
+			VkDescriptorBufferInfo cullBufferInfos[3]{};
+			cullBufferInfos[0] = bufferInfo;
+			cullBufferInfos[1].buffer = cullChunkBuffers[i];
+			cullBufferInfos[1].offset = 0;
+			cullBufferInfos[1].range = VK_WHOLE_SIZE;
+			cullBufferInfos[2].buffer = indirectBuffers[i];
+			cullBufferInfos[2].offset = 0;
+			cullBufferInfos[2].range = VK_WHOLE_SIZE;
+
+			VkWriteDescriptorSet cullWrites[3]{};
+			for (int j = 0; j < 3; j++)
+			{
+				cullWrites[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				cullWrites[j].dstSet = cullDescriptorSets[i];
+				cullWrites[j].dstBinding = j;
+				cullWrites[j].dstArrayElement = 0;
+				cullWrites[j].descriptorType = (j == 0) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				cullWrites[j].descriptorCount = 1;
+				cullWrites[j].pBufferInfo = &cullBufferInfos[j];
+			}
+
+			vkUpdateDescriptorSets(device, 3, cullWrites, 0, nullptr);
+		}
 	}
 
 	/*-----------------------------------------------------------------------*/
@@ -750,12 +2787,6 @@ namespace VkExample
 		viewportState.viewportCount = 1;
 		viewportState.scissorCount = 1;
 
-		camera->SetViewportWidth((float)swapChain.extent.width);
-		camera->SetViewportHeight((float)swapChain.extent.height);
-
-		camera->SetScissorOffset({ 0, 0 });
-		camera->SetScissorExtent(swapChain.extent);
-
 		/*
 			Now, we prepare our rasterizer.
 		*/
@@ -787,8 +2818,7 @@ namespace VkExample
 		/*
 			And now the color blend attachment state.
 		*/
-		// Consider setting blendEnable to VK_TRUE, srcColorBlendFactor to VK_BLEND_FACTOR_SRC_ALPHA,
-		// and dstColorBlendFactor to VK_BLEND_FACTOR_ZEROVK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA.
+		// Opaque geometry doesn't blend; the transparent variant at the end does.
 		VkPipelineColorBlendAttachmentState colorBlendAttachment{};
 		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
 		colorBlendAttachment.blendEnable = VK_FALSE;
@@ -815,67 +2845,520 @@ namespace VkExample
 		pipelineLayoutInfo.pushConstantRangeCount = 0;
 		pipelineLayoutInfo.pPushConstantRanges = nullptr;
 
-		if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+		if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create pipeline layout.");
+		}
+
+		/* Pipeline Finalization --------------------------------------------*/
+		/*
+			Now, at long last, we can finalize our pipeline. God is good.
+		*/
+		VkGraphicsPipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		std::vector<VkPipelineShaderStageCreateInfo> shaderStages = baseShader.GetStages();
+		pipelineInfo.stageCount = shaderStages.size();
+		pipelineInfo.pStages = shaderStages.data();
+
+		pipelineInfo.pVertexInputState = &vertexInputInfo;
+		pipelineInfo.pInputAssemblyState = &inputAssembly;
+		pipelineInfo.pViewportState = &viewportState;
+		pipelineInfo.pRasterizationState = &rasterizer;
+		pipelineInfo.pMultisampleState = &multisampling;
+		pipelineInfo.pDepthStencilState = nullptr;
+		pipelineInfo.pColorBlendState = &colorBlending;
+		pipelineInfo.pDynamicState = &dynamicState;
+
+		pipelineInfo.layout = pipelineLayout;
+
+		/*
+			With dynamic rendering there is no render pass; the pipeline
+			names the attachment formats instead, and stays valid however
+			the swap chain is recreated.
+		*/
+		VkPipelineRenderingCreateInfoKHR renderingInfo{};
+		if (dynamicRenderingSupported)
+		{
+			renderGraph->GetPipelineRenderingInfo(scenePass, renderingInfo);
+			pipelineInfo.pNext = &renderingInfo;
+		}
+
+		pipelineInfo.renderPass = renderGraph->GetRenderPass(scenePass);
+		pipelineInfo.subpass = 0;
+
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		pipelineInfo.basePipelineIndex = -1;
+
+		if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create graphics pipeline.");
+		}
+
+		/* Depth Variant ----------------------------------------------------*/
+		/*
+			The same pipeline with depth testing and writing on, for when
+			there is a depth buffer. Equal depths pass, so geometry sharing
+			a z still draws in buffer order, later on top.
+		*/
+		VkPipelineDepthStencilStateCreateInfo depthStencil{};
+		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencil.depthTestEnable = VK_TRUE;
+		depthStencil.depthWriteEnable = VK_TRUE;
+		depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+		depthStencil.depthBoundsTestEnable = VK_FALSE;
+		depthStencil.stencilTestEnable = VK_FALSE;
+
+		depthPipeline = VK_NULL_HANDLE;
+		if (depthFormat != VK_FORMAT_UNDEFINED)
+		{
+			pipelineInfo.pDepthStencilState = &depthStencil;
+
+			if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &depthPipeline) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create depth graphics pipeline.");
+			}
+		}
+
+		/* Transparent Variant ----------------------------------------------*/
+		/*
+			Alpha blended, and tested against the opaque depth without
+			writing to it, so transparent items never hide each other.
+			Only this variant blends, so the opaque pipelines keep early
+			depth rejection and skip the read-modify-write.
+		*/
+		depthStencil.depthWriteEnable = VK_FALSE;
+
+		colorBlendAttachment.blendEnable = VK_TRUE;
+		colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+		if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &transparentPipeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create transparent graphics pipeline.");
+		}
+	}
+
+	/* Setup Cull Pipeline --------------------------------------------------*/
+	/*
+		The compute pipeline for cull.comp. The chunk count is a push
+		constant, since it changes without the buffers being rebound.
+	*/
+	void Renderer::SetupCullPipeline(Shader cullShader)
+	{
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(uint32_t);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &cullDescriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &cullPipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create cull pipeline layout.");
+		}
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage = cullShader.GetStages()[0];
+		pipelineInfo.layout = cullPipelineLayout;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		pipelineInfo.basePipelineIndex = -1;
+
+		if (vkCreateComputePipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &cullPipeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create cull pipeline.");
+		}
+	}
+
+	/* Load Pipeline Cache --------------------------------------------------*/
+	/*
+		Seeds the pipeline cache from PIPELINE_CACHE_PATH. The file is only
+		used if its header names this device and driver; drivers are meant
+		to reject foreign data themselves, but not all of them do.
+	*/
+	void Renderer::LoadPipelineCache()
+	{
+		std::vector<char> data;
+		std::ifstream file(PIPELINE_CACHE_PATH, std::ios::ate | std::ios::binary);
+		if (file.is_open())
+		{
+			data.resize((size_t)file.tellg());
+			file.seekg(0);
+			file.read(data.data(), data.size());
+		}
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+		/*
+			The header: length, version, vendor ID and device ID (all
+			uint32_t), then the cache UUID.
+		*/
+		const size_t headerSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+		bool valid = data.size() >= headerSize;
+		if (valid)
+		{
+			uint32_t header[4];
+			memcpy(header, data.data(), sizeof(header));
+			valid = header[2] == properties.vendorID && header[3] == properties.deviceID &&
+					memcmp(data.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+		}
+
+		VkPipelineCacheCreateInfo cacheInfo{};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		cacheInfo.initialDataSize = valid ? data.size() : 0;
+		cacheInfo.pInitialData = valid ? data.data() : nullptr;
+
+		if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create pipeline cache.");
+		}
+	}
+
+	/* Save Pipeline Cache --------------------------------------------------*/
+	void Renderer::SavePipelineCache()
+	{
+		size_t size = 0;
+		if (vkGetPipelineCacheData(device, pipelineCache, &size, nullptr) != VK_SUCCESS || size == 0) return;
+
+		std::vector<char> data(size);
+		if (vkGetPipelineCacheData(device, pipelineCache, &size, data.data()) != VK_SUCCESS) return;
+
+		std::ofstream file(PIPELINE_CACHE_PATH, std::ios::binary | std::ios::trunc);
+		file.write(data.data(), size);
+	}
+
+	/* Poll Cull Pipeline ---------------------------------------------------*/
+	/*
+		Picks up the cull pipeline once its compile finishes. Until then
+		GetGpuCullingActive() is false and frames cull on the CPU; if the
+		compile failed, they always do.
+	*/
+	void Renderer::PollCullPipeline()
+	{
+		if (cullPipelineReady || !cullPipelineBuild.valid()) return;
+		if (cullPipelineBuild.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+
+		try
+		{
+			cullPipelineBuild.get();
+		}
+		catch (const std::exception& e)
+		{
+			std::cout << "GPU culling unavailable: " << e.what() << std::endl;
+			return;
+		}
+
+		cullPipelineReady = true;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Buffer Setup															 */
+	/*-----------------------------------------------------------------------*/
+	/* Copy Buffer ----------------------------------------------------------*/
+	void Renderer::CopyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset)
+	{
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = commandPool;
+		allocInfo.commandBufferCount = 1;
+
+		VkCommandBuffer commandBuffer;
+		vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+		VkBufferCopy copyRegion{};
+		copyRegion.srcOffset = srcOffset;
+		copyRegion.dstOffset = dstOffset;
+		copyRegion.size = size;
+		vkCmdCopyBuffer(commandBuffer, src, dst, 1, &copyRegion);
+
+		vkEndCommandBuffer(commandBuffer);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+
+		vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+		vkQueueWaitIdle(graphicsQueue);
+
+		vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+	}
+
+	/* Create Buffer --------------------------------------------------------*/
+	/*
+		Buffers no longer get a vkAllocateMemory call each; their memory is
+		sub-allocated from the allocator's blocks. Host-visible buffers come
+		back already mapped (allocation.mapped).
+	*/
+	void Renderer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+								VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+								MemoryCategory category, VkBuffer& buffer, Allocation& allocation)
+	{
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = size;
+		bufferInfo.usage = usage;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create buffer.");
+		}
+
+		VkMemoryRequirements memRequirements;
+		vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+
+		allocation = allocator->Allocate(memRequirements, required, preferred, true, category);
+
+		if (vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to bind buffer memory.");
+		}
+	}
+
+	/* Destroy Buffer -------------------------------------------------------*/
+	void Renderer::DestroyBuffer(VkBuffer& buffer, Allocation& allocation)
+	{
+		vkDestroyBuffer(device, buffer, nullptr);
+		allocator->Free(allocation);
+		buffer = VK_NULL_HANDLE;
+	}
+
+	/* Resize Staging Buffer ------------------------------------------------*/
+	/*
+		Copies out of the old buffer may still be pending or running in a
+		frame in flight, in which case it goes on the deletion queue. An
+		idle one is released before the new one is created, so that a
+		shrink actually gives memory back.
+	*/
+	void Renderer::ResizeStagingBuffer(VkDeviceSize size)
+	{
+		if (stagingBuffer != VK_NULL_HANDLE)
+		{
+			if (stagingOffset == 0 && (stagingFrameValue == 0 || stagingFrameValue <= GetCompletedFrameValue()))
+			{
+				DestroyBuffer(stagingBuffer, stagingBufferAllocation);
+			}
+			else
+			{
+				deletionQueue->PushBuffer(stagingBuffer, stagingBufferAllocation);
+				stagingBuffer = VK_NULL_HANDLE;
+			}
+		}
+
+		stagingBufferSize = size;
+		stagingOffset = 0;
+		stagingFrameValue = 0;
+		CreateBuffer(stagingBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, MEMORY_CATEGORY_STAGING, stagingBuffer, stagingBufferAllocation);
+	}
+
+	/* Create Vertex Buffer -------------------------------------------------*/
+	/*
+		On UMA and resizable-BAR systems the vertex buffer goes straight
+		into device-local memory the CPU can write to, and there is no
+		staging buffer at all. Everywhere else we keep the staging copy.
+	*/
+	void Renderer::CreateVertexBuffer(VkDeviceSize size, VkBuffer& buffer, Allocation& allocation)
+	{
+		VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+		if (directVertexWrites)
+		{
+			CreateBuffer(size, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, MEMORY_CATEGORY_VERTEX, buffer, allocation);
+		}
+		else
+		{
+			CreateBuffer(size, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, MEMORY_CATEGORY_VERTEX, buffer, allocation);
+		}
+	}
+
+	/* Grow Vertex Buffer ---------------------------------------------------*/
+	/*
+		Grows the vertex buffer to hold at least `required` bytes, keeping
+		the first `preserve` bytes. They are copied across in the next
+		frame's Upload pass, except where a pending copy already brings
+		newer vertices. The old buffer may still be bound by frames in
+		flight, and is read by that copy, so it goes on the deletion queue
+		rather than being destroyed. The staging buffer grows along with
+		it, up to stagingBufferLimit (which memory pressure can lower).
+	*/
+	void Renderer::GrowVertexBuffer(VkDeviceSize required, VkDeviceSize preserve)
+	{
+		if (MAX_VERTEX_BUFFER_SIZE > 0 && required > MAX_VERTEX_BUFFER_SIZE)
+		{
+			throw std::runtime_error("Vertex data exceeds MAX_VERTEX_BUFFER_SIZE.");
+		}
+
+		VkDeviceSize size = std::max<VkDeviceSize>(vertexBufferSize, INITIAL_VERTEX_BUFFER_SIZE);
+		while (size < required) size *= VERTEX_BUFFER_GROWTH_FACTOR;
+		if (MAX_VERTEX_BUFFER_SIZE > 0) size = std::min<VkDeviceSize>(size, MAX_VERTEX_BUFFER_SIZE);
+
+		VkBuffer newBuffer;
+		Allocation newAllocation;
+		CreateVertexBuffer(size, newBuffer, newAllocation);
+
+		if (preserve > 0)
+		{
+			std::vector<VertexCopy> kept = { { vertexBuffer, { 0, 0, std::min(preserve, vertexBufferSize) } } };
+			for (int i = 0; i < pendingCopies.size(); i++)
+			{
+				VkBufferCopy region = pendingCopies[i].region;
+				ClipVertexCopies(kept, region.dstOffset, region.dstOffset + region.size);
+			}
+
+			pendingCopies.insert(pendingCopies.begin(), kept.begin(), kept.end());
+			growCopiesPending = true;
+		}
+
+		deletionQueue->PushBuffer(vertexBuffer, vertexBufferAllocation);
+		vertexBuffer = newBuffer;
+		vertexBufferAllocation = newAllocation;
+		vertexBufferSize = size;
+
+		if (!directVertexWrites)
 		{
-			throw std::runtime_error("Failed to create pipeline layout.");
+			VkDeviceSize stagingSize = std::min(vertexBufferSize, stagingBufferLimit);
+			if (stagingSize > stagingBufferSize) ResizeStagingBuffer(stagingSize);
 		}
+	}
 
-		/* Pipeline Finalization --------------------------------------------*/
-		/*
-			Now, at long last, we can finalize our pipeline. God is good.
-		*/
-		VkGraphicsPipelineCreateInfo pipelineInfo{};
-		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		std::vector<VkPipelineShaderStageCreateInfo> shaderStages = baseShader.GetStages();
-		pipelineInfo.stageCount = shaderStages.size();
-		pipelineInfo.pStages = shaderStages.data();
+	/* Clip Vertex Copies ---------------------------------------------------*/
+	/*
+		Cuts the byte range [start, end) of the vertex buffer out of the
+		copies, so older vertices can't be copied over newer ones. A copy
+		straddling the range keeps a piece on either side.
+	*/
+	void Renderer::ClipVertexCopies(std::vector<VertexCopy>& copies, VkDeviceSize start, VkDeviceSize end)
+	{
+		std::vector<VertexCopy> kept;
 
-		pipelineInfo.pVertexInputState = &vertexInputInfo;
-		pipelineInfo.pInputAssemblyState = &inputAssembly;
-		pipelineInfo.pViewportState = &viewportState;
-		pipelineInfo.pRasterizationState = &rasterizer;
-		pipelineInfo.pMultisampleState = &multisampling;
-		pipelineInfo.pDepthStencilState = nullptr;
-		pipelineInfo.pColorBlendState = &colorBlending;
-		pipelineInfo.pDynamicState = &dynamicState;
+		for (int i = 0; i < copies.size(); i++)
+		{
+			VkBufferCopy copy = copies[i].region;
+			VkDeviceSize copyEnd = copy.dstOffset + copy.size;
 
-		pipelineInfo.layout = pipelineLayout;
+			if (copyEnd <= start || copy.dstOffset >= end)
+			{
+				kept.push_back(copies[i]);
+				continue;
+			}
 
-		pipelineInfo.renderPass = renderPass;
-		pipelineInfo.subpass = 0;
+			if (copy.dstOffset < start) kept.push_back({ copies[i].source, { copy.srcOffset, copy.dstOffset, start - copy.dstOffset } });
+			if (copyEnd > end) kept.push_back({ copies[i].source, { copy.srcOffset + (end - copy.dstOffset), end, copyEnd - end } });
+		}
 
-		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-		pipelineInfo.basePipelineIndex = -1;
+		copies.swap(kept);
+	}
+
+	/* Queue Upload ---------------------------------------------------------*/
+	/*
+		Copies size bytes into this frame's upload buffer and queues their
+		copy to dstOffset for the next frame's Upload pass. Returns false
+		if the upload buffer doesn't have the room.
+	*/
+	bool Renderer::QueueUpload(const void* data, VkDeviceSize size, VkDeviceSize dstOffset)
+	{
+		if (uploadOffset + size > UPLOAD_BUFFER_SIZE) return false;
+
+		/*
+			The upload buffer for this frame may still be being read by its
+			last submission. Render() is about to wait for the same frame, so
+			this doesn't add a stall.
+		*/
+		if (!uploadBufferReady)
+		{
+			WaitForFrame(frame);
+			uploadBufferReady = true;
+		}
 
-		if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
+		if (uploadBuffers[frame] == VK_NULL_HANDLE)
 		{
-			throw std::runtime_error("Failed to create graphics pipeline.");
+			CreateBuffer(	UPLOAD_BUFFER_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+							VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0,
+							MEMORY_CATEGORY_STAGING, uploadBuffers[frame], uploadBuffersAllocation[frame]);
 		}
+
+		memcpy((char*)uploadBuffersAllocation[frame].mapped + uploadOffset, data, size);
+		ClipVertexCopies(pendingCopies, dstOffset, dstOffset + size);
+		pendingCopies.push_back({ uploadBuffers[frame], { uploadOffset, dstOffset, size } });
+		uploadOffset += size;
+
+		return true;
 	}
 
-	/*-----------------------------------------------------------------------*/
-	/* Buffer Setup															 */
-	/*-----------------------------------------------------------------------*/
-	/* Find Memory Type -----------------------------------------------------*/
-	unsigned int Renderer::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+	/* Get Vertex Bytes In Flight -------------------------------------------*/
+	/*
+		How far into the current vertex buffer the frames still in flight
+		draw or copy. The CPU can write past it without waiting for them.
+		Frames that used an older vertex buffer don't count.
+	*/
+	VkDeviceSize Renderer::GetVertexBytesInFlight()
 	{
-		VkPhysicalDeviceMemoryProperties memProperties;
-		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+		uint64_t completed = GetCompletedFrameValue();
+		VkDeviceSize bytes = 0;
 
-		for (int i = 0; i < memProperties.memoryTypeCount; i++)
+		for (int i = 0; i < frameValues.size(); i++)
 		{
-			if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-			{
-				return i;
-			}
+			if (frameValues[i] <= completed || frameVertexBuffers[i] != vertexBuffer) continue;
+			bytes = std::max(bytes, frameVertexExtents[i]);
 		}
 
-		throw std::runtime_error("Failed to find suitable memory type.");
+		return bytes;
 	}
 
-	/* Copy Buffer ----------------------------------------------------------*/
-	void Renderer::CopyBuffer(VkBuffer src, VkBuffer dst, unsigned int size)
+	/* Stage Vertex Write ---------------------------------------------------*/
+	/*
+		Copies size bytes into the staging buffer and queues their copy to
+		dstOffset for the next frame's Upload pass. Before reusing the
+		staging buffer we wait for the frame that last copied out of it,
+		not for every frame in flight. It may have been shrunk under memory
+		pressure; if a write fills it within a frame, the copies so far are
+		flushed on the spot and it starts over.
+	*/
+	void Renderer::StageVertexWrite(const void* data, VkDeviceSize size, VkDeviceSize dstOffset)
+	{
+		for (VkDeviceSize offset = 0; offset < size;)
+		{
+			if (stagingOffset == stagingBufferSize) FlushVertexCopies();
+			if (stagingOffset == 0) WaitForFrameValue(stagingFrameValue);
+
+			VkDeviceSize chunk = std::min(stagingBufferSize - stagingOffset, size - offset);
+			memcpy((char*)stagingBufferAllocation.mapped + stagingOffset, (const char*)data + offset, chunk);
+			pendingCopies.push_back({ stagingBuffer, { stagingOffset, dstOffset + offset, chunk } });
+
+			stagingOffset += chunk;
+			offset += chunk;
+		}
+	}
+
+	/* Flush Vertex Copies --------------------------------------------------*/
+	/*
+		Records the pending copies into a one-off command buffer and waits
+		for it, for when they can't wait for the next frame. The barrier
+		keeps them behind frames in flight still drawing from the vertex
+		buffer.
+	*/
+	void Renderer::FlushVertexCopies()
 	{
+		if (pendingCopies.empty()) return;
+
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -891,11 +3374,13 @@ namespace VkExample
 
 		vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
-		VkBufferCopy copyRegion{};
-		copyRegion.srcOffset = 0;
-		copyRegion.dstOffset = 0;
-		copyRegion.size = size;
-		vkCmdCopyBuffer(commandBuffer, src, dst, 1, &copyRegion);
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		RecordVertexCopies(commandBuffer);
 
 		vkEndCommandBuffer(commandBuffer);
 
@@ -908,59 +3393,139 @@ namespace VkExample
 		vkQueueWaitIdle(graphicsQueue);
 
 		vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+
+		stagingOffset = 0;
+		stagingFrameValue = 0;
 	}
 
-	/* Create Buffer --------------------------------------------------------*/
-	void Renderer::CreateBuffer(unsigned int size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+	/* Setup Vertex Buffer --------------------------------------------------*/
+	void Renderer::SetupVertexBuffer()
 	{
+		vertexBufferSize = INITIAL_VERTEX_BUFFER_SIZE;
+		vertexCount = 0;
+		stagingBuffer = VK_NULL_HANDLE;
+		stagingBufferSize = 0;
+		stagingOffset = 0;
+		stagingFrameValue = 0;
+		growCopiesPending = false;
+		stagingBufferLimit = MAX_STAGING_BUFFER_SIZE;
+
+		/*
+			A device-local, host-visible type existing isn't enough: the
+			vertex buffer has to be allowed in it, so ask a throwaway buffer
+			with the same usage which types it takes.
+		*/
 		VkBufferCreateInfo bufferInfo{};
 		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bufferInfo.size = size;
-		bufferInfo.usage = usage;
+		bufferInfo.size = vertexBufferSize;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
 		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-		if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+		VkBuffer probe;
+		if (vkCreateBuffer(device, &bufferInfo, nullptr, &probe) != VK_SUCCESS)
 		{
 			throw std::runtime_error("Failed to create buffer.");
 		}
 
-		VkMemoryRequirements memRequirements;
-		vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(device, probe, &requirements);
+		vkDestroyBuffer(device, probe, nullptr);
+
+		directVertexWrites = allocator->SupportsDirectWrite(requirements.memoryTypeBits);
+
+		CreateVertexBuffer(vertexBufferSize, vertexBuffer, vertexBufferAllocation);
+		if (!directVertexWrites) ResizeStagingBuffer(std::min(vertexBufferSize, stagingBufferLimit));
+	}
+
+	/* Setup Vertex Buffer --------------------------------------------------*/
+	void Renderer::SetupUniformBuffers()
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+		VkDeviceSize alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+		uniformStride = (sizeof(UniformBufferObject) + alignment - 1) / alignment * alignment;
+
+		VkDeviceSize bufferSize = uniformStride * MAX_VIEWS;
+
+		uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+		uniformBuffersAllocation.resize(MAX_FRAMES_IN_FLIGHT);
+		uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
 
-		VkMemoryAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memRequirements.size;
-		allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, properties);
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			CreateBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MEMORY_CATEGORY_UNIFORM, uniformBuffers[i], uniformBuffersAllocation[i]);
+			uniformBuffersMapped[i] = uniformBuffersAllocation[i].mapped;
+		}
+	}
 
-		if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
+	/* Create Cull Buffers --------------------------------------------------*/
+	/*
+		The chunk boxes change whenever the vertices do, and are written by
+		the CPU, so each frame in flight gets its own host-visible copy.
+		Each frame also gets its own indirect buffer, since cull.comp
+		rewrites it every frame.
+	*/
+	void Renderer::CreateCullBuffers(uint32_t capacity)
+	{
+		cullChunkBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+		cullChunkBuffersAllocation.resize(MAX_FRAMES_IN_FLIGHT);
+		indirectBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+		indirectBuffersAllocation.resize(MAX_FRAMES_IN_FLIGHT);
+		cullChunkCounts.assign(MAX_FRAMES_IN_FLIGHT, 0);
+		cullChunkVersions.assign(MAX_FRAMES_IN_FLIGHT, UINT64_MAX);
+
+		VkDeviceSize indirectSize = sizeof(IndirectDrawHeader) + (VkDeviceSize)capacity * sizeof(VkDrawIndirectCommand);
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
 		{
-			throw std::runtime_error("Failed to allocate buffer memory.");
+			CreateBuffer(	(VkDeviceSize)capacity * sizeof(GpuChunk), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+							VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+							MEMORY_CATEGORY_OTHER, cullChunkBuffers[i], cullChunkBuffersAllocation[i]);
+
+			CreateBuffer(	indirectSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+							VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, MEMORY_CATEGORY_OTHER, indirectBuffers[i], indirectBuffersAllocation[i]);
 		}
 
-		vkBindBufferMemory(device, buffer, bufferMemory, 0);
+		cullChunkCapacity = capacity;
 	}
 
-	/* Setup Vertex Buffer --------------------------------------------------*/
-	void Renderer::SetupVertexBuffer()
+	/* Destroy Cull Buffers -------------------------------------------------*/
+	void Renderer::DestroyCullBuffers()
 	{
-		unsigned int bufferSize = sizeof(Vertex) * (MAX_TRIANGLES * 3);
-		CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-		CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+		for (int i = 0; i < indirectBuffers.size(); i++)
+		{
+			DestroyBuffer(cullChunkBuffers[i], cullChunkBuffersAllocation[i]);
+			DestroyBuffer(indirectBuffers[i], indirectBuffersAllocation[i]);
+		}
 	}
 
-	/* Setup Vertex Buffer --------------------------------------------------*/
-	void Renderer::SetupUniformBuffers()
+	/* Setup Upload Buffers -------------------------------------------------*/
+	void Renderer::SetupUploadBuffers()
 	{
-		VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+		uploadBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+		uploadBuffersAllocation.resize(MAX_FRAMES_IN_FLIGHT);
+		frameVertexBuffers.assign(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+		frameVertexExtents.assign(MAX_FRAMES_IN_FLIGHT, 0);
+		uploadOffset = 0;
+		uploadBufferReady = false;
+
+		/* Created by the first QueueVertexUpload() that needs them. */
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) uploadBuffers[i] = VK_NULL_HANDLE;
+	}
 
-		uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-		uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-		uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+	/* Setup Transparent Buffers --------------------------------------------*/
+	void Renderer::SetupTransparentBuffers()
+	{
+		transparentBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+		transparentBuffersAllocation.resize(MAX_FRAMES_IN_FLIGHT);
+		transparentBufferSizes.assign(MAX_FRAMES_IN_FLIGHT, INITIAL_TRANSPARENT_BUFFER_SIZE);
+		transparentVertexCount = 0;
 
 		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
 		{
-			CreateBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffers[i], uniformBuffersMemory[i]);
-			vkMapMemory(device, uniformBuffersMemory[i], 0, bufferSize, 0, &uniformBuffersMapped[i]);
+			CreateBuffer(	INITIAL_TRANSPARENT_BUFFER_SIZE, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+							VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0,
+							MEMORY_CATEGORY_VERTEX, transparentBuffers[i], transparentBuffersAllocation[i]);
 		}
 	}
 
@@ -993,6 +3558,49 @@ namespace VkExample
 		}
 	}
 
+	/*-----------------------------------------------------------------------*/
+	/* GPU Timing Setup														 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		Timestamps need the graphics queue family to support them
+		(timestampValidBits isn't 0); without that, GPU timing stays off.
+	*/
+	void Renderer::SetupTimestamps(bool enabled)
+	{
+		gpuTiming = false;
+		timestampPool = VK_NULL_HANDLE;
+		gpuFrameMs = 0.0;
+		gpuFrameSamples = 0;
+		timestampsWritten.assign(MAX_FRAMES_IN_FLIGHT, false);
+
+		if (!enabled) return;
+
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+		uint32_t validBits = queueFamilies[indices.graphicsFamily.value()].timestampValidBits;
+		if (validBits == 0) return;
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		timestampPeriod = properties.limits.timestampPeriod;
+		timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+		VkQueryPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		poolInfo.queryCount = MAX_FRAMES_IN_FLIGHT * 2;
+
+		if (vkCreateQueryPool(device, &poolInfo, nullptr, &timestampPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create timestamp query pool.");
+		}
+
+		gpuTiming = true;
+	}
+
 	/*-----------------------------------------------------------------------*/
 	/* Synchronization Setup												 */
 	/*-----------------------------------------------------------------------*/
@@ -1000,47 +3608,165 @@ namespace VkExample
 	{
 		imagesAvailable.resize(MAX_FRAMES_IN_FLIGHT);
 		rendersFinished.resize(MAX_FRAMES_IN_FLIGHT);
-		inFlights.resize(MAX_FRAMES_IN_FLIGHT);
+		frameValues.assign(MAX_FRAMES_IN_FLIGHT, 0);
+		submittedFrameValue = 0;
+		completedFrameValue = 0;
 
 		VkSemaphoreCreateInfo semaphoreInfo{};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imagesAvailable[i]) != VK_SUCCESS ||
+				vkCreateSemaphore(device, &semaphoreInfo, nullptr, &rendersFinished[i]) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create semaphores.");
+			}
+		}
+
+		/*
+			With timeline semaphores, one semaphore counting frames replaces
+			a fence per frame slot. The swap chain still needs the binary
+			semaphores.
+		*/
+		frameTimeline = VK_NULL_HANDLE;
+		if (timelineSupported)
+		{
+			VkSemaphoreTypeCreateInfoKHR typeInfo{};
+			typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+			typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+			typeInfo.initialValue = 0;
+
+			VkSemaphoreCreateInfo timelineInfo{};
+			timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			timelineInfo.pNext = &typeInfo;
+
+			if (vkCreateSemaphore(device, &timelineInfo, nullptr, &frameTimeline) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create frame timeline semaphore.");
+			}
+
+			return;
+		}
+
+		inFlights.resize(MAX_FRAMES_IN_FLIGHT);
+
 		VkFenceCreateInfo fenceInfo{};
 		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
 		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
 		{
-			if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imagesAvailable[i]) != VK_SUCCESS ||
-				vkCreateSemaphore(device, &semaphoreInfo, nullptr, &rendersFinished[i]) != VK_SUCCESS ||
-				vkCreateFence(device, &fenceInfo, nullptr, &inFlights[i]) != VK_SUCCESS)
+			if (vkCreateFence(device, &fenceInfo, nullptr, &inFlights[i]) != VK_SUCCESS)
 			{
-				throw std::runtime_error("Failed to create semaphores and fences.");
+				throw std::runtime_error("Failed to create fences.");
 			}
 		}
 	}
 
+	/*-----------------------------------------------------------------------*/
+	/* Memory Pressure Functions											 */
+	/*-----------------------------------------------------------------------*/
+	/* Shrink Staging Buffer ------------------------------------------------*/
+	/*
+		The staging buffer is sized for a full vertex buffer upload, but it
+		works just as well in smaller pieces. Under pressure it gives back
+		at least half of itself at a time, down to MIN_STAGING_BUFFER_SIZE.
+	*/
+	void Renderer::ShrinkStagingBuffer(uint32_t heapIndex, VkDeviceSize bytesNeeded)
+	{
+		if (stagingBuffer == VK_NULL_HANDLE) return;
+		if (allocator->GetHeapIndex(stagingBufferAllocation.memoryType) != heapIndex) return;
+		if (stagingBufferSize <= MIN_STAGING_BUFFER_SIZE) return;
+
+		VkDeviceSize size = (stagingBufferSize > bytesNeeded) ? stagingBufferSize - bytesNeeded : 0;
+		size = std::max<VkDeviceSize>(std::min(size, stagingBufferSize / 2), MIN_STAGING_BUFFER_SIZE);
+		stagingBufferLimit = size;
+		ResizeStagingBuffer(size);
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Startup Functions													 */
+	/*-----------------------------------------------------------------------*/
+	/* Mark Startup Phase ---------------------------------------------------*/
+	/*
+		Ends the current startup phase: records how long it took since the
+		last mark, and adds it to the trace.
+	*/
+	void Renderer::MarkStartupPhase(const char* name)
+	{
+		uint64_t now = Profiler::Now();
+		Profiler::Record(name, startupMark, now);
+		startupPhases.push_back({ name, (now - startupMark) / 1000000.0 });
+		startupMark = now;
+	}
+
 	/*-----------------------------------------------------------------------*/
 	/* Constructor															 */
 	/*-----------------------------------------------------------------------*/
-	Renderer::Renderer(std::vector<VkDynamicState> dynamicStates, int screenWidth, int screenHeight, const char* title, Camera* camera)
+	Renderer::Renderer(	std::vector<VkDynamicState> dynamicStates, int screenWidth, int screenHeight, const char* title, Camera* camera,
+						RendererSettings settings)
 	{
 		/*-----------------------------------------------*/
 		/* Preliminaries								 */
 		/*-----------------------------------------------*/
 		this->frame = 0;
 		this->windowResized = false;
+		this->onDemand = settings.onDemand;
+		this->sceneRevision = 0;
+		this->drawnSceneRevision = 0;
+		this->drawnCullVersion = 0;
+		this->redrawRequested = true;
+		this->budgetCountdown = MEMORY_BUDGET_INTERVAL;
 		this->camera = camera;
+		this->views.push_back({ camera, {}, glm::mat4(0), glm::mat4(0), {}, {}, {}, {} });
+		this->uniformStride = sizeof(UniformBufferObject);
+		this->culler = new Culler();
+		this->transparentSorter = new RadixSorter();
+		this->gpuCulling = ENABLE_GPU_CULLING;
+		this->cullVersion = 0;
+		this->uploadedBytes = 0;
+		this->presentCount = 0;
+		this->framePacer = nullptr;
+		this->validationEnabled = settings.validation;
+		this->dynamicResolution = settings.dynamicResolution;
+		this->renderScale = settings.maxRenderScale;
+		this->minRenderScale = settings.minRenderScale;
+		this->maxRenderScale = settings.maxRenderScale;
+		this->targetFrameMs = settings.targetFrameMs;
+		this->gpuFrameAverageMs = 0.0;
+		this->scaledSamples = 0;
+		this->damageTracking = settings.damageTracking;
+		this->incrementalPresentSupported = false;
+		this->fullDamage = true;
+		this->transparentBounds = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+		this->drawnTransparentBounds = this->transparentBounds;
+		this->damagedExtent = { 0, 0 };
+		this->damageRect = {};
+		this->startupMark = Profiler::Now();
+		this->cullPipeline = VK_NULL_HANDLE;
+		this->cullPipelineLayout = VK_NULL_HANDLE;
+		this->cullPipelineReady = false;
+
+		/*
+			Reading the shaders from disk overlaps the instance and device
+			setup; they're only needed once the layouts exist.
+		*/
+		std::future<std::vector<char>> baseVertexCode = std::async(std::launch::async, ReadCode, "assets/shaders/base_vert.spv");
+		std::future<std::vector<char>> baseFragmentCode = std::async(std::launch::async, ReadCode, "assets/shaders/base_frag.spv");
+		std::future<std::vector<char>> cullComputeCode = std::async(std::launch::async, ReadCode, "assets/shaders/cull_comp.spv");
 
 		/*-----------------------------------------------*/
 		/* GLFW Setup									 */
 		/*-----------------------------------------------*/
 		glfwInit();
 		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-		glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+		glfwWindowHint(GLFW_VISIBLE, settings.hiddenWindow ? GLFW_FALSE : GLFW_TRUE);
 		window = glfwCreateWindow(screenWidth, screenHeight, title, nullptr, nullptr);
 		glfwSetWindowUserPointer(window, this);
 		glfwSetFramebufferSizeCallback(window, ResizeCallback);
+		glfwSetWindowRefreshCallback(window, RefreshCallback);
 
 		/*-----------------------------------------------*/
 		/* Vulkan Setup									 */
@@ -1051,7 +3777,7 @@ namespace VkExample
 			"VK_LAYER_KHRONOS_validation"
 		};
 
-		if (ENABLE_VALIDATION_LAYERS && !CheckValidationLayerSupport(validationLayers))
+		if (validationEnabled && !CheckValidationLayerSupport(validationLayers))
 		{
 			throw std::runtime_error("Some of the requested validation layers are not available.");
 		}
@@ -1063,6 +3789,13 @@ namespace VkExample
 			VK_EXT_SWAPCHAIN_COLOR_SPACE_EXTENSION_NAME
 		};
 
+		/*
+			VK_EXT_memory_budget needs vkGetPhysicalDeviceMemoryProperties2,
+			which a 1.0 instance only has through this extension.
+		*/
+		bool properties2Supported = CheckInstanceExtensionSupport({ VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME });
+		if (properties2Supported) instanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+
 		CreateInstance(title, validationLayers, instanceExtensions);
 
 		/* Surface --------------------------------------*/
@@ -1075,43 +3808,199 @@ namespace VkExample
 			VK_EXT_DEPTH_RANGE_UNRESTRICTED_EXTENSION_NAME
 		};
 
-		GetPhysicalDevice(deviceExtensions);
+		GetPhysicalDevice(deviceExtensions, properties2Supported, settings.device);
+
+		memoryBudgetSupported = properties2Supported && CheckDeviceExtensionSupport(physicalDevice, { VK_EXT_MEMORY_BUDGET_EXTENSION_NAME });
+		if (memoryBudgetSupported) deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+		/*
+			GPU culling draws through one multi-draw (or a draw count the GPU
+			fills in) when the device allows it, and one indirect draw per
+			chunk when it doesn't.
+		*/
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+		multiDrawIndirectSupported = supportedFeatures.multiDrawIndirect;
+
+		drawIndirectCountSupported = CheckDeviceExtensionSupport(physicalDevice, { VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME });
+		if (drawIndirectCountSupported) deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
+		CheckOptionalFeatures(properties2Supported, deviceExtensions);
+
 		CreateDevice(validationLayers, deviceExtensions);
+
+		cmdDrawIndirectCount = nullptr;
+		if (drawIndirectCountSupported)
+		{
+			cmdDrawIndirectCount = (PFN_vkCmdDrawIndirectCountKHR)vkGetDeviceProcAddr(device, "vkCmdDrawIndirectCountKHR");
+			drawIndirectCountSupported = cmdDrawIndirectCount != nullptr;
+		}
+
+		cmdBeginRendering = nullptr;
+		cmdEndRendering = nullptr;
+		if (dynamicRenderingSupported)
+		{
+			bool core = deviceApiVersion >= VK_API_VERSION_1_3;
+			cmdBeginRendering = (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(device, core ? "vkCmdBeginRendering" : "vkCmdBeginRenderingKHR");
+			cmdEndRendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(device, core ? "vkCmdEndRendering" : "vkCmdEndRenderingKHR");
+			dynamicRenderingSupported = cmdBeginRendering != nullptr && cmdEndRendering != nullptr;
+		}
+
+		waitSemaphores = nullptr;
+		getSemaphoreCounterValue = nullptr;
+		if (timelineSupported)
+		{
+			bool core = deviceApiVersion >= VK_API_VERSION_1_2;
+			waitSemaphores = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(device, core ? "vkWaitSemaphores" : "vkWaitSemaphoresKHR");
+			getSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(device, core ? "vkGetSemaphoreCounterValue" : "vkGetSemaphoreCounterValueKHR");
+			timelineSupported = waitSemaphores != nullptr && getSemaphoreCounterValue != nullptr;
+		}
+
+		queueSubmit2 = nullptr;
+		if (synchronization2Supported)
+		{
+			bool core = deviceApiVersion >= VK_API_VERSION_1_3;
+			queueSubmit2 = (PFN_vkQueueSubmit2KHR)vkGetDeviceProcAddr(device, core ? "vkQueueSubmit2" : "vkQueueSubmit2KHR");
+			synchronization2Supported = queueSubmit2 != nullptr;
+		}
+
+		waitForPresent = nullptr;
+		if (presentWaitSupported)
+		{
+			waitForPresent = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(device, "vkWaitForPresentKHR");
+			presentWaitSupported = waitForPresent != nullptr;
+		}
+
+		getPastPresentationTiming = nullptr;
+		if (displayTimingSupported)
+		{
+			getPastPresentationTiming = (PFN_vkGetPastPresentationTimingGOOGLE)vkGetDeviceProcAddr(device, "vkGetPastPresentationTimingGOOGLE");
+			displayTimingSupported = getPastPresentationTiming != nullptr;
+		}
+
 		GetGraphicsQueue();
 		GetPresentQueue();
 
-		/* SwapChain ------------------------------------*/
-		CreateSwapChain();
+		/* Memory ---------------------------------------*/
+		allocator = new MemoryAllocator(instance, physicalDevice, device, memoryBudgetSupported);
+		deletionQueue = new DeletionQueue(device, allocator);
 
-		/* Shaders --------------------------------------*/
-		Shader baseShader = Shader(device, "assets/shaders/base_vert.spv", "assets/shaders/base_frag.spv");
-		shaders["base"] = baseShader;
+		MarkStartupPhase("Startup: Device");
+
+		/*
+			Everything the pipelines are built against: the swap chain's
+			format (the swap chain itself can wait), the depth format, the
+			render graph's passes and the descriptor layout.
+		*/
+		/* Formats --------------------------------------*/
+		SwapChainSupportDetails swapChainSupport = GetSwapChainSupportDetails(physicalDevice);
+		swapChain.format = ChooseSwapSurfaceFormat(swapChainSupport.formats).format;
+		depthFormat = ChooseDepthFormat();
+		SetDepthTesting(depthFormat != VK_FORMAT_UNDEFINED);
 
-		/* Render Pass Setup ----------------------------*/
-		SetupRenderPasses();
+		if (dynamicResolution) dynamicResolution = CheckDynamicResolutionSupport();
+		if (damageTracking) damageTracking = CheckDamageTrackingSupport();
+		incrementalPresentSupported = incrementalPresentSupported && damageTracking;
+
+		/* Render Graph Setup ---------------------------*/
+		SetupRenderGraph();
 
 		/* Descriptor Layout Setup ----------------------*/
 		SetupDescriptorLayout();
 
+		/* Pipeline Cache -------------------------------*/
+		LoadPipelineCache();
+
+		MarkStartupPhase("Startup: Layouts");
+
+		/* Shaders --------------------------------------*/
+		Shader baseShader = Shader(device, baseVertexCode.get(), baseFragmentCode.get());
+		shaders["base"] = baseShader;
+
+		/*
+			GPU culling is optional: without a readable cull_comp.spv the
+			pipeline is never built and frames cull on the CPU.
+		*/
+		Shader cullShader;
+		bool cullShaderLoaded = false;
+		try
+		{
+			cullShader = Shader(device, cullComputeCode.get());
+			shaders["cull"] = cullShader;
+			cullShaderLoaded = true;
+		}
+		catch (const std::exception& e)
+		{
+			std::cout << "GPU culling unavailable: " << e.what() << std::endl;
+		}
+
+		MarkStartupPhase("Startup: Shaders");
+
 		/* Pipeline Setup -------------------------------*/
-		SetupPipeline(dynamicStates, baseShader);
+		/*
+			The pipelines compile on other threads while this one sets up
+			the swap chain, commands and buffers; none of that touches
+			what the pipelines are built from.
+		*/
+		std::future<void> pipelineBuild = std::async(std::launch::async, [this, dynamicStates, baseShader]()
+		{
+			SetupPipeline(dynamicStates, baseShader);
+		});
+
+		cullPipelineReady = false;
+		if (cullShaderLoaded)
+		{
+			cullPipelineBuild = std::async(std::launch::async, [this, cullShader]()
+			{
+				SetupCullPipeline(cullShader);
+			});
+		}
 
-		/* Render Pass Setup ----------------------------*/
-		SetupFramebuffers();
+		/* SwapChain ------------------------------------*/
+		CreateSwapChain(VK_NULL_HANDLE);
 
 		/* Command Pool & Buffer Setup ------------------*/
 		SetupCommands();
+		SetupTimestamps(settings.gpuTiming || dynamicResolution);
 
 		/* Buffer Setup ---------------------------------*/
 		SetupVertexBuffer();
 		SetupUniformBuffers();
+		CreateCullBuffers(INITIAL_CULL_CHUNKS);
+		SetupUploadBuffers();
+		SetupTransparentBuffers();
+
+		/* Descriptor Set Setup -------------------------*/
+		SetupDescriptorSets();
+
+		/* Memory Pressure Setup ------------------------*/
+		allocator->AddPressureHandler(MEMORY_CATEGORY_STAGING, [this](uint32_t heapIndex, VkDeviceSize bytesNeeded)
+		{
+			ShrinkStagingBuffer(heapIndex, bytesNeeded);
+		});
 
 		/* Synchronization Setup ------------------------*/
 		SetupSynchronization();
 
+		MarkStartupPhase("Startup: Resources");
+
+		/* Pipeline Join --------------------------------*/
+		pipelineBuild.get();
+
+		MarkStartupPhase("Startup: Pipelines");
+
+		/* Render Graph Images --------------------------*/
+		renderGraph->SetImages(swapChainTarget, swapChain.images, swapChain.imageViews);
+		renderGraph->Resize(swapChain.extent);
+
 		/* Camera Setup ---------------------------------*/
-		camera->UpdateProjection();
-		camera->UpdateView();
+		camera->SetViewportWidth((float)swapChain.extent.width);
+		camera->SetViewportHeight((float)swapChain.extent.height);
+
+		camera->SetScissorOffset({ 0, 0 });
+		camera->SetScissorExtent(swapChain.extent);
+
+		MarkStartupPhase("Startup: Frame Targets");
 	}
 
 	/*-----------------------------------------------------------------------*/
@@ -1119,39 +4008,57 @@ namespace VkExample
 	/*-----------------------------------------------------------------------*/
 	Renderer::~Renderer()
 	{
+		if (cullPipelineBuild.valid()) cullPipelineBuild.wait();
+		if (framePacer != nullptr) framePacer->SetPresentWait(nullptr);
+		vkDeviceWaitIdle(device);
+
+		SavePipelineCache();
+		vkDestroyPipelineCache(device, pipelineCache, nullptr);
+
 		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
 		{
 			vkDestroySemaphore(device, imagesAvailable[i], nullptr);
 			vkDestroySemaphore(device, rendersFinished[i], nullptr);
-			vkDestroyFence(device, inFlights[i], nullptr);
 		}
 
+		for (int i = 0; i < inFlights.size(); i++) vkDestroyFence(device, inFlights[i], nullptr);
+		if (frameTimeline != VK_NULL_HANDLE) vkDestroySemaphore(device, frameTimeline, nullptr);
+
 		vkDestroyCommandPool(device, commandPool, nullptr);
+		if (timestampPool != VK_NULL_HANDLE) vkDestroyQueryPool(device, timestampPool, nullptr);
 
-		for (int i = 0; i < framebuffers.size(); i++)
-		{
-			vkDestroyFramebuffer(device, framebuffers[i], nullptr);
-		}
+		DestroySwapChain();
 
 		vkDestroyPipeline(device, graphicsPipeline, nullptr);
+		vkDestroyPipeline(device, depthPipeline, nullptr);
+		vkDestroyPipeline(device, transparentPipeline, nullptr);
 		vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-		vkDestroyRenderPass(device, renderPass, nullptr);
-
-		for (int i = 0; i < swapChain.imageViews.size(); i++) vkDestroyImageView(device, swapChain.imageViews[i], nullptr);
-		vkDestroySwapchainKHR(device, swapChain.base, nullptr);
+		vkDestroyPipeline(device, cullPipeline, nullptr);
+		vkDestroyPipelineLayout(device, cullPipelineLayout, nullptr);
 
 		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
 		{
-			vkDestroyBuffer(device, uniformBuffers[i], nullptr);
-			vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
+			DestroyBuffer(uniformBuffers[i], uniformBuffersAllocation[i]);
 		}
 
+		vkDestroyDescriptorPool(device, descriptorPool, nullptr);
 		vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+		vkDestroyDescriptorSetLayout(device, cullDescriptorSetLayout, nullptr);
 
-		vkDestroyBuffer(device, vertexBuffer, nullptr);
-		vkFreeMemory(device, vertexBufferMemory, nullptr);
-		vkDestroyBuffer(device, stagingBuffer, nullptr);
-		vkFreeMemory(device, stagingBufferMemory, nullptr);
+		DestroyBuffer(vertexBuffer, vertexBufferAllocation);
+		DestroyCullBuffers();
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			if (uploadBuffers[i] != VK_NULL_HANDLE) DestroyBuffer(uploadBuffers[i], uploadBuffersAllocation[i]);
+		}
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) DestroyBuffer(transparentBuffers[i], transparentBuffersAllocation[i]);
+		if (stagingBuffer != VK_NULL_HANDLE) DestroyBuffer(stagingBuffer, stagingBufferAllocation);
+
+		delete(renderGraph);
+		delete(deletionQueue);
+		delete(allocator);
+		delete(culler);
+		delete(transparentSorter);
 
 		vkDestroyDevice(device, nullptr);
 		vkDestroySurfaceKHR(instance, surface, nullptr);
@@ -13,7 +13,10 @@
 #include <GLFW/glfw3.h>
 #include <set>
 #include <vector>
+#include <cfloat>
 #include <chrono>
+#include <cstring>
+#include <fstream>
 #include <string>
 #include <sstream>
 #include <iomanip>
@@ -22,19 +25,158 @@
 #include <cstdint>
 #include <limits>
 #include <algorithm>
+#include <atomic>
+#include <deque>
+#include <future>
+#include <numeric>
 #include <unordered_map>
 
+#include "../util/frame_pacer.h"
 #include "../util/polygons.h"
+#include "../util/profiler.h"
+#include "../util/radix_sort.h"
+#include "allocator.h"
 #include "camera.h"
+#include "culling.h"
+#include "deletion_queue.h"
+#include "render_graph.h"
 #include "shader.h"
 
 /*-------------------------------------------------------------------------------------------------*/
 /* Defines																						   */
 /*-------------------------------------------------------------------------------------------------*/
 
-#define MAX_TRIANGLES 1000000
 #define MAX_FRAMES_IN_FLIGHT 4
 #define ENABLE_VALIDATION_LAYERS 1
+#define MEMORY_BUDGET_INTERVAL 60
+
+/*
+	With ENABLE_GPU_CULLING, chunks are culled by cull.comp and drawn with
+	indirect draws instead of by the Culler on the CPU. The chunk and draw
+	buffers start with room for INITIAL_CULL_CHUNKS chunks and double.
+*/
+#define ENABLE_GPU_CULLING 1
+#define CULL_WORKGROUP_SIZE 64
+#define INITIAL_CULL_CHUNKS 256
+
+/*
+	With ENABLE_DEPTH_BUFFER, the frame gets a depth attachment and
+	opaque geometry is drawn with depth testing, nearest chunks first. A
+	lower z is nearer the camera.
+*/
+#define ENABLE_DEPTH_BUFFER 1
+
+/*
+	With ENABLE_DYNAMIC_RENDERING, graphics passes are drawn with
+	vkCmdBeginRendering when the device has it (Vulkan 1.3, or
+	VK_KHR_dynamic_rendering), instead of through render passes and
+	framebuffers.
+*/
+#define ENABLE_DYNAMIC_RENDERING 1
+
+/*
+	With ENABLE_TIMELINE_SEMAPHORES, frame completion is tracked on one
+	timeline semaphore instead of a fence per frame in flight, and with
+	ENABLE_SYNCHRONIZATION_2 frames are submitted with vkQueueSubmit2.
+	Each falls back to the older path when the device lacks it.
+*/
+#define ENABLE_TIMELINE_SEMAPHORES 1
+#define ENABLE_SYNCHRONIZATION_2 1
+
+/*
+	With ENABLE_PRESENT_TIMING, presents are given IDs so a FramePacer
+	can see when they finish (VK_KHR_present_wait) or reach the display
+	(VK_GOOGLE_display_timing), whichever the device has.
+*/
+#define ENABLE_PRESENT_TIMING 1
+
+/*
+	With ENABLE_ON_DEMAND_RENDERING, Render() only draws when something
+	on screen would change: the geometry, the camera, the window's size,
+	or the window being exposed. Otherwise it returns at once, and
+	WaitForEvents() blocks instead of polling.
+*/
+#define ENABLE_ON_DEMAND_RENDERING 0
+
+/*
+	With ENABLE_GPU_TIMING every frame's command buffer is bracketed by
+	timestamp queries, read back once the frame finishes. Off by default;
+	RendererSettings turns it on per renderer.
+*/
+#define ENABLE_GPU_TIMING 0
+
+/*
+	With ENABLE_DYNAMIC_RESOLUTION the scene is drawn offscreen at a
+	fraction of the window's resolution and scaled up to the swap chain.
+	The fraction follows a moving average of GPU frame time (so GPU
+	timing is turned on with it): it drops while frames take longer than
+	DYNAMIC_RESOLUTION_TARGET_MS and climbs back when there's headroom,
+	within the scale bounds. DYNAMIC_RESOLUTION_SMOOTHING is how much of
+	each new frame time goes into the average.
+*/
+#define ENABLE_DYNAMIC_RESOLUTION 0
+#define DYNAMIC_RESOLUTION_TARGET_MS 16.0
+#define DYNAMIC_RESOLUTION_MIN_SCALE 0.5f
+#define DYNAMIC_RESOLUTION_MAX_SCALE 1.0f
+#define DYNAMIC_RESOLUTION_SMOOTHING 0.1
+
+/*
+	With ENABLE_DAMAGE_TRACKING the scene is kept in a target of its own
+	from frame to frame, and a frame only clears and redraws the part
+	that changed: the union of its damage rectangles, by scissor. The
+	target is then copied to the swap chain image, and with
+	VK_KHR_incremental_present the present names only the rectangles.
+	Moving the camera, resizing or rescaling redraws everything. Past
+	DAMAGE_MAX_RECTS rectangles in a frame, new ones are merged into the
+	last.
+*/
+#define ENABLE_DAMAGE_TRACKING 0
+#define DAMAGE_MAX_RECTS 16
+
+/*
+	Setting DEVICE_OVERRIDE_ENV picks the physical device instead of the
+	scores (see RendererSettings::device). With LOG_DEVICE_SELECTION each
+	device's score, or why it was turned down, is printed at startup.
+*/
+#define DEVICE_OVERRIDE_ENV "VKEXAMPLE_DEVICE"
+#define LOG_DEVICE_SELECTION 1
+
+/*
+	Compiled pipelines are kept between runs in PIPELINE_CACHE_PATH, so
+	only the first start pays for compiling them. A cache from another
+	device or driver is ignored.
+*/
+#define PIPELINE_CACHE_PATH "vkexample_pipeline_cache.bin"
+
+/*
+	The most views (see Renderer::AddView()) drawn in a frame, the main
+	camera's included. Each has its own slice of the frame's uniform
+	buffer.
+*/
+#define MAX_VIEWS 4
+
+/*
+	Transparent geometry is drawn from its own per-frame vertex buffer,
+	which starts at INITIAL_TRANSPARENT_BUFFER_SIZE bytes and doubles.
+*/
+#define INITIAL_TRANSPARENT_BUFFER_SIZE (256ull * 1024)
+
+/*
+	Size of each frame's upload buffer, which bounds how much vertex data
+	QueueVertexUpload() takes per frame.
+*/
+#define UPLOAD_BUFFER_SIZE (8ull * 1024 * 1024)
+
+/*
+	The vertex buffer starts small and grows by VERTEX_BUFFER_GROWTH_FACTOR
+	whenever a write doesn't fit. MAX_VERTEX_BUFFER_SIZE caps it (in bytes);
+	0 means no cap.
+*/
+#define INITIAL_VERTEX_BUFFER_SIZE (256ull * 1024)
+#define VERTEX_BUFFER_GROWTH_FACTOR 2
+#define MAX_VERTEX_BUFFER_SIZE 0
+#define MIN_STAGING_BUFFER_SIZE (4ull * 1024 * 1024)
+#define MAX_STAGING_BUFFER_SIZE (64ull * 1024 * 1024)
 
 namespace VkExample
 {
@@ -77,6 +219,68 @@ namespace VkExample
 		std::vector<VkImageView> imageViews;
 	};
 
+	/*-----------------------------------------------------------------------*/
+	/* Renderer Settings													 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		Options fixed when the renderer is created. The defaults are what
+		the example runs with; the benchmark turns validation off, hides
+		the window and times the GPU.
+	*/
+	struct RendererSettings
+	{
+		bool validation = ENABLE_VALIDATION_LAYERS;
+		bool hiddenWindow = false;
+		bool gpuTiming = ENABLE_GPU_TIMING;
+
+		/*
+			A device name (any part of it, case doesn't matter) or device
+			UUID to use instead of the best-scoring device. Software
+			devices can only be picked this way. DEVICE_OVERRIDE_ENV, when
+			set, wins over this.
+		*/
+		std::string device;
+
+		/* See ENABLE_ON_DEMAND_RENDERING. */
+		bool onDemand = ENABLE_ON_DEMAND_RENDERING;
+
+		/* Dynamic resolution; see ENABLE_DYNAMIC_RESOLUTION. */
+		bool dynamicResolution = ENABLE_DYNAMIC_RESOLUTION;
+		double targetFrameMs = DYNAMIC_RESOLUTION_TARGET_MS;
+		float minRenderScale = DYNAMIC_RESOLUTION_MIN_SCALE;
+		float maxRenderScale = DYNAMIC_RESOLUTION_MAX_SCALE;
+
+		/* See ENABLE_DAMAGE_TRACKING. */
+		bool damageTracking = ENABLE_DAMAGE_TRACKING;
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* Startup Phase														 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		How long one step of the renderer's construction took on the
+		calling thread. Work running on other threads during a phase
+		isn't counted separately.
+	*/
+	struct StartupPhase
+	{
+		const char* name;
+		double ms;
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* Indirect Draw Header 												 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		Sits at the start of each indirect buffer, followed by the draw
+		commands. cull.comp bumps drawCount atomically as it appends.
+	*/
+	struct IndirectDrawHeader
+	{
+		uint32_t drawCount;
+		uint32_t padding[3];
+	};
+
 	/*-----------------------------------------------------------------------*/
 	/* Uniform Buffer Object 												 */
 	/*-----------------------------------------------------------------------*/
@@ -86,6 +290,28 @@ namespace VkExample
 		glm::vec2 atlasDimens;
 	};
 
+	/*-----------------------------------------------------------------------*/
+	/* Render View															 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		A camera drawn into part of the frame; its viewport and scissor
+		say which part. Every view draws from the same vertex buffer.
+		drawRanges is what the CPU culled for the view this frame. The
+		matrices, viewports and scissors are what it last showed and
+		where, for on-demand rendering and damage tracking.
+	*/
+	struct RenderView
+	{
+		Camera*					camera;
+		std::vector<DrawRange>	drawRanges;
+		glm::mat4				drawnViewProjection;
+		glm::mat4				damagedViewProjection;
+		VkViewport				drawnViewport;
+		VkRect2D				drawnScissor;
+		VkViewport				damagedViewport;
+		VkRect2D				damagedScissor;
+	};
+
 	/*---------------------------------------------------------------------------------------------*/
 	/* Renderer																					   */
 	/*---------------------------------------------------------------------------------------------*/
@@ -104,15 +330,48 @@ namespace VkExample
 		bool							windowResized;
 
 		/*-------------------------------------------------------------------*/
-		/* Camera															 */
+		/* On-Demand Rendering												 */
+		/*-------------------------------------------------------------------*/
+		/*
+			What the last frame drawn showed: the geometry (cullVersion),
+			anything else marked with MarkSceneChanged() (sceneRevision),
+			and each view's camera. redrawRequested may be set from any
+			thread.
+		*/
+		bool							onDemand;
+		uint64_t						sceneRevision;
+		uint64_t						drawnSceneRevision;
+		uint64_t						drawnCullVersion;
+		std::atomic<bool>				redrawRequested;
+
+		/*-------------------------------------------------------------------*/
+		/* Camera & Views													 */
 		/*-------------------------------------------------------------------*/
+		/*
+			views[0] is the main camera, the one the renderer was created
+			with, which always fills the window. The rest are drawn over it
+			in the order they were added.
+		*/
 		Camera* camera;
+		std::vector<RenderView>			views;
+
+		/*-------------------------------------------------------------------*/
+		/* Culling															 */
+		/*-------------------------------------------------------------------*/
+		Culler*							culler;
+		bool							gpuCulling;
+		bool							multiDrawIndirectSupported;
+		bool							drawIndirectCountSupported;
+		PFN_vkCmdDrawIndirectCountKHR	cmdDrawIndirectCount;
 
 		/*-------------------------------------------------------------------*/
 		/* Vulkan															 */
 		/*-------------------------------------------------------------------*/
 		VkInstance						instance;
 		VkSurfaceKHR					surface;
+		uint32_t						apiVersion;
+		uint32_t						deviceApiVersion;
+		bool							validationEnabled;
 
 		VkPhysicalDevice				physicalDevice;
 		VkDevice						device;
@@ -124,31 +383,194 @@ namespace VkExample
 		VkQueue							graphicsQueue;
 		VkQueue							presentQueue;
 
-		VkRenderPass					renderPass;
+		VkFormat						depthFormat;
+		bool							depthTesting;
 
 		VkDescriptorSetLayout			descriptorSetLayout;
+		VkDescriptorPool				descriptorPool;
+		std::vector<VkDescriptorSet>	descriptorSets;
 
 		VkPipeline						graphicsPipeline;
+		VkPipeline						depthPipeline;
+		VkPipeline						transparentPipeline;
 		VkPipelineLayout				pipelineLayout;
 
-		std::vector<VkFramebuffer>		framebuffers;
+		VkDescriptorSetLayout			cullDescriptorSetLayout;
+		std::vector<VkDescriptorSet>	cullDescriptorSets;
+		VkPipeline						cullPipeline;
+		VkPipelineLayout				cullPipelineLayout;
 
 		VkCommandPool					commandPool;
 		std::vector<VkCommandBuffer>	commandBuffers;
 
+		/*-------------------------------------------------------------------*/
+		/* Render Graph														 */
+		/*-------------------------------------------------------------------*/
+		RenderGraph*					renderGraph;
+		GraphResource					swapChainTarget;
+		GraphResource					sceneTarget;
+		GraphResource					depthTarget;
+		GraphResource					vertexBufferResource;
+		GraphResource					cullChunkResource;
+		GraphResource					indirectResource;
+		GraphPass						scenePass;
+		VkClearValue					clearColor;
+
+		bool							dynamicRenderingSupported;
+		PFN_vkCmdBeginRenderingKHR		cmdBeginRendering;
+		PFN_vkCmdEndRenderingKHR		cmdEndRendering;
+
+		/*-------------------------------------------------------------------*/
+		/* Memory															 */
+		/*-------------------------------------------------------------------*/
+		MemoryAllocator*				allocator;
+		DeletionQueue*					deletionQueue;
+		bool							memoryBudgetSupported;
+		unsigned int					budgetCountdown;
+
 		/*-------------------------------------------------------------------*/
 		/* Buffers															 */
 		/*-------------------------------------------------------------------*/
+		VkDeviceSize					vertexBufferSize;
+		unsigned int					vertexCount;
+		VkDeviceSize					stagingBufferSize;
+		VkDeviceSize					stagingBufferLimit;
+		bool							directVertexWrites;
+
 		VkBuffer						stagingBuffer;
-		VkDeviceMemory					stagingBufferMemory;
+		Allocation						stagingBufferAllocation;
+
+		/*
+			Staged writes fill the staging buffer from stagingOffset until
+			the next frame's Upload pass copies them out. stagingFrameValue
+			is the last frame that did, which has to finish before the
+			buffer is written again.
+		*/
+		VkDeviceSize					stagingOffset;
+		uint64_t						stagingFrameValue;
 
 		VkBuffer						vertexBuffer;
-		VkDeviceMemory					vertexBufferMemory;
+		Allocation						vertexBufferAllocation;
 
 		std::vector<VkBuffer>			uniformBuffers;
-		std::vector<VkDeviceMemory>		uniformBuffersMemory;
+		std::vector<Allocation>			uniformBuffersAllocation;
 		std::vector<void*>				uniformBuffersMapped;
 
+		/*
+			Each frame's uniform buffer holds MAX_VIEWS slices, one per view,
+			uniformStride bytes apart so each starts where the device allows
+			a dynamic offset to.
+		*/
+		VkDeviceSize					uniformStride;
+
+		uint32_t						cullChunkCapacity;
+		uint64_t						cullVersion;
+		std::vector<uint32_t>			cullChunkCounts;
+		std::vector<uint64_t>			cullChunkVersions;
+		std::vector<VkBuffer>			cullChunkBuffers;
+		std::vector<Allocation>			cullChunkBuffersAllocation;
+		std::vector<VkBuffer>			indirectBuffers;
+		std::vector<Allocation>			indirectBuffersAllocation;
+
+		/*
+			A copy into the vertex buffer waiting for the next frame's
+			Upload pass: queued or staged vertices, or what a grow kept from
+			the old buffer. Pending copies never overlap in the vertex
+			buffer, since each new write cuts its range out of the older
+			ones.
+		*/
+		struct VertexCopy
+		{
+			VkBuffer					source;
+			VkBufferCopy				region;
+		};
+
+		std::vector<VkBuffer>			uploadBuffers;
+		std::vector<Allocation>			uploadBuffersAllocation;
+		std::vector<VertexCopy>			pendingCopies;
+		bool							growCopiesPending;
+
+		/*
+			The vertex buffer each frame slot's last submission used, and
+			how many bytes from its start that submission drew or copied
+			into.
+		*/
+		std::vector<VkBuffer>			frameVertexBuffers;
+		std::vector<VkDeviceSize>		frameVertexExtents;
+		VkDeviceSize					uploadOffset;
+		bool							uploadBufferReady;
+		VkDeviceSize					uploadedBytes;
+
+		/*-------------------------------------------------------------------*/
+		/* Transparency														 */
+		/*-------------------------------------------------------------------*/
+		/*
+			What SubmitTransparent() was given this frame: the vertices,
+			one draw range and one sort key per item.
+		*/
+		std::vector<Vertex>				transparentVertices;
+		std::vector<DrawRange>			transparentItems;
+		std::vector<uint64_t>			transparentKeys;
+		std::vector<uint32_t>			transparentOrder;
+		RadixSorter*					transparentSorter;
+
+		std::vector<VkBuffer>			transparentBuffers;
+		std::vector<Allocation>			transparentBuffersAllocation;
+		std::vector<VkDeviceSize>		transparentBufferSizes;
+		uint32_t						transparentVertexCount;
+
+		/*-------------------------------------------------------------------*/
+		/* GPU Timing														 */
+		/*-------------------------------------------------------------------*/
+		/*
+			Two timestamps per frame slot, at the start and end of its
+			command buffer. gpuFrameMs is the newest frame read back, and
+			gpuFrameSamples counts how many have been.
+		*/
+		bool							gpuTiming;
+		VkQueryPool						timestampPool;
+		float							timestampPeriod;
+		uint64_t						timestampMask;
+		std::vector<bool>				timestampsWritten;
+		double							gpuFrameMs;
+		uint64_t						gpuFrameSamples;
+
+		/*-------------------------------------------------------------------*/
+		/* Dynamic Resolution												 */
+		/*-------------------------------------------------------------------*/
+		/*
+			The scene target is allocated at the swap chain's extent, and
+			the scene drawn to renderScale of it, so changing the scale
+			never reallocates anything.
+		*/
+		bool							dynamicResolution;
+		float							renderScale;
+		float							minRenderScale;
+		float							maxRenderScale;
+		double							targetFrameMs;
+		double							gpuFrameAverageMs;
+		uint64_t						scaledSamples;
+
+		/*-------------------------------------------------------------------*/
+		/* Damage Tracking													 */
+		/*-------------------------------------------------------------------*/
+		/*
+			damage holds the world-space boxes that changed since the last
+			frame; fullDamage says everything did. Transparent geometry only
+			lasts a frame, so the box around what was drawn is damaged again
+			in the next. Each frame's damage is worked out into damageRect,
+			in scene target pixels, and presentRects, in swap chain pixels.
+		*/
+		bool							damageTracking;
+		bool							incrementalPresentSupported;
+		bool							fullDamage;
+		std::vector<ViewBounds>			damage;
+		ViewBounds						transparentBounds;
+		ViewBounds						drawnTransparentBounds;
+		VkExtent2D						damagedExtent;
+		VkRect2D						damageRect;
+		std::vector<VkRectLayerKHR>		presentRects;
+
 		/*-------------------------------------------------------------------*/
 		/* Synchronization Objects											 */
 		/*-------------------------------------------------------------------*/
@@ -156,11 +578,65 @@ namespace VkExample
 		std::vector<VkSemaphore>		rendersFinished;
 		std::vector<VkFence>			inFlights;
 
+		/*
+			Every submit signals the next frame value: on frameTimeline
+			with timeline semaphores, and through its slot's fence without.
+			frameValues holds each slot's last value, and
+			completedFrameValue the newest one known to have finished.
+		*/
+		VkSemaphore						frameTimeline;
+		uint64_t						submittedFrameValue;
+		uint64_t						completedFrameValue;
+		std::vector<uint64_t>			frameValues;
+
+		bool							timelineSupported;
+		bool							synchronization2Supported;
+		PFN_vkWaitSemaphoresKHR			waitSemaphores;
+		PFN_vkGetSemaphoreCounterValueKHR	getSemaphoreCounterValue;
+		PFN_vkQueueSubmit2KHR			queueSubmit2;
+
+		/*-------------------------------------------------------------------*/
+		/* Present Timing													 */
+		/*-------------------------------------------------------------------*/
+		/*
+			Every present gets the next presentCount as its ID. Presents
+			whose finish hasn't been seen yet wait in pendingPresents with
+			the time their frame started, which is what latency is
+			measured from.
+		*/
+		struct PendingPresent
+		{
+			uint64_t					id;
+			uint64_t					frameStart;
+		};
+
+		bool							presentWaitSupported;
+		bool							displayTimingSupported;
+		PFN_vkWaitForPresentKHR			waitForPresent;
+		PFN_vkGetPastPresentationTimingGOOGLE	getPastPresentationTiming;
+		uint64_t						presentCount;
+		std::deque<PendingPresent>		pendingPresents;
+		FramePacer*						framePacer;
+
 		/*-------------------------------------------------------------------*/
 		/* Shaders															 */
 		/*-------------------------------------------------------------------*/
 		std::unordered_map<std::string, Shader>	shaders;
 
+		/*-------------------------------------------------------------------*/
+		/* Startup															 */
+		/*-------------------------------------------------------------------*/
+		/*
+			The cull pipeline is optional (the CPU culls without it), so
+			it is left compiling when the constructor returns; frames cull
+			on the CPU until it is ready.
+		*/
+		std::vector<StartupPhase>		startupPhases;
+		uint64_t						startupMark;
+		VkPipelineCache					pipelineCache;
+		std::future<void>				cullPipelineBuild;
+		bool							cullPipelineReady;
+
 		/*-------------------------------------------------------------------*/
 		/* Vulkan Setup Functions											 */
 		/*-------------------------------------------------------------------*/
@@ -169,6 +645,7 @@ namespace VkExample
 
 		/* Instance Setup ---------------------------------------------------*/
 		std::vector<const char*>		GetRequiredExtensions();
+		bool							CheckInstanceExtensionSupport(std::vector<const char*> instanceExtensions);
 		void							CreateInstance(	std::string name,
 														std::vector<const char*> validationLayers,
 														std::vector<const char*> instanceExtensions);
@@ -182,9 +659,14 @@ namespace VkExample
 		bool							CheckDeviceExtensionSupport(VkPhysicalDevice potentiate,
 																	std::vector<const char*> deviceExtensions);
 		bool							CheckPhysicalDeviceSuitability(	VkPhysicalDevice potentiate,
-																		std::vector<const char*> deviceExtensions);
-		int								RatePhysicalDevice(VkPhysicalDevice potentiate);
-		void							GetPhysicalDevice(std::vector<const char*> deviceExtensions);
+																		std::vector<const char*> deviceExtensions,
+																		std::string& reason);
+		int								RatePhysicalDevice(VkPhysicalDevice potentiate, std::string& reasons);
+		std::string						GetDeviceUUID(VkPhysicalDevice potentiate, PFN_vkGetPhysicalDeviceProperties2 getProperties2);
+		bool							MatchDeviceOverride(VkPhysicalDevice potentiate, std::string uuid, std::string deviceOverride);
+		void							GetPhysicalDevice(	std::vector<const char*> deviceExtensions, bool properties2Supported,
+															std::string deviceOverride);
+		void							CheckOptionalFeatures(bool properties2Supported, std::vector<const char*>& deviceExtensions);
 		void							CreateDevice(	std::vector<const char*> validationLayers,
 														std::vector<const char*> deviceExtensions);
 		void							GetGraphicsQueue();
@@ -194,26 +676,56 @@ namespace VkExample
 		VkSurfaceFormatKHR				ChooseSwapSurfaceFormat(std::vector<VkSurfaceFormatKHR>& availableFormats);
 		VkPresentModeKHR				ChooseSwapPresentMode(std::vector<VkPresentModeKHR>& availableModes);
 		VkExtent2D						ChooseSwapExtent(VkSurfaceCapabilitiesKHR& capabilities);
-		void							CreateSwapChain();
+		void							CreateSwapChain(VkSwapchainKHR oldSwapChain);
+		void							DestroySwapChain();
+		void							RecreateSwapChain();
 
-		/* Framebuffers Setup -----------------------------------------------*/
-		void							SetupFramebuffers();
+		/* Depth Setup ------------------------------------------------------*/
+		VkFormat						ChooseDepthFormat();
 
-		/* Render Passes Setup ----------------------------------------------*/
-		void							SetupRenderPasses();
+		/* Render Graph Setup -----------------------------------------------*/
+		void							SetupRenderGraph();
 
 		/* Descriptor Layout Setup ------------------------------------------*/
 		void							SetupDescriptorLayout();
 
+		/* Descriptor Set Setup ---------------------------------------------*/
+		void							SetupDescriptorSets();
+		void							WriteDescriptorSets();
+
 		/* Pipeline Setup ---------------------------------------------------*/
 		void							SetupPipeline(std::vector<VkDynamicState> dynamicStates, Shader baseShader);
+		void							SetupCullPipeline(Shader cullShader);
+		void							LoadPipelineCache();
+		void							SavePipelineCache();
+		void							PollCullPipeline();
+		bool							GetGpuCullingActive() { return gpuCulling && cullPipelineReady; }
+
+		/* Startup ----------------------------------------------------------*/
+		void							MarkStartupPhase(const char* name);
 
 		/* Buffer Setup -----------------------------------------------------*/
-		unsigned int					FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
-		void							CopyBuffer(VkBuffer src, VkBuffer dst, unsigned int size);
-		void							CreateBuffer(unsigned int size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+		void							CopyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset);
+		void							CreateBuffer(	VkDeviceSize size, VkBufferUsageFlags usage,
+														VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+														MemoryCategory category, VkBuffer& buffer, Allocation& allocation);
+		void							DestroyBuffer(VkBuffer& buffer, Allocation& allocation);
+		void							ResizeStagingBuffer(VkDeviceSize size);
+		void							CreateVertexBuffer(VkDeviceSize size, VkBuffer& buffer, Allocation& allocation);
+		void							GrowVertexBuffer(VkDeviceSize required, VkDeviceSize preserve);
+		void							ClipVertexCopies(std::vector<VertexCopy>& copies, VkDeviceSize start, VkDeviceSize end);
+		bool							QueueUpload(const void* data, VkDeviceSize size, VkDeviceSize dstOffset);
+		VkDeviceSize					GetVertexBytesInFlight();
+		void							StageVertexWrite(const void* data, VkDeviceSize size, VkDeviceSize dstOffset);
+		void							FlushVertexCopies();
 		void							SetupVertexBuffer();
 		void							SetupUniformBuffers();
+		void							CreateCullBuffers(uint32_t capacity);
+		void							DestroyCullBuffers();
+		void							WriteCullChunks();
+		void							SetupUploadBuffers();
+		void							SetupTransparentBuffers();
+		void							WriteTransparentVertices();
 
 		/* Commands Setup ---------------------------------------------------*/
 		void							SetupCommands();
@@ -221,9 +733,55 @@ namespace VkExample
 		/* Synchronization Setup --------------------------------------------*/
 		void							SetupSynchronization();
 
+		/*-------------------------------------------------------------------*/
+		/* Memory Pressure Functions										 */
+		/*-------------------------------------------------------------------*/
+		void							ShrinkStagingBuffer(uint32_t heapIndex, VkDeviceSize bytesNeeded);
+
+		/*-------------------------------------------------------------------*/
+		/* GPU Timing Functions												 */
+		/*-------------------------------------------------------------------*/
+		void							SetupTimestamps(bool enabled);
+		void							ReadTimestamps();
+
+		/* Dynamic Resolution -----------------------------------------------*/
+		bool							CheckDynamicResolutionSupport();
+		void							UpdateRenderScale();
+
+		/* Damage Tracking --------------------------------------------------*/
+		bool							CheckDamageTrackingSupport();
+		void							PushDamage(ViewBounds bounds);
+		void							DamageChunks(uint32_t firstChunk, uint32_t lastChunk);
+		void							UpdateDamage();
+		VkRect2D						ProjectDamage(ViewBounds bounds, glm::mat4 viewProjection, VkViewport viewport, VkRect2D clip);
+
+		/*-------------------------------------------------------------------*/
+		/* Frame Completion Functions										 */
+		/*-------------------------------------------------------------------*/
+		void							SubmitFrame();
+		void							WaitForFrameValue(uint64_t value);
+		void							WaitForFrame(unsigned int frameIndex);
+		void							WaitForAllFrames();
+
+		/*-------------------------------------------------------------------*/
+		/* Present Timing Functions											 */
+		/*-------------------------------------------------------------------*/
+		bool							WaitForPresent(uint64_t timeoutNs);
+		void							ReadPresentTimings();
+
 		/*-------------------------------------------------------------------*/
 		/* Command Functions												 */
 		/*-------------------------------------------------------------------*/
+		void							RecordUploadCommands(VkCommandBuffer commandBuffer);
+		void							RecordVertexCopies(VkCommandBuffer commandBuffer);
+		void							RecordIndirectResetCommands(VkCommandBuffer commandBuffer);
+		void							RecordCullCommands(VkCommandBuffer commandBuffer);
+		void							RecordSceneCommands(VkCommandBuffer commandBuffer);
+		void							RecordViewCommands(VkCommandBuffer commandBuffer, uint32_t viewIndex);
+		void							GetSceneViewport(Camera* viewCamera, VkViewport& viewport, VkRect2D& scissor);
+		VkRect2D						IntersectRects(VkRect2D a, VkRect2D b);
+		bool							SameViewRect(Camera* viewCamera, VkViewport viewport, VkRect2D scissor);
+		void							RecordUpscaleCommands(VkCommandBuffer commandBuffer);
 		void							RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 
 	public:
@@ -236,8 +794,91 @@ namespace VkExample
 		/* Buffer Functions													 */
 		/*-------------------------------------------------------------------*/
 		void							WriteVertices(Vertex* vertices, unsigned int nVertices);
-		void							WriteVertexBuffer(Vertex* vertices, unsigned int nVertices);
-		void							WriteUniformBuffer(uint32_t imageIndex);
+		void							WriteVertexBuffer(Vertex* vertices, unsigned int nVertices, unsigned int firstVertex);
+		void							ReserveVertexBuffer(unsigned int nVertices);
+		bool							QueueVertexUpload(Vertex* vertices, unsigned int nVertices, unsigned int firstVertex);
+		void							HideVertexRange(unsigned int firstVertex, unsigned int nVertices);
+		void							SubmitTransparent(const Vertex* vertices, unsigned int nVertices, uint16_t layer);
+		unsigned int					GetVertexCount() { return vertexCount; }
+		VkDeviceSize					GetUploadedBytes() { return uploadedBytes; }
+		VkDeviceSize					GetVertexBufferSize() { return vertexBufferSize; }
+		void							WriteUniformBuffer(uint32_t frameIndex);
+
+		/*-------------------------------------------------------------------*/
+		/* Culling Functions												 */
+		/*-------------------------------------------------------------------*/
+		CullStats						GetCullStats();
+		void							SetGpuCulling(bool v) { gpuCulling = v; }
+		bool							GetGpuCulling() { return gpuCulling; }
+
+		/*-------------------------------------------------------------------*/
+		/* View Functions													 */
+		/*-------------------------------------------------------------------*/
+		void							AddView(Camera* viewCamera);
+		void							RemoveView(Camera* viewCamera);
+		uint32_t						GetViewCount() { return (uint32_t)views.size(); }
+
+		/*-------------------------------------------------------------------*/
+		/* Depth Functions													 */
+		/*-------------------------------------------------------------------*/
+		void							SetDepthTesting(bool v);
+		bool							GetDepthTesting() { return depthTesting; }
+		bool							GetDepthBufferSupported() { return depthFormat != VK_FORMAT_UNDEFINED; }
+
+		/*-------------------------------------------------------------------*/
+		/* Rendering Functions												 */
+		/*-------------------------------------------------------------------*/
+		bool							GetDynamicRenderingSupported() { return dynamicRenderingSupported; }
+		bool							GetTimelineSupported() { return timelineSupported; }
+		bool							GetSynchronization2Supported() { return synchronization2Supported; }
+		bool							GetPresentWaitSupported() { return presentWaitSupported; }
+		bool							GetDisplayTimingSupported() { return displayTimingSupported; }
+
+		/*-------------------------------------------------------------------*/
+		/* Frame Pacing Functions											 */
+		/*-------------------------------------------------------------------*/
+		void							SetFramePacer(FramePacer* pacer);
+
+		/*-------------------------------------------------------------------*/
+		/* Frame Completion Functions										 */
+		/*-------------------------------------------------------------------*/
+		uint64_t						GetSubmittedFrameValue() { return submittedFrameValue; }
+		uint64_t						GetCompletedFrameValue();
+
+		/*-------------------------------------------------------------------*/
+		/* GPU Timing Functions												 */
+		/*-------------------------------------------------------------------*/
+		bool							GetGpuTiming() { return gpuTiming; }
+		double							GetGpuFrameMs() { return gpuFrameMs; }
+		uint64_t						GetGpuFrameSamples() { return gpuFrameSamples; }
+
+		/*-------------------------------------------------------------------*/
+		/* Dynamic Resolution Functions										 */
+		/*-------------------------------------------------------------------*/
+		bool							GetDynamicResolution() { return dynamicResolution; }
+		float							GetRenderScale() { return renderScale; }
+		VkExtent2D						GetRenderExtent();
+
+		/*-------------------------------------------------------------------*/
+		/* Damage Tracking Functions										 */
+		/*-------------------------------------------------------------------*/
+		bool							GetDamageTracking() { return damageTracking; }
+		bool							GetIncrementalPresentSupported() { return incrementalPresentSupported; }
+		VkRect2D						GetDamageRect() { return damageRect; }
+		void							AddDamage(glm::vec2 min, glm::vec2 max);
+
+		/*-------------------------------------------------------------------*/
+		/* Startup Functions												 */
+		/*-------------------------------------------------------------------*/
+		const std::vector<StartupPhase>&	GetStartupPhases() { return startupPhases; }
+
+		/*-------------------------------------------------------------------*/
+		/* Memory Functions													 */
+		/*-------------------------------------------------------------------*/
+		AllocatorStats					GetMemoryStats() { return allocator->GetStats(); }
+		MemoryBudget					GetMemoryBudget() { return allocator->GetBudget(); }
+		std::string						GetMemoryReport();
+		VkDeviceSize					DefragmentMemory();
 
 		/*-------------------------------------------------------------------*/
 		/* Window Functions													 */
@@ -245,10 +886,22 @@ namespace VkExample
 		void							SetWindowResized(bool v) { windowResized = v; }
 		GLFWwindow*						GetWindow() { return window; }
 
+		/*-------------------------------------------------------------------*/
+		/* On-Demand Functions												 */
+		/*-------------------------------------------------------------------*/
+		bool							GetOnDemand() { return onDemand; }
+		void							SetOnDemand(bool v) { onDemand = v; RequestRedraw(); }
+		uint64_t						GetSceneRevision() { return sceneRevision; }
+		void							MarkSceneChanged() { sceneRevision++; fullDamage = true; }
+		void							RequestRedraw();
+		bool							NeedsRedraw();
+		void							WaitForEvents(double timeoutSeconds);
+
 		/*-------------------------------------------------------------------*/
 		/* Constructor														 */
 		/*-------------------------------------------------------------------*/
-		Renderer(std::vector<VkDynamicState> dynamicStates, int screenWidth, int screenHeight, const char* title, Camera* camera);
+		Renderer(	std::vector<VkDynamicState> dynamicStates, int screenWidth, int screenHeight, const char* title, Camera* camera,
+					RendererSettings settings = RendererSettings());
 
 		/*-------------------------------------------------------------------*/
 		/* Deconstructor													 */
@@ -267,6 +920,18 @@ namespace VkExample
 		Renderer* r = reinterpret_cast<Renderer*>(glfwGetWindowUserPointer(window));
 		r->SetWindowResized(true);
 	}
+
+	/*---------------------------------------------------*/
+	/* Refresh Callback									 */
+	/*---------------------------------------------------*/
+	/*
+		The window was exposed (uncovered, restored) and wants drawing.
+	*/
+	static void RefreshCallback(GLFWwindow* window)
+	{
+		Renderer* r = reinterpret_cast<Renderer*>(glfwGetWindowUserPointer(window));
+		r->RequestRedraw();
+	}
 }
 
 #endif
\ No newline at end of file
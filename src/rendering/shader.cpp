@@ -83,9 +83,19 @@ namespace VkExample
 	Shader::Shader() {};
 
 	Shader::Shader(VkDevice device, std::string vertexPath, std::string fragmentPath)
+		: Shader(device, ReadCode(vertexPath.c_str()), ReadCode(fragmentPath.c_str())) {}
+
+	Shader::Shader(VkDevice device, std::string computePath)
+		: Shader(device, ReadCode(computePath.c_str())) {}
+
+	/*
+		From code that has already been read, so the file reads can happen
+		elsewhere (on another thread, during startup).
+	*/
+	Shader::Shader(VkDevice device, std::vector<char> vertexCode, std::vector<char> fragmentCode)
 	{
-		VkShaderModule vertexModule = CreateShaderModule(device, ReadCode(vertexPath.c_str()));
-		VkShaderModule fragmentModule = CreateShaderModule(device, ReadCode(fragmentPath.c_str()));
+		VkShaderModule vertexModule = CreateShaderModule(device, vertexCode);
+		VkShaderModule fragmentModule = CreateShaderModule(device, fragmentCode);
 
 		VkPipelineShaderStageCreateInfo vertexStageInfo{};
 		vertexStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -104,4 +114,18 @@ namespace VkExample
 		modules.push_back(vertexModule);
 		modules.push_back(fragmentModule);
 	}
+
+	Shader::Shader(VkDevice device, std::vector<char> computeCode)
+	{
+		VkShaderModule computeModule = CreateShaderModule(device, computeCode);
+
+		VkPipelineShaderStageCreateInfo computeStageInfo{};
+		computeStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		computeStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		computeStageInfo.module = computeModule;
+		computeStageInfo.pName = "main";
+
+		stages.push_back(computeStageInfo);
+		modules.push_back(computeModule);
+	}
 }
\ No newline at end of file
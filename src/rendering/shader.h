@@ -23,7 +23,7 @@ namespace VkExample
 	/* Utility Functions																		   */
 	/*---------------------------------------------------------------------------------------------*/
 	std::vector<char> ReadCode(const char* path);
-	VkShaderModule CreateShaderModule(VkDevice device, std::string code);
+	VkShaderModule CreateShaderModule(VkDevice device, std::vector<char> code);
 
 	/*---------------------------------------------------------------------------------------------*/
 	/* Shader																					   */
@@ -57,6 +57,9 @@ namespace VkExample
 		/*-------------------------------------------------------------------*/
 		Shader();
 		Shader(VkDevice device, std::string vertexPath, std::string fragmentPath);
+		Shader(VkDevice device, std::string computePath);
+		Shader(VkDevice device, std::vector<char> vertexCode, std::vector<char> fragmentCode);
+		Shader(VkDevice device, std::vector<char> computeCode);
 	};
 }
 
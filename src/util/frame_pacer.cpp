@@ -0,0 +1,176 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Frame_Pacer.cpp																										 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "frame_pacer.h"
+#include "profiler.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Frame Pacer																				   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Pacing Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Wait -----------------------------------------------------------------*/
+	void FramePacer::Wait()
+	{
+		PROFILE_SCOPE("FramePacer");
+
+		if (intervalNs > 0)
+		{
+			uint64_t now = Profiler::Now();
+
+			/* More than a frame behind: start over rather than catch up. */
+			if (deadline == 0 || now > deadline + intervalNs) deadline = now;
+
+			if (presentWait && now < deadline) presentWait(deadline - now);
+			SleepUntil(deadline);
+
+			deadline += intervalNs;
+		}
+
+		uint64_t now = Profiler::Now();
+		if (frameStart != 0) Push(frameIntervals, frameCount, now - frameStart);
+		frameStart = now;
+	}
+
+	/* Set Target Frame Rate ------------------------------------------------*/
+	void FramePacer::SetTargetFrameRate(double framesPerSecond)
+	{
+		targetFrameRate = std::max(framesPerSecond, 0.0);
+		intervalNs = targetFrameRate > 0.0 ? (uint64_t)(1000000000.0 / targetFrameRate) : 0;
+		deadline = 0;
+	}
+
+	/* Sleep Until ----------------------------------------------------------*/
+	/*
+		Sleeps while there's more than FRAME_PACER_SPIN_NS to go, then
+		spins, yielding, to the deadline.
+	*/
+	void FramePacer::SleepUntil(uint64_t time)
+	{
+		uint64_t now = Profiler::Now();
+		while (now + FRAME_PACER_SPIN_NS < time)
+		{
+			std::this_thread::sleep_for(std::chrono::nanoseconds(time - now - FRAME_PACER_SPIN_NS));
+			now = Profiler::Now();
+		}
+
+		while (Profiler::Now() < time) std::this_thread::yield();
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Present Functions													 */
+	/*-----------------------------------------------------------------------*/
+	/* Record Present -------------------------------------------------------*/
+	/*
+		When a present reached the display, or was seen to. Only the
+		intervals between them are kept, so any clock will do as long as
+		it's always the same one.
+	*/
+	void FramePacer::RecordPresent(uint64_t presentTime)
+	{
+		if (lastPresent != 0 && presentTime > lastPresent) Push(presentIntervals, presentCount, presentTime - lastPresent);
+		lastPresent = presentTime;
+	}
+
+	/* Record Latency -------------------------------------------------------*/
+	void FramePacer::RecordLatency(uint64_t latencyNs)
+	{
+		Push(latencies, latencyCount, latencyNs);
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Stats Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Get Stats ------------------------------------------------------------*/
+	FramePacerStats FramePacer::GetStats()
+	{
+		FramePacerStats stats{};
+		stats.targetMs = intervalNs / 1000000.0;
+
+		std::vector<double> frames = Snapshot(frameIntervals, frameCount);
+		if (!frames.empty())
+		{
+			stats.frameP50Ms = frames[frames.size() / 2];
+			stats.frameP99Ms = frames[std::min(frames.size() - 1, frames.size() * 99 / 100)];
+		}
+
+		std::vector<double> presents = Snapshot(presentIntervals, presentCount);
+		stats.presentSamples = presents.size();
+		if (!presents.empty())
+		{
+			double sum = 0.0;
+			for (int i = 0; i < presents.size(); i++) sum += presents[i];
+			stats.presentMeanMs = sum / presents.size();
+
+			double variance = 0.0;
+			for (int i = 0; i < presents.size(); i++) variance += (presents[i] - stats.presentMeanMs) * (presents[i] - stats.presentMeanMs);
+			stats.presentJitterMs = sqrt(variance / presents.size());
+		}
+
+		std::vector<double> latency = Snapshot(latencies, latencyCount);
+		stats.latencySamples = latency.size();
+		if (!latency.empty())
+		{
+			double sum = 0.0;
+			for (int i = 0; i < latency.size(); i++) sum += latency[i];
+			stats.latencyMeanMs = sum / latency.size();
+			stats.latencyP99Ms = latency[std::min(latency.size() - 1, latency.size() * 99 / 100)];
+		}
+
+		return stats;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Helpers																 */
+	/*-----------------------------------------------------------------------*/
+	/* Push -----------------------------------------------------------------*/
+	void FramePacer::Push(std::vector<uint64_t>& ring, uint64_t& count, uint64_t value)
+	{
+		ring[count % FRAME_PACER_HISTORY] = value;
+		count++;
+	}
+
+	/* Snapshot -------------------------------------------------------------*/
+	/*
+		The ring's samples in milliseconds, sorted.
+	*/
+	std::vector<double> FramePacer::Snapshot(const std::vector<uint64_t>& ring, uint64_t count)
+	{
+		size_t n = (size_t)std::min<uint64_t>(count, FRAME_PACER_HISTORY);
+
+		std::vector<double> samples(n);
+		for (int i = 0; i < n; i++) samples[i] = ring[i] / 1000000.0;
+		std::sort(samples.begin(), samples.end());
+		return samples;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Constructor															 */
+	/*-----------------------------------------------------------------------*/
+	FramePacer::FramePacer(double targetFrameRate)
+	{
+		this->frameStart = 0;
+		this->frameCount = 0;
+		this->presentCount = 0;
+		this->latencyCount = 0;
+		this->lastPresent = 0;
+		this->frameIntervals.resize(FRAME_PACER_HISTORY);
+		this->presentIntervals.resize(FRAME_PACER_HISTORY);
+		this->latencies.resize(FRAME_PACER_HISTORY);
+
+		SetTargetFrameRate(targetFrameRate);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Frame_Pacer.h																										 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Defines																						   */
+/*-------------------------------------------------------------------------------------------------*/
+
+/*
+	The wait sleeps until FRAME_PACER_SPIN_NS before the deadline, then
+	spins the rest: sleeps overshoot by up to a scheduler tick, which is
+	what judders. FRAME_PACER_HISTORY is how many frames and presents the
+	statistics cover.
+*/
+#define FRAME_PACER_SPIN_NS 2000000
+#define FRAME_PACER_HISTORY 1024
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Helper Structs																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Frame Pacer Stats													 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		All in milliseconds. Present intervals come from the display
+		(VK_GOOGLE_display_timing) or from when presents were seen to
+		finish (VK_KHR_present_wait); jitter is their standard deviation.
+		Latency, from a frame starting to its present finishing, is only
+		known with present wait, since display timing uses another clock.
+		Without either the present fields are 0.
+	*/
+	struct FramePacerStats
+	{
+		double			targetMs;
+		double			frameP50Ms;
+		double			frameP99Ms;
+		double			presentMeanMs;
+		double			presentJitterMs;
+		double			latencyMeanMs;
+		double			latencyP99Ms;
+		size_t			presentSamples;
+		size_t			latencySamples;
+	};
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Frame Pacer																				   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		Holds the main loop to a target frame rate. Wait() is called once
+		per frame, before the frame's work; it returns at the target
+		interval after the last frame started. Deadlines advance by the
+		interval rather than from when Wait() returned, so one late frame
+		doesn't push every later one back, unless it is more than a whole
+		frame late.
+
+		A target of 0 runs uncapped; Wait() only records the frame.
+
+		Given a present wait (see SetPresentWait()), the first part of the
+		wait is spent in it instead of sleeping, so a frame doesn't start
+		while the display is still behind.
+	*/
+	class FramePacer
+	{
+	private:
+		/*-------------------------------------------------------------------*/
+		/* Pacing															 */
+		/*-------------------------------------------------------------------*/
+		double							targetFrameRate;
+		uint64_t						intervalNs;
+		uint64_t						deadline;
+		uint64_t						frameStart;
+		std::function<bool(uint64_t)>	presentWait;
+
+		/*-------------------------------------------------------------------*/
+		/* History															 */
+		/*-------------------------------------------------------------------*/
+		/*
+			Rings of the last FRAME_PACER_HISTORY samples, in nanoseconds.
+		*/
+		std::vector<uint64_t>			frameIntervals;
+		std::vector<uint64_t>			presentIntervals;
+		std::vector<uint64_t>			latencies;
+		uint64_t						frameCount;
+		uint64_t						presentCount;
+		uint64_t						latencyCount;
+		uint64_t						lastPresent;
+
+		/*-------------------------------------------------------------------*/
+		/* Helpers															 */
+		/*-------------------------------------------------------------------*/
+		void							Push(std::vector<uint64_t>& ring, uint64_t& count, uint64_t value);
+		std::vector<double>				Snapshot(const std::vector<uint64_t>& ring, uint64_t count);
+		void							SleepUntil(uint64_t time);
+
+	public:
+		/*-------------------------------------------------------------------*/
+		/* Pacing Functions													 */
+		/*-------------------------------------------------------------------*/
+		void							Wait();
+		void							SetTargetFrameRate(double framesPerSecond);
+		double							GetTargetFrameRate() { return targetFrameRate; }
+		uint64_t						GetFrameStart() { return frameStart; }
+
+		/*
+			wait(timeoutNs) blocks until the last present finishes or the
+			timeout passes, and says whether it finished.
+		*/
+		void							SetPresentWait(std::function<bool(uint64_t)> wait) { presentWait = wait; }
+
+		/*-------------------------------------------------------------------*/
+		/* Present Functions												 */
+		/*-------------------------------------------------------------------*/
+		void							RecordPresent(uint64_t presentTime);
+		void							RecordLatency(uint64_t latencyNs);
+
+		/*-------------------------------------------------------------------*/
+		/* Stats Functions													 */
+		/*-------------------------------------------------------------------*/
+		FramePacerStats					GetStats();
+
+		/*-------------------------------------------------------------------*/
+		/* Constructor														 */
+		/*-------------------------------------------------------------------*/
+		FramePacer(double targetFrameRate);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,297 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Profiler.cpp																											 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "profiler.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Profiler State																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		The rings are owned here rather than by their threads so that events
+		recorded on a thread which has since exited can still be exported.
+		The mutex is only taken when a thread records for the first time
+		and when somebody reads the rings back.
+	*/
+	static const std::chrono::steady_clock::time_point		profilerEpoch = std::chrono::steady_clock::now();
+
+	static std::mutex										ringsMutex;
+	static std::vector<std::unique_ptr<ProfileRing>>		rings;
+	static thread_local ProfileRing*						threadRing = nullptr;
+
+	static std::atomic<uint64_t>							frameCount(0);
+	static uint64_t											lastFrameMark = 0;
+	static std::array<uint64_t, PROFILER_FRAME_HISTORY>		frameDurations;
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Utility Functions																		   */
+	/*---------------------------------------------------------------------------------------------*/
+	/* Percentile -----------------------------------------------------------*/
+	/*
+		Nearest-rank percentile of an already sorted list.
+	*/
+	static double Percentile(const std::vector<double>& sorted, double q)
+	{
+		if (sorted.empty()) return 0.0;
+		size_t index = (size_t)(q * (double)(sorted.size() - 1) + 0.5);
+		return sorted[std::min(index, sorted.size() - 1)];
+	}
+
+	/* Summarize ------------------------------------------------------------*/
+	static TimingStats Summarize(std::string name, std::vector<double>& durationsMs)
+	{
+		TimingStats stats = { name, durationsMs.size(), 0.0, 0.0, 0.0, 0.0 };
+		if (durationsMs.empty()) return stats;
+
+		std::sort(durationsMs.begin(), durationsMs.end());
+
+		double sum = 0.0;
+		for (int i = 0; i < durationsMs.size(); i++) sum += durationsMs[i];
+
+		stats.meanMs = sum / (double)durationsMs.size();
+		stats.p50Ms = Percentile(durationsMs, 0.50);
+		stats.p99Ms = Percentile(durationsMs, 0.99);
+		stats.maxMs = durationsMs.back();
+		return stats;
+	}
+
+	/* Escape JSON ----------------------------------------------------------*/
+	static std::string EscapeJson(const char* text)
+	{
+		std::string escaped;
+		for (const char* c = text; *c != '\0'; c++)
+		{
+			if (*c == '"' || *c == '\\') escaped.push_back('\\');
+			escaped.push_back(*c);
+		}
+		return escaped;
+	}
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Profiler																					   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Ring Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Get Thread Ring ------------------------------------------------------*/
+	ProfileRing* Profiler::GetThreadRing()
+	{
+		if (threadRing != nullptr) return threadRing;
+
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		std::unique_ptr<ProfileRing> ring = std::make_unique<ProfileRing>();
+		ring->head.store(0);
+		for (int i = 0; i < PROFILER_RING_SIZE; i++) ring->slots[i].sequence.store(0);
+		ring->threadId = (uint32_t)rings.size();
+		threadRing = ring.get();
+		rings.push_back(std::move(ring));
+		return threadRing;
+	}
+
+	/* Snapshot Ring --------------------------------------------------------*/
+	/*
+		Copies out the events currently held in a ring. The writer may lap
+		us while we copy; each slot's sequence is checked before and after
+		reading it, and a slot that was being written, or no longer holds
+		the event we wanted, is skipped.
+	*/
+	std::vector<ProfileEvent> Profiler::SnapshotRing(ProfileRing* ring)
+	{
+		uint64_t head = ring->head.load(std::memory_order_acquire);
+		uint64_t first = (head > PROFILER_RING_SIZE) ? head - PROFILER_RING_SIZE : 0;
+
+		std::vector<ProfileEvent> events;
+		events.reserve(head - first);
+		for (uint64_t i = first; i < head; i++)
+		{
+			ProfileSlot& slot = ring->slots[i % PROFILER_RING_SIZE];
+			uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+			if (sequence != 2 * (i + 1)) continue;
+
+			ProfileEvent event;
+			event.name = slot.name.load(std::memory_order_relaxed);
+			event.start = slot.start.load(std::memory_order_relaxed);
+			event.end = slot.end.load(std::memory_order_relaxed);
+			event.frame = slot.frame.load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+
+			events.push_back(event);
+		}
+
+		return events;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Recording Functions													 */
+	/*-----------------------------------------------------------------------*/
+	/* Now ------------------------------------------------------------------*/
+	uint64_t Profiler::Now()
+	{
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profilerEpoch).count();
+	}
+
+	/* Record ---------------------------------------------------------------*/
+	void Profiler::Record(const char* name, uint64_t start, uint64_t end)
+	{
+		ProfileRing* ring = GetThreadRing();
+		uint64_t head = ring->head.load(std::memory_order_relaxed);
+		ProfileSlot& slot = ring->slots[head % PROFILER_RING_SIZE];
+
+		slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		slot.name.store(name, std::memory_order_relaxed);
+		slot.start.store(start, std::memory_order_relaxed);
+		slot.end.store(end, std::memory_order_relaxed);
+		slot.frame.store(frameCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+		slot.sequence.store(2 * (head + 1), std::memory_order_release);
+		ring->head.store(head + 1, std::memory_order_release);
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Frame Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Mark Frame -----------------------------------------------------------*/
+	/*
+		MarkFrame() should be called once per iteration of the main loop, from
+		the main thread. The time between two marks is one frame.
+	*/
+	void Profiler::MarkFrame()
+	{
+		uint64_t now = Now();
+		uint64_t frame = frameCount.load(std::memory_order_relaxed);
+
+		if (frame > 0)
+		{
+			Record("Frame", lastFrameMark, now);
+			frameDurations[(frame - 1) % PROFILER_FRAME_HISTORY] = now - lastFrameMark;
+		}
+
+		lastFrameMark = now;
+		frameCount.store(frame + 1, std::memory_order_relaxed);
+	}
+
+	/* Get Frame ------------------------------------------------------------*/
+	uint64_t Profiler::GetFrame()
+	{
+		return frameCount.load(std::memory_order_relaxed);
+	}
+
+	/* Get Frame Stats ------------------------------------------------------*/
+	TimingStats Profiler::GetFrameStats()
+	{
+		uint64_t frames = frameCount.load(std::memory_order_relaxed);
+		uint64_t completed = (frames > 0) ? frames - 1 : 0;
+		size_t count = (size_t)std::min<uint64_t>(completed, PROFILER_FRAME_HISTORY);
+
+		std::vector<double> durationsMs(count);
+		for (int i = 0; i < count; i++) durationsMs[i] = (double)frameDurations[i] / 1000000.0;
+
+		return Summarize("Frame", durationsMs);
+	}
+
+	/* Get Scope Stats ------------------------------------------------------*/
+	std::vector<TimingStats> Profiler::GetScopeStats()
+	{
+		std::unordered_map<std::string, std::vector<double>> durations;
+
+		{
+			std::lock_guard<std::mutex> lock(ringsMutex);
+			for (int i = 0; i < rings.size(); i++)
+			{
+				std::vector<ProfileEvent> events = SnapshotRing(rings[i].get());
+				for (int j = 0; j < events.size(); j++)
+				{
+					durations[events[j].name].push_back((double)(events[j].end - events[j].start) / 1000000.0);
+				}
+			}
+		}
+
+		std::vector<TimingStats> stats;
+		for (std::unordered_map<std::string, std::vector<double>>::iterator it = durations.begin(); it != durations.end(); it++)
+		{
+			stats.push_back(Summarize(it->first, it->second));
+		}
+
+		std::sort(stats.begin(), stats.end(), [](const TimingStats& a, const TimingStats& b) { return a.name < b.name; });
+		return stats;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Export Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Export Chrome Trace --------------------------------------------------*/
+	/*
+		Writes everything still held in the rings in the Chrome trace-event
+		format (load it in chrome://tracing or Perfetto). Frame and scope
+		percentiles are written into "otherData" so they travel with the
+		trace.
+	*/
+	bool Profiler::ExportChromeTrace(const std::string& path)
+	{
+		std::ofstream file(path, std::ios::trunc);
+		if (!file.is_open()) return false;
+
+		file << std::fixed;
+		file.precision(3);
+		file << "{\n\"displayTimeUnit\": \"ms\",\n\"traceEvents\": [\n";
+
+		bool first = true;
+		{
+			std::lock_guard<std::mutex> lock(ringsMutex);
+			for (int i = 0; i < rings.size(); i++)
+			{
+				if (!first) file << ",\n";
+				first = false;
+				file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << rings[i]->threadId
+					 << ", \"args\": {\"name\": \"Thread " << rings[i]->threadId << "\"}}";
+
+				std::vector<ProfileEvent> events = SnapshotRing(rings[i].get());
+				for (int j = 0; j < events.size(); j++)
+				{
+					file << ",\n{\"name\": \"" << EscapeJson(events[j].name) << "\", \"cat\": \"cpu\", \"ph\": \"X\""
+						 << ", \"ts\": " << (double)events[j].start / 1000.0
+						 << ", \"dur\": " << (double)(events[j].end - events[j].start) / 1000.0
+						 << ", \"pid\": 1, \"tid\": " << rings[i]->threadId
+						 << ", \"args\": {\"frame\": " << events[j].frame << "}}";
+				}
+			}
+		}
+
+		file << "\n],\n\"otherData\": {\n";
+
+		TimingStats frameStats = GetFrameStats();
+		file << "\t\"frames\": " << frameStats.count
+			 << ",\n\t\"frame_mean_ms\": " << frameStats.meanMs
+			 << ",\n\t\"frame_p50_ms\": " << frameStats.p50Ms
+			 << ",\n\t\"frame_p99_ms\": " << frameStats.p99Ms
+			 << ",\n\t\"frame_max_ms\": " << frameStats.maxMs;
+
+		std::vector<TimingStats> scopeStats = GetScopeStats();
+		for (int i = 0; i < scopeStats.size(); i++)
+		{
+			std::string name = EscapeJson(scopeStats[i].name.c_str());
+			file << ",\n\t\"" << name << "_p50_ms\": " << scopeStats[i].p50Ms
+				 << ",\n\t\"" << name << "_p99_ms\": " << scopeStats[i].p99Ms
+				 << ",\n\t\"" << name << "_max_ms\": " << scopeStats[i].maxMs;
+		}
+
+		file << "\n}\n}\n";
+		return file.good();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Profiler.h																											 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Defines																						   */
+/*-------------------------------------------------------------------------------------------------*/
+
+#define ENABLE_PROFILING 1
+#define PROFILER_RING_SIZE 16384
+#define PROFILER_FRAME_HISTORY 4096
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+
+#if ENABLE_PROFILING
+#define PROFILE_SCOPE(name) VkExample::ScopedTimer PROFILER_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Helper Structs																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Profile Event														 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		A single timed scope. Names must be string literals (or otherwise
+		outlive the profiler), since we only store the pointer.
+	*/
+	struct ProfileEvent
+	{
+		const char*		name;
+		uint64_t		start;
+		uint64_t		end;
+		uint64_t		frame;
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* Profile Slot															 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		One event in a ring, guarded as a seqlock. sequence is odd while
+		the writer is filling the slot and 2 * (index + 1) once event index
+		is complete, so a reader can tell a whole event from a torn one.
+	*/
+	struct ProfileSlot
+	{
+		std::atomic<uint64_t>		sequence;
+		std::atomic<const char*>	name;
+		std::atomic<uint64_t>		start;
+		std::atomic<uint64_t>		end;
+		std::atomic<uint64_t>		frame;
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* Profile Ring															 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		Each thread records into its own ring, so the only writer is the
+		owning thread and recording never takes a lock. Readers copy out
+		whatever has not been overwritten yet.
+	*/
+	struct ProfileRing
+	{
+		std::array<ProfileSlot, PROFILER_RING_SIZE>		slots;
+		std::atomic<uint64_t>							head;
+		uint32_t										threadId;
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* Timing Stats															 */
+	/*-----------------------------------------------------------------------*/
+	struct TimingStats
+	{
+		std::string		name;
+		size_t			count;
+		double			meanMs;
+		double			p50Ms;
+		double			p99Ms;
+		double			maxMs;
+	};
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Profiler																					   */
+	/*---------------------------------------------------------------------------------------------*/
+	class Profiler
+	{
+	private:
+		/*-------------------------------------------------------------------*/
+		/* Ring Functions													 */
+		/*-------------------------------------------------------------------*/
+		static ProfileRing*				GetThreadRing();
+		static std::vector<ProfileEvent> SnapshotRing(ProfileRing* ring);
+
+	public:
+		/*-------------------------------------------------------------------*/
+		/* Recording Functions												 */
+		/*-------------------------------------------------------------------*/
+		static uint64_t					Now();
+		static void						Record(const char* name, uint64_t start, uint64_t end);
+
+		/*-------------------------------------------------------------------*/
+		/* Frame Functions													 */
+		/*-------------------------------------------------------------------*/
+		static void						MarkFrame();
+		static uint64_t					GetFrame();
+		static TimingStats				GetFrameStats();
+		static std::vector<TimingStats>	GetScopeStats();
+
+		/*-------------------------------------------------------------------*/
+		/* Export Functions													 */
+		/*-------------------------------------------------------------------*/
+		static bool						ExportChromeTrace(const std::string& path);
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* Scoped Timer															 */
+	/*-----------------------------------------------------------------------*/
+	class ScopedTimer
+	{
+	private:
+		const char*						name;
+		uint64_t						start;
+
+	public:
+		ScopedTimer(const char* name) : name(name), start(Profiler::Now()) {}
+		~ScopedTimer() { Profiler::Record(name, start, Profiler::Now()); }
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,201 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Radix_Sort.cpp																										 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <cstring>
+
+#include "profiler.h"
+#include "radix_sort.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Radix Sorter																				   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Barrier																 */
+	/*-----------------------------------------------------------------------*/
+	void RadixSorter::Barrier::Wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		uint64_t arrived = generation;
+
+		if (++waiting == count)
+		{
+			waiting = 0;
+			generation++;
+			released.notify_all();
+			return;
+		}
+
+		released.wait(lock, [this, arrived] { return generation != arrived; });
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Sort Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Sort -----------------------------------------------------------------*/
+	/*
+		Sorts keys ascending, moving values along with them. Both vectors
+		must be the same length.
+	*/
+	void RadixSorter::Sort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values)
+	{
+		PROFILE_SCOPE("RadixSort");
+
+		count = keys.size();
+		if (count < 2) return;
+
+		/* Only the bytes that differ somewhere need a pass. */
+		uint64_t differing = 0;
+		for (uint32_t i = 1; i < count; i++) differing |= keys[i] ^ keys[0];
+
+		passes.clear();
+		for (uint32_t digit = 0; digit < 8; digit++)
+		{
+			if ((differing >> (digit * 8)) & 0xFF) passes.push_back(digit);
+		}
+
+		if (passes.empty()) return;
+
+		tempKeys.resize(count);
+		tempValues.resize(count);
+
+		keyBuffers[0] = keys.data();
+		keyBuffers[1] = tempKeys.data();
+		valueBuffers[0] = values.data();
+		valueBuffers[1] = tempValues.data();
+
+		threadCount = count >= RADIX_SORT_PARALLEL_THRESHOLD ? (uint32_t)workers.size() + 1 : 1;
+		histograms.assign(threadCount * 256, 0);
+
+		if (threadCount == 1) SortRange(0);
+		else
+		{
+			startBarrier.Wait();
+			SortRange(0);
+			doneBarrier.Wait();
+		}
+
+		/* An odd number of passes leaves the result in the temporaries. */
+		if (passes.size() % 2)
+		{
+			memcpy(keys.data(), tempKeys.data(), count * sizeof(uint64_t));
+			memcpy(values.data(), tempValues.data(), count * sizeof(uint32_t));
+		}
+	}
+
+	/* Sort Range -----------------------------------------------------------*/
+	/*
+		One thread's share of every pass.
+	*/
+	void RadixSorter::SortRange(uint32_t thread)
+	{
+		uint32_t begin = (uint32_t)((uint64_t)count * thread / threadCount);
+		uint32_t end = (uint32_t)((uint64_t)count * (thread + 1) / threadCount);
+		uint32_t* histogram = &histograms[thread * 256];
+
+		for (int p = 0; p < passes.size(); p++)
+		{
+			uint32_t shift = passes[p] * 8;
+			const uint64_t* srcKeys = keyBuffers[p % 2];
+			const uint32_t* srcValues = valueBuffers[p % 2];
+			uint64_t* dstKeys = keyBuffers[(p + 1) % 2];
+			uint32_t* dstValues = valueBuffers[(p + 1) % 2];
+
+			/* Count ------------------------------------------------*/
+			memset(histogram, 0, 256 * sizeof(uint32_t));
+			for (uint32_t i = begin; i < end; i++) histogram[(srcKeys[i] >> shift) & 0xFF]++;
+
+			Sync();
+
+			/* Offsets ----------------------------------------------*/
+			/*
+				Digit-major, then thread: every thread's share of a digit
+				lands after the lower threads' share of it.
+			*/
+			if (thread == 0)
+			{
+				uint32_t offset = 0;
+				for (uint32_t digit = 0; digit < 256; digit++)
+				{
+					for (uint32_t t = 0; t < threadCount; t++)
+					{
+						uint32_t n = histograms[t * 256 + digit];
+						histograms[t * 256 + digit] = offset;
+						offset += n;
+					}
+				}
+			}
+
+			Sync();
+
+			/* Scatter ----------------------------------------------*/
+			for (uint32_t i = begin; i < end; i++)
+			{
+				uint32_t slot = histogram[(srcKeys[i] >> shift) & 0xFF]++;
+				dstKeys[slot] = srcKeys[i];
+				dstValues[slot] = srcValues[i];
+			}
+
+			Sync();
+		}
+	}
+
+	/* Sync -----------------------------------------------------------------*/
+	void RadixSorter::Sync()
+	{
+		if (threadCount > 1) passBarrier.Wait();
+	}
+
+	/* Worker Loop ----------------------------------------------------------*/
+	void RadixSorter::WorkerLoop(uint32_t thread)
+	{
+		while (true)
+		{
+			startBarrier.Wait();
+			if (stopping) return;
+
+			SortRange(thread);
+			doneBarrier.Wait();
+		}
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Constructor															 */
+	/*-----------------------------------------------------------------------*/
+	RadixSorter::RadixSorter()
+	{
+		this->stopping = false;
+		this->count = 0;
+		this->threadCount = 1;
+
+		uint32_t threads = std::min<uint32_t>(std::max(1u, std::thread::hardware_concurrency()), RADIX_SORT_MAX_THREADS);
+
+		Barrier* barriers[] = { &startBarrier, &passBarrier, &doneBarrier };
+		for (int i = 0; i < 3; i++)
+		{
+			barriers[i]->count = threads;
+			barriers[i]->waiting = 0;
+			barriers[i]->generation = 0;
+		}
+
+		for (uint32_t i = 1; i < threads; i++) workers.push_back(std::thread(&RadixSorter::WorkerLoop, this, i));
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Deconstructor														 */
+	/*-----------------------------------------------------------------------*/
+	RadixSorter::~RadixSorter()
+	{
+		stopping = true;
+		if (!workers.empty()) startBarrier.Wait();
+
+		for (int i = 0; i < workers.size(); i++) workers[i].join();
+	}
+}
\ No newline at end of file
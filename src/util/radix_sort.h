@@ -0,0 +1,116 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Radix_Sort.h																											 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Defines																						   */
+/*-------------------------------------------------------------------------------------------------*/
+
+/*
+	Sorts shorter than RADIX_SORT_PARALLEL_THRESHOLD run on the calling
+	thread alone; splitting them costs more than it saves. Longer ones are
+	shared between up to RADIX_SORT_MAX_THREADS threads.
+*/
+#define RADIX_SORT_PARALLEL_THRESHOLD 32768
+#define RADIX_SORT_MAX_THREADS 8
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Radix Sorter																				   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		A least-significant-digit radix sort of 64-bit keys, each carrying
+		a 32-bit value, one byte per pass. Bytes that are the same in every
+		key are skipped, so keys that only use their low bits only pay for
+		those.
+
+		Each pass is split between the threads by range: every thread
+		counts the digits in its range, thread 0 turns the counts into
+		per-thread output offsets, and every thread then scatters its range.
+		Ranges are scattered in order, so the sort is stable.
+
+		The worker threads live as long as the sorter and sleep between
+		sorts.
+	*/
+	class RadixSorter
+	{
+	private:
+		/*-------------------------------------------------------------------*/
+		/* Barrier															 */
+		/*-------------------------------------------------------------------*/
+		/*
+			Blocks until every participating thread has arrived.
+		*/
+		struct Barrier
+		{
+			std::mutex					mutex;
+			std::condition_variable		released;
+			uint32_t					count;
+			uint32_t					waiting;
+			uint64_t					generation;
+
+			void						Wait();
+		};
+
+		/*-------------------------------------------------------------------*/
+		/* Threads															 */
+		/*-------------------------------------------------------------------*/
+		std::vector<std::thread>		workers;
+		Barrier							startBarrier;
+		Barrier							passBarrier;
+		Barrier							doneBarrier;
+		bool							stopping;
+
+		/*-------------------------------------------------------------------*/
+		/* Current Sort														 */
+		/*-------------------------------------------------------------------*/
+		uint64_t*						keyBuffers[2];
+		uint32_t*						valueBuffers[2];
+		uint32_t						count;
+		uint32_t						threadCount;
+		std::vector<uint32_t>			passes;
+		std::vector<uint32_t>			histograms;
+
+		std::vector<uint64_t>			tempKeys;
+		std::vector<uint32_t>			tempValues;
+
+		/*-------------------------------------------------------------------*/
+		/* Worker Functions													 */
+		/*-------------------------------------------------------------------*/
+		void							SortRange(uint32_t thread);
+		void							Sync();
+		void							WorkerLoop(uint32_t thread);
+
+	public:
+		/*-------------------------------------------------------------------*/
+		/* Sort Functions													 */
+		/*-------------------------------------------------------------------*/
+		void							Sort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values);
+
+		/*-------------------------------------------------------------------*/
+		/* Constructor														 */
+		/*-------------------------------------------------------------------*/
+		RadixSorter();
+
+		/*-------------------------------------------------------------------*/
+		/* Deconstructor													 */
+		/*-------------------------------------------------------------------*/
+		~RadixSorter();
+	};
+}
+
+#endif
\ No newline at end of file
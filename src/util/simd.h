@@ -0,0 +1,130 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Simd.h																												 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define SIMD_X86 0
+#endif
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Defines																						   */
+/*-------------------------------------------------------------------------------------------------*/
+
+/*
+	SIMD_TARGET_* lets a single function use a wider instruction set than
+	the rest of the build. MSVC accepts any intrinsic regardless of /arch,
+	GCC and Clang need to be told per function. Such functions must only
+	be called after checking GetCpuFeatures().
+*/
+#if defined(_MSC_VER) || !SIMD_X86
+#define SIMD_TARGET_SSE41
+#define SIMD_TARGET_AVX
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SIMD_TARGET_AVX __attribute__((target("avx")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* CPU Features																				   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		What the CPU we are running on supports, detected once with cpuid.
+		AVX additionally needs the OS to save the YMM registers, which is
+		what the xgetbv check is for.
+	*/
+	struct CpuFeatures
+	{
+		bool sse2;
+		bool sse41;
+		bool avx;
+		bool avx2;
+		bool fma;
+	};
+
+	/* Detect CPU Features --------------------------------------------------*/
+	static CpuFeatures DetectCpuFeatures()
+	{
+		CpuFeatures features = { false, false, false, false, false };
+
+#if SIMD_X86
+		uint32_t regs[4] = { 0, 0, 0, 0 };
+		uint32_t maxLeaf = 0;
+
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		maxLeaf = (uint32_t)info[0];
+		__cpuid(info, 1);
+		for (int i = 0; i < 4; i++) regs[i] = (uint32_t)info[i];
+#else
+		unsigned int a, b, c, d;
+		__cpuid(0, a, b, c, d);
+		maxLeaf = a;
+		__cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+		features.sse2 = (regs[3] >> 26) & 1;
+		features.sse41 = (regs[2] >> 19) & 1;
+		features.fma = (regs[2] >> 12) & 1;
+
+		bool osxsave = (regs[2] >> 27) & 1;
+		bool avx = (regs[2] >> 28) & 1;
+		if (osxsave && avx)
+		{
+#ifdef _MSC_VER
+			uint64_t xcr0 = _xgetbv(0);
+#else
+			uint32_t xcrLow, xcrHigh;
+			__asm__ volatile("xgetbv" : "=a"(xcrLow), "=d"(xcrHigh) : "c"(0));
+			uint64_t xcr0 = ((uint64_t)xcrHigh << 32) | xcrLow;
+#endif
+			features.avx = (xcr0 & 0x6) == 0x6;
+		}
+
+		if (features.avx && maxLeaf >= 7)
+		{
+#ifdef _MSC_VER
+			__cpuidex(info, 7, 0);
+			features.avx2 = (info[1] >> 5) & 1;
+#else
+			__cpuid_count(7, 0, a, b, c, d);
+			features.avx2 = (b >> 5) & 1;
+#endif
+		}
+
+		features.fma = features.fma && features.avx;
+#endif
+
+		return features;
+	}
+
+	/* Get CPU Features -----------------------------------------------------*/
+	static const CpuFeatures& GetCpuFeatures()
+	{
+		static const CpuFeatures features = DetectCpuFeatures();
+		return features;
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,274 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Spatial_Grid.cpp																										 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <cmath>
+
+#include "spatial_grid.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Spatial Grid																				   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Cell Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Cell Key -------------------------------------------------------------*/
+	uint64_t SpatialGrid::CellKey(int32_t x, int32_t y)
+	{
+		return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+	}
+
+	/* Cell Coord -----------------------------------------------------------*/
+	/*
+		Clamped so that far-off coordinates can't overflow the cast.
+	*/
+	int32_t SpatialGrid::CellCoord(float v)
+	{
+		float c = std::floor(v * inverseCellSize);
+		c = std::max(std::min(c, 2.0e9f), -2.0e9f);
+		return (int32_t)c;
+	}
+
+	/* Choose Cell ----------------------------------------------------------*/
+	/*
+		Returns the cell an item with these bounds belongs in, creating it
+		if need be, or 0 if the item is too big for the grid.
+	*/
+	uint32_t SpatialGrid::ChooseCell(const Rect& bounds)
+	{
+		glm::vec2 halfExtent = (bounds.max - bounds.min) * 0.5f;
+		if (std::max(halfExtent.x, halfExtent.y) > SPATIAL_GRID_LOOSENESS * cellSize) return 0;
+
+		glm::vec2 centre = (bounds.min + bounds.max) * 0.5f;
+		int32_t x = CellCoord(centre.x);
+		int32_t y = CellCoord(centre.y);
+
+		uint64_t key = CellKey(x, y);
+		std::unordered_map<uint64_t, uint32_t>::iterator it = cellLookup.find(key);
+		if (it != cellLookup.end()) return it->second;
+
+		uint32_t index = cells.size();
+		cells.push_back({ x, y, {} });
+		cellLookup[key] = index;
+		return index;
+	}
+
+	/* Add Entry ------------------------------------------------------------*/
+	void SpatialGrid::AddEntry(uint32_t cell, uint32_t id, const Rect& bounds)
+	{
+		items[id].cell = cell;
+		items[id].slot = cells[cell].entries.size();
+		cells[cell].entries.push_back({ bounds, id });
+	}
+
+	/* Remove Entry ---------------------------------------------------------*/
+	/*
+		Swaps the last entry of the cell into the hole, so removal is O(1)
+		and the entries stay packed. A cell left empty is released, which
+		can move another cell to a new index.
+	*/
+	void SpatialGrid::RemoveEntry(uint32_t id)
+	{
+		uint32_t cell = items[id].cell;
+		std::vector<Entry>& entries = cells[cell].entries;
+		uint32_t slot = items[id].slot;
+
+		entries[slot] = entries.back();
+		items[entries[slot].item].slot = slot;
+		entries.pop_back();
+
+		if (entries.empty() && cell != 0) ReleaseCell(cell);
+	}
+
+	/* Release Cell ---------------------------------------------------------*/
+	/*
+		Drops an empty cell, so the map only holds cells with items in them
+		and zoomed-out queries don't walk cells everything has left. The
+		last cell moves into the hole, and its items are pointed at it.
+	*/
+	void SpatialGrid::ReleaseCell(uint32_t cell)
+	{
+		cellLookup.erase(CellKey(cells[cell].x, cells[cell].y));
+
+		uint32_t last = cells.size() - 1;
+		if (cell != last)
+		{
+			cells[cell] = std::move(cells[last]);
+			cellLookup[CellKey(cells[cell].x, cells[cell].y)] = cell;
+			for (int i = 0; i < cells[cell].entries.size(); i++) items[cells[cell].entries[i].item].cell = cell;
+		}
+
+		cells.pop_back();
+	}
+
+	/* Query Cell -----------------------------------------------------------*/
+	void SpatialGrid::QueryCell(const Cell& cell, const Rect& area, std::vector<uint32_t>& results)
+	{
+		stats.cellsVisited++;
+		stats.entriesTested += cell.entries.size();
+
+		for (int i = 0; i < cell.entries.size(); i++)
+		{
+			if (cell.entries[i].bounds.Overlaps(area)) results.push_back(cell.entries[i].item);
+		}
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Item Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Insert ---------------------------------------------------------------*/
+	uint32_t SpatialGrid::Insert(Rect bounds, uint32_t userData)
+	{
+		uint32_t id;
+		if (!freeItems.empty())
+		{
+			id = freeItems.back();
+			freeItems.pop_back();
+		}
+		else
+		{
+			id = items.size();
+			items.push_back({});
+		}
+
+		items[id].userData = userData;
+		AddEntry(ChooseCell(bounds), id, bounds);
+		itemCount++;
+
+		return id;
+	}
+
+	/* Move -----------------------------------------------------------------*/
+	/*
+		Moves that stay within the item's cell (the common case for small
+		per-frame motion) only rewrite the stored bounds. Otherwise the cell
+		is looked up again after the removal, since releasing the old cell
+		may have moved the new one.
+	*/
+	void SpatialGrid::Move(uint32_t id, Rect bounds)
+	{
+		uint32_t cell = ChooseCell(bounds);
+		if (cell == items[id].cell)
+		{
+			cells[cell].entries[items[id].slot].bounds = bounds;
+			return;
+		}
+
+		RemoveEntry(id);
+		AddEntry(ChooseCell(bounds), id, bounds);
+	}
+
+	/* Remove ---------------------------------------------------------------*/
+	void SpatialGrid::Remove(uint32_t id)
+	{
+		RemoveEntry(id);
+		items[id].cell = SPATIAL_GRID_INVALID_ID;
+		freeItems.push_back(id);
+		itemCount--;
+	}
+
+	/* Clear ----------------------------------------------------------------*/
+	void SpatialGrid::Clear()
+	{
+		cells.resize(1);
+		cells[0].entries.clear();
+		cellLookup.clear();
+		items.clear();
+		freeItems.clear();
+		itemCount = 0;
+	}
+
+	/* Get Bounds -----------------------------------------------------------*/
+	Rect SpatialGrid::GetBounds(uint32_t id)
+	{
+		return cells[items[id].cell].entries[items[id].slot].bounds;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Query Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Query ----------------------------------------------------------------*/
+	/*
+		Appends the id of every item overlapping area to results. An item
+		can overhang its cell by up to a cell's worth of looseness, so the
+		cells searched are those under area grown by that much.
+
+		When the view is zoomed out far enough to span more cells than
+		exist, we walk the existing cells instead of the empty space.
+	*/
+	void SpatialGrid::Query(Rect area, std::vector<uint32_t>& results)
+	{
+		size_t before = results.size();
+		stats.cellsVisited = 0;
+		stats.entriesTested = 0;
+
+		QueryCell(cells[0], area, results);
+
+		float margin = SPATIAL_GRID_LOOSENESS * cellSize;
+		int32_t x0 = CellCoord(area.min.x - margin);
+		int32_t y0 = CellCoord(area.min.y - margin);
+		int32_t x1 = CellCoord(area.max.x + margin);
+		int32_t y1 = CellCoord(area.max.y + margin);
+
+		uint64_t span = (uint64_t)((int64_t)x1 - x0 + 1) * (uint64_t)((int64_t)y1 - y0 + 1);
+		if (span > cells.size() - 1)
+		{
+			for (int i = 1; i < cells.size(); i++)
+			{
+				const Cell& cell = cells[i];
+				if (cell.x >= x0 && cell.x <= x1 && cell.y >= y0 && cell.y <= y1) QueryCell(cell, area, results);
+			}
+		}
+		else
+		{
+			for (int32_t y = y0; y <= y1; y++)
+			{
+				for (int32_t x = x0; x <= x1; x++)
+				{
+					std::unordered_map<uint64_t, uint32_t>::iterator it = cellLookup.find(CellKey(x, y));
+					if (it != cellLookup.end()) QueryCell(cells[it->second], area, results);
+				}
+			}
+		}
+
+		stats.results = results.size() - before;
+	}
+
+	/* Query Point ----------------------------------------------------------*/
+	/*
+		Picking: every item whose bounds contain the point.
+	*/
+	void SpatialGrid::QueryPoint(glm::vec2 point, std::vector<uint32_t>& results)
+	{
+		Query({ point, point }, results);
+	}
+
+	/* Get Stats ------------------------------------------------------------*/
+	SpatialGridStats SpatialGrid::GetStats()
+	{
+		stats.itemCount = itemCount;
+		stats.oversizedCount = cells[0].entries.size();
+		stats.cellCount = cells.size() - 1;
+		return stats;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Constructor															 */
+	/*-----------------------------------------------------------------------*/
+	SpatialGrid::SpatialGrid(float cellSize)
+	{
+		this->cellSize = cellSize;
+		this->inverseCellSize = 1.0f / cellSize;
+		this->itemCount = 0;
+		this->stats = {};
+
+		cells.push_back({ 0, 0, {} });
+	}
+}
\ No newline at end of file
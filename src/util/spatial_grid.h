@@ -0,0 +1,161 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Spatial_Grid.h																										 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Defines																						   */
+/*-------------------------------------------------------------------------------------------------*/
+
+/*
+	Items whose larger half-extent is over SPATIAL_GRID_LOOSENESS cells
+	don't go in the grid; they sit in a separate list every query checks.
+*/
+#define SPATIAL_GRID_LOOSENESS 1.0f
+#define SPATIAL_GRID_INVALID_ID 0xFFFFFFFFu
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Helper Structs																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Rect																	 */
+	/*-----------------------------------------------------------------------*/
+	struct Rect
+	{
+		glm::vec2	min;
+		glm::vec2	max;
+
+		bool Overlaps(const Rect& o) const { return max.x >= o.min.x && min.x <= o.max.x && max.y >= o.min.y && min.y <= o.max.y; }
+		bool Contains(glm::vec2 p) const { return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y; }
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* Spatial Grid Stats													 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		The counters cover the most recent query only, so they say how much
+		of the grid a particular view had to touch.
+	*/
+	struct SpatialGridStats
+	{
+		uint32_t	itemCount;
+		uint32_t	oversizedCount;
+		uint32_t	cellCount;
+		uint32_t	cellsVisited;
+		uint32_t	entriesTested;
+		uint32_t	results;
+	};
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Spatial Grid																				   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		A loose uniform grid over an unbounded 2D plane. Every item lives in
+		exactly one cell, the one holding its centre, and may hang over into
+		the neighbours by up to SPATIAL_GRID_LOOSENESS cells. A query
+		widens its rectangle by that much and then only has to look at the
+		cells it covers, so its cost follows the size of the view rather
+		than the number of items.
+
+		Cells are only created where there are items (through a hash map),
+		and released once the last one leaves, so the world needs no fixed
+		size. Each cell keeps its items' bounds
+		inline, so testing a cell is a linear walk over contiguous memory.
+
+		Items are referred to by the id Insert() returns. Ids are reused
+		after Remove().
+	*/
+	class SpatialGrid
+	{
+	private:
+		/*-------------------------------------------------------------------*/
+		/* Storage															 */
+		/*-------------------------------------------------------------------*/
+		struct Entry
+		{
+			Rect		bounds;
+			uint32_t	item;
+		};
+
+		struct Cell
+		{
+			int32_t				x;
+			int32_t				y;
+			std::vector<Entry>	entries;
+		};
+
+		struct Item
+		{
+			uint32_t	cell;
+			uint32_t	slot;
+			uint32_t	userData;
+		};
+
+		float							cellSize;
+		float							inverseCellSize;
+
+		/*
+			cells[0] holds the oversized items; it has no position and is
+			checked by every query.
+		*/
+		std::vector<Cell>				cells;
+		std::unordered_map<uint64_t, uint32_t>	cellLookup;
+
+		std::vector<Item>				items;
+		std::vector<uint32_t>			freeItems;
+		uint32_t						itemCount;
+
+		SpatialGridStats				stats;
+
+		/*-------------------------------------------------------------------*/
+		/* Cell Functions													 */
+		/*-------------------------------------------------------------------*/
+		static uint64_t					CellKey(int32_t x, int32_t y);
+		int32_t							CellCoord(float v);
+		uint32_t						ChooseCell(const Rect& bounds);
+		void							AddEntry(uint32_t cell, uint32_t id, const Rect& bounds);
+		void							RemoveEntry(uint32_t id);
+		void							ReleaseCell(uint32_t cell);
+		void							QueryCell(const Cell& cell, const Rect& area, std::vector<uint32_t>& results);
+
+	public:
+		/*-------------------------------------------------------------------*/
+		/* Item Functions													 */
+		/*-------------------------------------------------------------------*/
+		uint32_t						Insert(Rect bounds, uint32_t userData);
+		void							Move(uint32_t id, Rect bounds);
+		void							Remove(uint32_t id);
+		void							Clear();
+
+		Rect							GetBounds(uint32_t id);
+		uint32_t						GetUserData(uint32_t id) { return items[id].userData; }
+		uint32_t						GetItemCount() { return itemCount; }
+
+		/*-------------------------------------------------------------------*/
+		/* Query Functions													 */
+		/*-------------------------------------------------------------------*/
+		void							Query(Rect area, std::vector<uint32_t>& results);
+		void							QueryPoint(glm::vec2 point, std::vector<uint32_t>& results);
+		SpatialGridStats				GetStats();
+
+		/*-------------------------------------------------------------------*/
+		/* Constructor														 */
+		/*-------------------------------------------------------------------*/
+		SpatialGrid(float cellSize);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,390 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Sprite_Expander.cpp																									 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "profiler.h"
+#include "sprite_expander.h"
+
+namespace VkExample
+{
+	/*
+		The kernels write vertices as floats, 9 to a vertex, and rely on
+		there being no padding between or inside them.
+	*/
+	static_assert(sizeof(Vertex) == 9 * sizeof(float), "Vertex must be 9 tightly packed floats");
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Helpers																					   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		Which of a sprite's corners each of its six vertices uses. Corners
+		go (-x, -y), (+x, -y), (+x, +y), (-x, +y) before rotation, with
+		uvs (u0, v0), (u1, v0), (u1, v1), (u0, v1).
+	*/
+	static const int QuadCorners[6] = { 0, 1, 2, 0, 2, 3 };
+
+	/* Write Sprite ---------------------------------------------------------*/
+	/*
+		Writes sprite i's six vertices given its rotated corners, which
+		are stride floats apart in cornerX and cornerY.
+	*/
+	static inline void WriteSprite(const SpriteArrays& sprites, uint32_t i, const float* cornerX, const float* cornerY, uint32_t stride, Vertex* out)
+	{
+		float u[4] = { sprites.u0[i], sprites.u1[i], sprites.u1[i], sprites.u0[i] };
+		float v[4] = { sprites.v0[i], sprites.v0[i], sprites.v1[i], sprites.v1[i] };
+		float z = sprites.z[i];
+		glm::vec4 color(sprites.r[i], sprites.g[i], sprites.b[i], sprites.a[i]);
+
+		for (int k = 0; k < 6; k++)
+		{
+			int corner = QuadCorners[k];
+			out[k].position = glm::vec3(cornerX[corner * stride], cornerY[corner * stride], z);
+			out[k].color = color;
+			out[k].uv = glm::vec2(u[corner], v[corner]);
+		}
+	}
+
+#if SIMD_X86
+	/* Write Sprite SSE -----------------------------------------------------*/
+	/*
+		As WriteSprite(), as two unaligned 16 byte stores and one float per
+		vertex.
+	*/
+	static inline void WriteSpriteSSE(const SpriteArrays& sprites, uint32_t i, const float* cornerX, const float* cornerY, uint32_t stride, Vertex* out)
+	{
+		float z = sprites.z[i];
+		float r = sprites.r[i];
+		float g = sprites.g[i];
+		float b = sprites.b[i];
+		float a = sprites.a[i];
+		float v[4] = { sprites.v0[i], sprites.v0[i], sprites.v1[i], sprites.v1[i] };
+
+		/* x, y, z, r per corner, and g, b, a, u for u0 and u1. */
+		__m128 heads[4];
+		for (int c = 0; c < 4; c++) heads[c] = _mm_setr_ps(cornerX[c * stride], cornerY[c * stride], z, r);
+		__m128 tails[2] = { _mm_setr_ps(g, b, a, sprites.u0[i]), _mm_setr_ps(g, b, a, sprites.u1[i]) };
+
+		float* p = (float*)out;
+		for (int k = 0; k < 6; k++, p += 9)
+		{
+			int corner = QuadCorners[k];
+			_mm_storeu_ps(p, heads[corner]);
+			_mm_storeu_ps(p + 4, tails[corner == 1 || corner == 2]);
+			p[8] = v[corner];
+		}
+	}
+
+	/* Stream SSE -----------------------------------------------------------*/
+	/*
+		Copies count 16 byte vectors from an aligned block to out. Sprites
+		are 216 bytes, so 4 of them are a whole number of vectors; the
+		kernels build that many in a block on the stack and then stream
+		them out, which skips reading the destination into the cache first.
+		Callers must _mm_sfence() after.
+	*/
+	static inline void StreamSSE(const float* block, uint32_t count, Vertex* out)
+	{
+		float* p = (float*)out;
+		if (((uintptr_t)p & 15) == 0)
+		{
+			for (uint32_t i = 0; i < count; i++) _mm_stream_ps(p + i * 4, _mm_load_ps(block + i * 4));
+		}
+		else
+		{
+			for (uint32_t i = 0; i < count; i++) _mm_storeu_ps(p + i * 4, _mm_load_ps(block + i * 4));
+		}
+	}
+
+	/* Sin SSE --------------------------------------------------------------*/
+	/*
+		sin(x) for 4 angles: wrapped to [-pi, pi], folded to [-pi/2, pi/2]
+		with sin(x) = sin(pi - x), then a Taylor series to x^11, which is
+		good to about 6e-8 there.
+	*/
+	static inline __m128 SinSSE(__m128 x)
+	{
+		const __m128 signBit = _mm_set1_ps(-0.0f);
+		const __m128 pi = _mm_set1_ps(3.14159265f);
+
+		__m128 turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.159154943f))));
+		x = _mm_sub_ps(x, _mm_mul_ps(turns, _mm_set1_ps(6.28318531f)));
+
+		__m128 sign = _mm_and_ps(x, signBit);
+		__m128 magnitude = _mm_andnot_ps(signBit, x);
+		x = _mm_or_ps(_mm_min_ps(magnitude, _mm_sub_ps(pi, magnitude)), sign);
+
+		__m128 x2 = _mm_mul_ps(x, x);
+		__m128 p = _mm_set1_ps(-2.50521084e-8f);
+		p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(2.75573192e-6f));
+		p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.98412698e-4f));
+		p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(8.33333333e-3f));
+		p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.66666667e-1f));
+		p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f));
+		return _mm_mul_ps(p, x);
+	}
+
+	/* Sin AVX2 -------------------------------------------------------------*/
+	SIMD_TARGET_AVX2
+	static inline __m256 SinAVX2(__m256 x)
+	{
+		const __m256 signBit = _mm256_set1_ps(-0.0f);
+		const __m256 pi = _mm256_set1_ps(3.14159265f);
+
+		__m256 turns = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(0.159154943f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		x = _mm256_fnmadd_ps(turns, _mm256_set1_ps(6.28318531f), x);
+
+		__m256 sign = _mm256_and_ps(x, signBit);
+		__m256 magnitude = _mm256_andnot_ps(signBit, x);
+		x = _mm256_or_ps(_mm256_min_ps(magnitude, _mm256_sub_ps(pi, magnitude)), sign);
+
+		__m256 x2 = _mm256_mul_ps(x, x);
+		__m256 p = _mm256_set1_ps(-2.50521084e-8f);
+		p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(2.75573192e-6f));
+		p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(-1.98412698e-4f));
+		p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(8.33333333e-3f));
+		p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(-1.66666667e-1f));
+		p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(1.0f));
+		return _mm256_mul_ps(p, x);
+	}
+#endif
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Expand Kernels																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		Each kernel expands sprites [first, last) into out, which is the
+		start of the whole output, not of the range. The corners are
+		centre -/+ A -/+ B, where A is half the width along the sprite's
+		rotated x axis and B half the height along its y axis.
+	*/
+	/* Scalar ---------------------------------------------------------------*/
+	static void ExpandScalar(const SpriteArrays& sprites, uint32_t first, uint32_t last, Vertex* out)
+	{
+		for (uint32_t i = first; i < last; i++)
+		{
+			float sine = std::sin(sprites.rotation[i]);
+			float cosine = std::cos(sprites.rotation[i]);
+			float halfWidth = sprites.width[i] * 0.5f;
+			float halfHeight = sprites.height[i] * 0.5f;
+
+			float ax = halfWidth * cosine;
+			float ay = halfWidth * sine;
+			float bx = -halfHeight * sine;
+			float by = halfHeight * cosine;
+
+			float x = sprites.x[i];
+			float y = sprites.y[i];
+			float cornerX[4] = { x - ax - bx, x + ax - bx, x + ax + bx, x - ax + bx };
+			float cornerY[4] = { y - ay - by, y + ay - by, y + ay + by, y - ay + by };
+
+			WriteSprite(sprites, i, cornerX, cornerY, 1, out + (size_t)i * 6);
+		}
+	}
+
+#if SIMD_X86
+	/* SSE ------------------------------------------------------------------*/
+	static void ExpandSSE(const SpriteArrays& sprites, uint32_t first, uint32_t last, Vertex* out)
+	{
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 halfPi = _mm_set1_ps(1.57079633f);
+
+		alignas(16) float cornerX[16];
+		alignas(16) float cornerY[16];
+		alignas(16) float block[4 * 6 * 9];
+
+		uint32_t i = first;
+		for (; i + 4 <= last; i += 4)
+		{
+			__m128 rotation = _mm_loadu_ps(sprites.rotation + i);
+			__m128 sine = SinSSE(rotation);
+			__m128 cosine = SinSSE(_mm_add_ps(rotation, halfPi));
+			__m128 halfWidth = _mm_mul_ps(_mm_loadu_ps(sprites.width + i), half);
+			__m128 halfHeight = _mm_mul_ps(_mm_loadu_ps(sprites.height + i), half);
+
+			/* A + B and A - B. */
+			__m128 sumX = _mm_sub_ps(_mm_mul_ps(halfWidth, cosine), _mm_mul_ps(halfHeight, sine));
+			__m128 sumY = _mm_add_ps(_mm_mul_ps(halfWidth, sine), _mm_mul_ps(halfHeight, cosine));
+			__m128 diffX = _mm_add_ps(_mm_mul_ps(halfWidth, cosine), _mm_mul_ps(halfHeight, sine));
+			__m128 diffY = _mm_sub_ps(_mm_mul_ps(halfWidth, sine), _mm_mul_ps(halfHeight, cosine));
+
+			__m128 x = _mm_loadu_ps(sprites.x + i);
+			__m128 y = _mm_loadu_ps(sprites.y + i);
+			_mm_store_ps(cornerX + 0, _mm_sub_ps(x, sumX));
+			_mm_store_ps(cornerX + 4, _mm_add_ps(x, diffX));
+			_mm_store_ps(cornerX + 8, _mm_add_ps(x, sumX));
+			_mm_store_ps(cornerX + 12, _mm_sub_ps(x, diffX));
+			_mm_store_ps(cornerY + 0, _mm_sub_ps(y, sumY));
+			_mm_store_ps(cornerY + 4, _mm_add_ps(y, diffY));
+			_mm_store_ps(cornerY + 8, _mm_add_ps(y, sumY));
+			_mm_store_ps(cornerY + 12, _mm_sub_ps(y, diffY));
+
+			for (uint32_t lane = 0; lane < 4; lane++)
+			{
+				WriteSpriteSSE(sprites, i + lane, cornerX + lane, cornerY + lane, 4, (Vertex*)block + lane * 6);
+			}
+			StreamSSE(block, 4 * 6 * 9 / 4, out + (size_t)i * 6);
+		}
+		_mm_sfence();
+
+		ExpandScalar(sprites, i, last, out);
+	}
+
+	/* AVX2 -----------------------------------------------------------------*/
+	SIMD_TARGET_AVX2
+	static void ExpandAVX2(const SpriteArrays& sprites, uint32_t first, uint32_t last, Vertex* out)
+	{
+		const __m256 half = _mm256_set1_ps(0.5f);
+		const __m256 halfPi = _mm256_set1_ps(1.57079633f);
+
+		alignas(32) float cornerX[32];
+		alignas(32) float cornerY[32];
+		alignas(16) float block[8 * 6 * 9];
+
+		uint32_t i = first;
+		for (; i + 8 <= last; i += 8)
+		{
+			__m256 rotation = _mm256_loadu_ps(sprites.rotation + i);
+			__m256 sine = SinAVX2(rotation);
+			__m256 cosine = SinAVX2(_mm256_add_ps(rotation, halfPi));
+			__m256 halfWidth = _mm256_mul_ps(_mm256_loadu_ps(sprites.width + i), half);
+			__m256 halfHeight = _mm256_mul_ps(_mm256_loadu_ps(sprites.height + i), half);
+
+			/* A + B and A - B. */
+			__m256 sumX = _mm256_fmsub_ps(halfWidth, cosine, _mm256_mul_ps(halfHeight, sine));
+			__m256 sumY = _mm256_fmadd_ps(halfWidth, sine, _mm256_mul_ps(halfHeight, cosine));
+			__m256 diffX = _mm256_fmadd_ps(halfWidth, cosine, _mm256_mul_ps(halfHeight, sine));
+			__m256 diffY = _mm256_fmsub_ps(halfWidth, sine, _mm256_mul_ps(halfHeight, cosine));
+
+			__m256 x = _mm256_loadu_ps(sprites.x + i);
+			__m256 y = _mm256_loadu_ps(sprites.y + i);
+			_mm256_store_ps(cornerX + 0, _mm256_sub_ps(x, sumX));
+			_mm256_store_ps(cornerX + 8, _mm256_add_ps(x, diffX));
+			_mm256_store_ps(cornerX + 16, _mm256_add_ps(x, sumX));
+			_mm256_store_ps(cornerX + 24, _mm256_sub_ps(x, diffX));
+			_mm256_store_ps(cornerY + 0, _mm256_sub_ps(y, sumY));
+			_mm256_store_ps(cornerY + 8, _mm256_add_ps(y, diffY));
+			_mm256_store_ps(cornerY + 16, _mm256_add_ps(y, sumY));
+			_mm256_store_ps(cornerY + 24, _mm256_sub_ps(y, diffY));
+
+			for (uint32_t lane = 0; lane < 8; lane++)
+			{
+				WriteSpriteSSE(sprites, i + lane, cornerX + lane, cornerY + lane, 8, (Vertex*)block + lane * 6);
+			}
+			StreamSSE(block, 8 * 6 * 9 / 4, out + (size_t)i * 6);
+		}
+		_mm_sfence();
+
+		ExpandScalar(sprites, i, last, out);
+	}
+#endif
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Sprite Expander																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Expand Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Expand ---------------------------------------------------------------*/
+	/*
+		Big expansions are split into one range per thread, each a
+		multiple of 8 sprites so only the last has a scalar tail. The
+		calling thread takes the first range.
+	*/
+	void SpriteExpander::Expand(const SpriteArrays& sprites, Vertex* out)
+	{
+		PROFILE_SCOPE("ExpandSprites");
+
+		uint32_t count = sprites.count;
+		uint32_t threads = 1;
+		if (count >= SPRITE_EXPAND_PARALLEL_THRESHOLD)
+		{
+			threads = std::min(maxThreads, std::max(1u, std::thread::hardware_concurrency()));
+		}
+
+		uint32_t perThread = ((count + threads - 1) / threads + 7) & ~7u;
+
+		std::vector<std::future<void>> jobs;
+		for (uint32_t t = 1; t < threads && t * perThread < count; t++)
+		{
+			uint32_t first = t * perThread;
+			uint32_t last = std::min(count, first + perThread);
+			jobs.push_back(std::async(std::launch::async, kernel, std::cref(sprites), first, last, out));
+		}
+
+		kernel(sprites, 0, std::min(count, perThread), out);
+
+		for (int i = 0; i < jobs.size(); i++) jobs[i].get();
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Kernel Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Set Kernel -----------------------------------------------------------*/
+	bool SpriteExpander::SetKernel(const std::string& name)
+	{
+		if (name == "scalar")
+		{
+			kernel = ExpandScalar;
+			kernelName = "scalar";
+			return true;
+		}
+
+#if SIMD_X86
+		const CpuFeatures& cpu = GetCpuFeatures();
+		if (name == "sse" && cpu.sse2)
+		{
+			kernel = ExpandSSE;
+			kernelName = "sse";
+			return true;
+		}
+		if (name == "avx2" && cpu.avx2 && cpu.fma)
+		{
+			kernel = ExpandAVX2;
+			kernelName = "avx2";
+			return true;
+		}
+#endif
+
+		return false;
+	}
+
+	/* Set Max Threads ------------------------------------------------------*/
+	void SpriteExpander::SetMaxThreads(uint32_t threads)
+	{
+		maxThreads = std::clamp(threads, 1u, (uint32_t)SPRITE_EXPAND_MAX_THREADS);
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Constructor															 */
+	/*-----------------------------------------------------------------------*/
+	SpriteExpander::SpriteExpander()
+	{
+		this->kernel = ExpandScalar;
+		this->kernelName = "scalar";
+		this->maxThreads = SPRITE_EXPAND_MAX_THREADS;
+
+#if SIMD_X86
+		const CpuFeatures& cpu = GetCpuFeatures();
+		if (cpu.avx2 && cpu.fma)
+		{
+			kernel = ExpandAVX2;
+			kernelName = "avx2";
+		}
+		else if (cpu.sse2)
+		{
+			kernel = ExpandSSE;
+			kernelName = "sse";
+		}
+#endif
+	}
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#ifndef SPRITE_EXPANDER_H
+#define SPRITE_EXPANDER_H
+
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Sprite_Expander.h																									 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <cstdint>
+#include <string>
+
+#include "polygons.h"
+#include "simd.h"
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Defines																						   */
+/*-------------------------------------------------------------------------------------------------*/
+
+/*
+	Expansions of fewer than SPRITE_EXPAND_PARALLEL_THRESHOLD sprites run
+	on the calling thread alone. Bigger ones are split between up to
+	SPRITE_EXPAND_MAX_THREADS threads: a single core can't write a million
+	sprites' vertices (216MB) inside a frame.
+*/
+#define SPRITE_EXPAND_PARALLEL_THRESHOLD 65536
+#define SPRITE_EXPAND_MAX_THREADS 8
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Helper Structs																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Sprite Arrays														 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		Sprites as one array per field, each count long. A sprite is a
+		width x height rectangle centred on (x, y) at depth z, turned by
+		rotation radians about its centre, tinted (r, g, b, a) and showing
+		the (u0, v0)-(u1, v1) rectangle of the atlas. The arrays are only
+		borrowed.
+	*/
+	struct SpriteArrays
+	{
+		const float*	x;
+		const float*	y;
+		const float*	z;
+		const float*	width;
+		const float*	height;
+		const float*	rotation;
+		const float*	r;
+		const float*	g;
+		const float*	b;
+		const float*	a;
+		const float*	u0;
+		const float*	v0;
+		const float*	u1;
+		const float*	v1;
+		uint32_t		count;
+	};
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Sprite Expander																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		Turns sprites into the six vertices, two triangles, the renderer
+		draws each as, in the same corner order as every other quad.
+
+		The kernel is chosen once from what the CPU supports: AVX2 with FMA
+		(8 sprites at a time), SSE2 (4 at a time) or scalar. The vector
+		kernels use a polynomial sine rather than sinf, good to about 1e-7,
+		so corners differ from the scalar kernel's only by rounding.
+
+		The output is only ever written, front to back, and never read, so
+		it can point straight into mapped, write-combined staging memory.
+	*/
+	class SpriteExpander
+	{
+	private:
+		/*-------------------------------------------------------------------*/
+		/* Kernel															 */
+		/*-------------------------------------------------------------------*/
+		typedef void (*ExpandKernel)(const SpriteArrays& sprites, uint32_t first, uint32_t last, Vertex* out);
+
+		ExpandKernel					kernel;
+		const char*						kernelName;
+		uint32_t						maxThreads;
+
+	public:
+		/*-------------------------------------------------------------------*/
+		/* Expand Functions													 */
+		/*-------------------------------------------------------------------*/
+		/*
+			Writes sprites.count * 6 vertices to out, sprite i's starting at
+			out[i * 6].
+		*/
+		void							Expand(const SpriteArrays& sprites, Vertex* out);
+
+		/*-------------------------------------------------------------------*/
+		/* Kernel Functions													 */
+		/*-------------------------------------------------------------------*/
+		/*
+			Forces "scalar", "sse" or "avx2", for comparing them. Returns
+			false, leaving the kernel as it was, if the CPU can't run it.
+		*/
+		bool							SetKernel(const std::string& name);
+		const char*						GetKernelName() { return kernelName; }
+
+		void							SetMaxThreads(uint32_t threads);
+		uint32_t						GetMaxThreads() { return maxThreads; }
+
+		/*-------------------------------------------------------------------*/
+		/* Constructor														 */
+		/*-------------------------------------------------------------------*/
+		SpriteExpander();
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,437 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Chunk_Streamer.cpp																									 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <cmath>
+
+#include "chunk_streamer.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Chunk Streamer																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Update Function														 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		Called once per frame, before Renderer::Render().
+	*/
+	void ChunkStreamer::Update()
+	{
+		PROFILE_SCOPE("ChunkStreamer::Update");
+		frame++;
+
+		ViewBounds view = Culler::ComputeViewBounds(camera->GetViewProjection());
+		UpdateLevel((view.maxX - view.minX) / camera->GetViewport().width);
+
+		/* Wanted Chunks ----------------------------------------------------*/
+		/*
+			While a new level streams in, both levels share the slots; the
+			new one is asked for first.
+		*/
+		std::vector<ChunkCoord> displayChunks;
+		std::vector<ChunkCoord> targetChunks;
+		std::vector<ChunkCoord> missing;
+		wantedChunks.clear();
+
+		if (targetLevel != displayLevel)
+		{
+			CollectChunks(view, targetLevel, WORLD_CHUNK_SLOTS / 2, targetChunks);
+			TouchChunks(targetChunks, missing);
+
+			if (missing.empty())
+			{
+				displayLevel = targetLevel;
+				ReleaseStaleLevels();
+				wantedChunks.clear();
+			}
+		}
+
+		uint32_t maxChunks = targetLevel != displayLevel ? WORLD_CHUNK_SLOTS / 2 : WORLD_CHUNK_SLOTS;
+		CollectChunks(view, displayLevel, maxChunks, displayChunks);
+
+		size_t targetMissing = missing.size();
+		TouchChunks(displayChunks, missing);
+		stats.visibleChunks = displayChunks.size() - (missing.size() - targetMissing);
+
+		/* Slots a finished chunk could take: free, or out of view. */
+		uint32_t freeSlots = 0;
+		for (int i = 0; i < slots.size(); i++)
+		{
+			if (!slots[i].used || slots[i].lastUsed < frame) freeSlots++;
+		}
+
+		RequestChunks(missing, freeSlots);
+		UploadChunks();
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Level Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Update Level ---------------------------------------------------------*/
+	/*
+		lod is the level whose merged quads are exactly
+		WORLD_LOD_CELL_PIXELS across; the level in use moves once lod is
+		far enough outside [level, level + 1).
+	*/
+	void ChunkStreamer::UpdateLevel(float unitsPerPixel)
+	{
+		float lod = std::log2(WORLD_LOD_CELL_PIXELS * WORLD_LOD_CELLS * unitsPerPixel / WORLD_CHUNK_SIZE);
+		if (lod < targetLevel + 1.0f + WORLD_LOD_HYSTERESIS && lod > targetLevel - WORLD_LOD_HYSTERESIS) return;
+
+		int32_t level = std::max(0, std::min((int32_t)std::floor(lod), WORLD_LOD_LEVELS - 1));
+		if (level == targetLevel) return;
+
+		/* A transition that hasn't finished is abandoned. */
+		targetLevel = level;
+		ReleaseStaleLevels();
+	}
+
+	/* Release Stale Levels -------------------------------------------------*/
+	/*
+		Hides and frees every slot holding a level that is neither on
+		screen nor on its way.
+	*/
+	void ChunkStreamer::ReleaseStaleLevels()
+	{
+		for (int i = 0; i < slots.size(); i++)
+		{
+			if (!slots[i].used || slots[i].coord.level == displayLevel || slots[i].coord.level == targetLevel) continue;
+
+			renderer->HideVertexRange(i * WORLD_CHUNK_VERTICES, WORLD_CHUNK_VERTICES);
+			residentChunks.erase(slots[i].coord.Key());
+			slots[i].used = false;
+		}
+	}
+
+	/* Collect Chunks -------------------------------------------------------*/
+	/*
+		The level's chunks under the view plus the prefetch margin, nearest
+		the centre first. Zoomed out further than maxChunks can cover (past
+		the coarsest level), only the middle of the view is taken.
+	*/
+	void ChunkStreamer::CollectChunks(ViewBounds view, int32_t level, uint32_t maxChunks, std::vector<ChunkCoord>& chunks)
+	{
+		float size = WORLD_CHUNK_SIZE * (float)(1 << level);
+		glm::vec2 centre((view.minX + view.maxX) * 0.5f, (view.minY + view.maxY) * 0.5f);
+
+		int64_t x0 = (int64_t)std::floor(view.minX / size) - WORLD_PREFETCH_CHUNKS;
+		int64_t y0 = (int64_t)std::floor(view.minY / size) - WORLD_PREFETCH_CHUNKS;
+		int64_t x1 = (int64_t)std::floor(view.maxX / size) + WORLD_PREFETCH_CHUNKS;
+		int64_t y1 = (int64_t)std::floor(view.maxY / size) + WORLD_PREFETCH_CHUNKS;
+
+		if ((x1 - x0 + 1) * (y1 - y0 + 1) > maxChunks)
+		{
+			int64_t half = (int64_t)std::sqrt((double)maxChunks) / 2;
+			int64_t cx = (int64_t)std::floor(centre.x / size);
+			int64_t cy = (int64_t)std::floor(centre.y / size);
+			x0 = std::max(x0, cx - half);
+			y0 = std::max(y0, cy - half);
+			x1 = std::min(x1, cx + half - 1);
+			y1 = std::min(y1, cy + half - 1);
+		}
+
+		for (int64_t y = y0; y <= y1; y++)
+		{
+			for (int64_t x = x0; x <= x1; x++) chunks.push_back({ (int32_t)x, (int32_t)y, level });
+		}
+
+		std::sort(chunks.begin(), chunks.end(), [centre](const ChunkCoord& a, const ChunkCoord& b)
+		{
+			glm::vec2 da = (glm::vec2(a.x, a.y) + 0.5f) * a.Size() - centre;
+			glm::vec2 db = (glm::vec2(b.x, b.y) + 0.5f) * b.Size() - centre;
+			return glm::dot(da, da) < glm::dot(db, db);
+		});
+	}
+
+	/* Touch Chunks ---------------------------------------------------------*/
+	/*
+		Marks the chunks as wanted and, where resident, as used this frame.
+		The rest are appended to missing.
+	*/
+	void ChunkStreamer::TouchChunks(const std::vector<ChunkCoord>& chunks, std::vector<ChunkCoord>& missing)
+	{
+		for (int i = 0; i < chunks.size(); i++)
+		{
+			uint64_t key = chunks[i].Key();
+			wantedChunks.insert(key);
+
+			std::unordered_map<uint64_t, uint32_t>::iterator it = residentChunks.find(key);
+			if (it != residentChunks.end()) slots[it->second].lastUsed = frame;
+			else missing.push_back(chunks[i]);
+		}
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Streaming Functions													 */
+	/*-----------------------------------------------------------------------*/
+	/* Request Chunks -------------------------------------------------------*/
+	/*
+		Replaces the generation queue with the chunks that are missing now,
+		nearest first. Chunks that were queued but are no longer wanted
+		never get generated; ones already being generated are left alone.
+
+		No more chunks are pending than there are slots to put them in.
+		With every slot in view nothing is generated only to be dropped,
+		and requests pick up again once the view moves off some slots.
+	*/
+	void ChunkStreamer::RequestChunks(const std::vector<ChunkCoord>& missing, uint32_t freeSlots)
+	{
+		uint32_t maxPending = std::min<uint32_t>(WORLD_MAX_PENDING_CHUNKS, freeSlots);
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (int i = 0; i < jobs.size(); i++) pendingChunks.erase(jobs[i].Key());
+		jobs.clear();
+
+		for (int i = 0; i < missing.size() && pendingChunks.size() < maxPending; i++)
+		{
+			uint64_t key = missing[i].Key();
+			if (pendingChunks.count(key)) continue;
+
+			jobs.push_back(missing[i]);
+			pendingChunks.insert(key);
+		}
+
+		if (!jobs.empty()) jobAvailable.notify_all();
+	}
+
+	/* Upload Chunks --------------------------------------------------------*/
+	void ChunkStreamer::UploadChunks()
+	{
+		PROFILE_SCOPE("ChunkStreamer::UploadChunks");
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (int i = 0; i < completed.size(); i++) readyChunks.push_back(std::move(completed[i]));
+			completed.clear();
+		}
+
+		int done = 0;
+		while (done < readyChunks.size() && done < WORLD_UPLOADS_PER_FRAME)
+		{
+			if (!UploadChunk(readyChunks[done])) break;
+			done++;
+		}
+
+		readyChunks.erase(readyChunks.begin(), readyChunks.begin() + done);
+	}
+
+	/* Upload Chunk ---------------------------------------------------------*/
+	/*
+		Puts a finished chunk into a slot. Returns false if the renderer
+		couldn't take the upload this frame, in which case the chunk is
+		kept for the next one.
+	*/
+	bool ChunkStreamer::UploadChunk(ChunkResult& result)
+	{
+		uint64_t key = result.coord.Key();
+		std::vector<Vertex>& vertices = result.vertices;
+
+		if (residentChunks.count(key) || (result.coord.level != displayLevel && result.coord.level != targetLevel))
+		{
+			pendingChunks.erase(key);
+			ReleaseBuffer(vertices);
+			return true;
+		}
+
+		int slot = AcquireSlot(wantedChunks.count(key) > 0);
+		if (slot < 0)
+		{
+			pendingChunks.erase(key);
+			stats.droppedChunks++;
+			ReleaseBuffer(vertices);
+			return true;
+		}
+
+		/*
+			Slots are always uploaded whole. Unused vertices repeat the last
+			one, so they form triangles with no area.
+		*/
+		vertices.resize(std::min<size_t>(vertices.size(), WORLD_CHUNK_VERTICES) / 6 * 6);
+		if (vertices.size() < WORLD_CHUNK_VERTICES)
+		{
+			Vertex filler{};
+			filler.position = glm::vec3((glm::vec2(result.coord.x, result.coord.y) + 0.5f) * result.coord.Size(), 0.0f);
+			if (!vertices.empty()) filler = vertices.back();
+
+			vertices.resize(WORLD_CHUNK_VERTICES, filler);
+		}
+
+		if (!renderer->QueueVertexUpload(vertices.data(), WORLD_CHUNK_VERTICES, slot * WORLD_CHUNK_VERTICES)) return false;
+
+		if (slots[slot].used)
+		{
+			residentChunks.erase(slots[slot].coord.Key());
+			stats.evictedChunks++;
+		}
+
+		slots[slot] = { result.coord, true, frame };
+		residentChunks[key] = slot;
+		pendingChunks.erase(key);
+		stats.uploadedChunks++;
+
+		ReleaseBuffer(vertices);
+		return true;
+	}
+
+	/* Acquire Slot ---------------------------------------------------------*/
+	/*
+		A free slot if there is one, else the least recently used slot that
+		is out of view. A chunk that isn't wanted any more only gets a free
+		slot; it isn't worth evicting anything for.
+	*/
+	int ChunkStreamer::AcquireSlot(bool wanted)
+	{
+		int best = -1;
+		uint64_t oldest = UINT64_MAX;
+
+		for (int i = 0; i < slots.size(); i++)
+		{
+			if (!slots[i].used) return i;
+			if (wanted && slots[i].lastUsed < frame && slots[i].lastUsed < oldest)
+			{
+				best = i;
+				oldest = slots[i].lastUsed;
+			}
+		}
+
+		return best;
+	}
+
+	/* Release Buffer -------------------------------------------------------*/
+	void ChunkStreamer::ReleaseBuffer(std::vector<Vertex>& vertices)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		bufferPool.push_back(std::move(vertices));
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Worker Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Worker Loop ----------------------------------------------------------*/
+	void ChunkStreamer::WorkerLoop()
+	{
+		LodGrid lodGrid(WORLD_LOD_CELLS);
+		std::vector<Vertex> scratch;
+
+		while (true)
+		{
+			ChunkCoord coord;
+			std::vector<Vertex> vertices;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+				if (stopping) return;
+
+				coord = jobs.front();
+				jobs.pop_front();
+
+				if (!bufferPool.empty())
+				{
+					vertices = std::move(bufferPool.back());
+					bufferPool.pop_back();
+				}
+			}
+
+			GenerateChunk(coord, lodGrid, scratch, vertices);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			completed.push_back({ coord, std::move(vertices) });
+			stats.generatedChunks++;
+		}
+	}
+
+	/* Generate Chunk -------------------------------------------------------*/
+	/*
+		Level 0 chunks come straight from the generator. Coarser ones run it
+		over each level 0 chunk they cover, one at a time through scratch,
+		and keep only the merged quads.
+	*/
+	void ChunkStreamer::GenerateChunk(ChunkCoord coord, LodGrid& lodGrid, std::vector<Vertex>& scratch, std::vector<Vertex>& vertices)
+	{
+		PROFILE_SCOPE("GenerateChunk");
+
+		vertices.clear();
+		vertices.reserve(WORLD_CHUNK_VERTICES);
+
+		if (coord.level == 0)
+		{
+			generator(coord, glm::vec2(coord.x, coord.y) * WORLD_CHUNK_SIZE, vertices);
+			return;
+		}
+
+		int32_t span = 1 << coord.level;
+		lodGrid.Reset(glm::vec2(coord.x, coord.y) * coord.Size(), coord.Size());
+
+		for (int32_t y = 0; y < span; y++)
+		{
+			for (int32_t x = 0; x < span; x++)
+			{
+				ChunkCoord base = { coord.x * span + x, coord.y * span + y, 0 };
+
+				scratch.clear();
+				generator(base, glm::vec2(base.x, base.y) * WORLD_CHUNK_SIZE, scratch);
+				lodGrid.AddQuads(scratch);
+			}
+		}
+
+		lodGrid.Emit(vertices);
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Stats Functions														 */
+	/*-----------------------------------------------------------------------*/
+	StreamerStats ChunkStreamer::GetStats()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stats.residentChunks = residentChunks.size();
+		stats.pendingChunks = pendingChunks.size();
+		stats.lodLevel = displayLevel;
+		return stats;
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Constructor															 */
+	/*-----------------------------------------------------------------------*/
+	ChunkStreamer::ChunkStreamer(Renderer* renderer, Camera* camera, ChunkGenerator generator)
+	{
+		this->renderer = renderer;
+		this->camera = camera;
+		this->generator = generator;
+		this->frame = 0;
+		this->displayLevel = 0;
+		this->targetLevel = 0;
+		this->stopping = false;
+		this->stats = {};
+
+		slots.resize(WORLD_CHUNK_SLOTS, { { 0, 0, 0 }, false, 0 });
+		renderer->ReserveVertexBuffer(WORLD_CHUNK_SLOTS * WORLD_CHUNK_VERTICES);
+
+		unsigned int workerCount = WORLD_STREAM_WORKERS;
+		if (workerCount == 0) workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+		for (unsigned int i = 0; i < workerCount; i++) workers.push_back(std::thread(&ChunkStreamer::WorkerLoop, this));
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Deconstructor														 */
+	/*-----------------------------------------------------------------------*/
+	ChunkStreamer::~ChunkStreamer()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		jobAvailable.notify_all();
+		for (int i = 0; i < workers.size(); i++) workers[i].join();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+#ifndef CHUNK_STREAMER_H
+#define CHUNK_STREAMER_H
+
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Chunk_Streamer.h																										 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <glm/glm.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../rendering/renderer.h"
+#include "lod_grid.h"
+
+/*-------------------------------------------------------------------------------------------------*/
+/* Defines																						   */
+/*-------------------------------------------------------------------------------------------------*/
+
+/*
+	The world is cut into square chunks WORLD_CHUNK_SIZE units across, each
+	holding at most WORLD_CHUNK_MAX_QUADS quads. Every resident chunk owns
+	one fixed-size slot of the vertex buffer; WORLD_CHUNK_SLOTS of them
+	exist. Slots are a whole number of cull chunks, so each world chunk
+	gets its own bounding boxes.
+*/
+#define WORLD_CHUNK_SIZE 512.0f
+#define WORLD_CHUNK_MAX_QUADS 512
+#define WORLD_CHUNK_VERTICES (WORLD_CHUNK_MAX_QUADS * 6)
+#define WORLD_CHUNK_SLOTS 512
+
+/*
+	Chunks up to WORLD_PREFETCH_CHUNKS beyond the edge of the view are
+	requested too, so panning finds them ready. At most
+	WORLD_MAX_PENDING_CHUNKS are queued for generation at once, and at
+	most WORLD_UPLOADS_PER_FRAME finished chunks are uploaded per frame.
+	0 workers means one per hardware thread, less one for the main thread.
+*/
+#define WORLD_PREFETCH_CHUNKS 1
+#define WORLD_MAX_PENDING_CHUNKS 64
+#define WORLD_UPLOADS_PER_FRAME 16
+#define WORLD_STREAM_WORKERS 0
+
+/*
+	Zoomed out, chunks are drawn from coarser levels. A level L chunk
+	covers 2^L x 2^L level 0 chunks, merged into WORLD_LOD_CELLS x
+	WORLD_LOD_CELLS quads. The coarsest level whose merged quads are at
+	most WORLD_LOD_CELL_PIXELS across on screen is used, so the number of
+	chunks in view stays about the same however far out the camera is.
+	A level only changes once the zoom is WORLD_LOD_HYSTERESIS levels past
+	the boundary, so hovering around it doesn't flip back and forth.
+*/
+#define WORLD_LOD_LEVELS 6
+#define WORLD_LOD_CELLS 16
+#define WORLD_LOD_CELL_PIXELS 16.0f
+#define WORLD_LOD_HYSTERESIS 0.25f
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Helper Structs																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Chunk Coord															 */
+	/*-----------------------------------------------------------------------*/
+	struct ChunkCoord
+	{
+		int32_t x;
+		int32_t y;
+		int32_t level;
+
+		uint64_t Key() const { return ((uint64_t)level << 58) | ((uint64_t)(x & 0x1FFFFFFF) << 29) | (uint64_t)(y & 0x1FFFFFFF); }
+		float Size() const { return WORLD_CHUNK_SIZE * (float)(1 << level); }
+	};
+
+	/*-----------------------------------------------------------------------*/
+	/* Chunk Generator														 */
+	/*-----------------------------------------------------------------------*/
+	/*
+		Fills vertices with the quads (6 vertices each) for the level 0
+		chunk at coord, covering [origin, origin + WORLD_CHUNK_SIZE). Called
+		on the worker threads, so it must be safe to call concurrently.
+		vertices arrives empty and anything past WORLD_CHUNK_VERTICES is
+		dropped.
+	*/
+	typedef std::function<void(ChunkCoord coord, glm::vec2 origin, std::vector<Vertex>& vertices)> ChunkGenerator;
+
+	/*-----------------------------------------------------------------------*/
+	/* Streamer Stats														 */
+	/*-----------------------------------------------------------------------*/
+	struct StreamerStats
+	{
+		uint32_t	residentChunks;
+		uint32_t	visibleChunks;
+		uint32_t	pendingChunks;
+		uint32_t	lodLevel;
+		uint64_t	generatedChunks;
+		uint64_t	uploadedChunks;
+		uint64_t	evictedChunks;
+		uint64_t	droppedChunks;
+	};
+
+	/*---------------------------------------------------------------------------------------------*/
+	/* Chunk Streamer																			   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		Keeps the chunks around the camera resident in the vertex buffer.
+
+		Every frame, Update() works out which chunks the view (plus a
+		prefetch margin) covers. Resident ones are marked as used; missing
+		ones are queued for the worker threads, nearest first. Workers run
+		the generator into vertex buffers taken from a pool, and hand the
+		results back. The main thread then uploads a few of them per frame
+		with Renderer::QueueVertexUpload(), which doesn't wait on the GPU.
+
+		A finished chunk takes a free slot if there is one. Otherwise it
+		takes the least recently used slot whose chunk is out of view. If
+		every slot is in view (the camera is zoomed out past what fits),
+		the chunk is dropped, and no more are asked for until the view
+		moves off some slots.
+
+		Coarser levels are generated by running the generator over every
+		level 0 chunk they cover and merging the result with a LodGrid.
+		When the zoom asks for a new level, its chunks are streamed in
+		while the current level stays on screen. Once all of them in view
+		are resident, the new level takes over and every other level's
+		chunks are hidden and their slots freed.
+	*/
+	class ChunkStreamer
+	{
+	private:
+		/*-------------------------------------------------------------------*/
+		/* Slots															 */
+		/*-------------------------------------------------------------------*/
+		struct ChunkSlot
+		{
+			ChunkCoord	coord;
+			bool		used;
+			uint64_t	lastUsed;
+		};
+
+		struct ChunkResult
+		{
+			ChunkCoord			coord;
+			std::vector<Vertex>	vertices;
+		};
+
+		Renderer*						renderer;
+		Camera*							camera;
+		ChunkGenerator					generator;
+
+		std::vector<ChunkSlot>			slots;
+		std::unordered_map<uint64_t, uint32_t>	residentChunks;
+		std::unordered_set<uint64_t>	wantedChunks;
+		std::unordered_set<uint64_t>	pendingChunks;
+		std::vector<ChunkResult>		readyChunks;
+		uint64_t						frame;
+
+		int32_t							displayLevel;
+		int32_t							targetLevel;
+
+		StreamerStats					stats;
+
+		/*-------------------------------------------------------------------*/
+		/* Worker Shared State												 */
+		/*-------------------------------------------------------------------*/
+		/*
+			Everything below is shared with the workers and guarded by
+			mutex.
+		*/
+		std::mutex						mutex;
+		std::condition_variable			jobAvailable;
+		std::deque<ChunkCoord>			jobs;
+		std::vector<ChunkResult>		completed;
+		std::vector<std::vector<Vertex>> bufferPool;
+		bool							stopping;
+
+		std::vector<std::thread>		workers;
+
+		/*-------------------------------------------------------------------*/
+		/* Streaming Functions												 */
+		/*-------------------------------------------------------------------*/
+		void							UpdateLevel(float unitsPerPixel);
+		void							CollectChunks(ViewBounds view, int32_t level, uint32_t maxChunks, std::vector<ChunkCoord>& chunks);
+		void							TouchChunks(const std::vector<ChunkCoord>& chunks, std::vector<ChunkCoord>& missing);
+		void							ReleaseStaleLevels();
+		void							RequestChunks(const std::vector<ChunkCoord>& missing, uint32_t freeSlots);
+		void							UploadChunks();
+		bool							UploadChunk(ChunkResult& result);
+		int								AcquireSlot(bool wanted);
+		void							ReleaseBuffer(std::vector<Vertex>& vertices);
+
+		/*-------------------------------------------------------------------*/
+		/* Worker Functions													 */
+		/*-------------------------------------------------------------------*/
+		void							WorkerLoop();
+		void							GenerateChunk(ChunkCoord coord, LodGrid& lodGrid, std::vector<Vertex>& scratch, std::vector<Vertex>& vertices);
+
+	public:
+		/*-------------------------------------------------------------------*/
+		/* Update Function													 */
+		/*-------------------------------------------------------------------*/
+		void							Update();
+
+		/*-------------------------------------------------------------------*/
+		/* Stats Functions													 */
+		/*-------------------------------------------------------------------*/
+		StreamerStats					GetStats();
+
+		/*-------------------------------------------------------------------*/
+		/* Constructor														 */
+		/*-------------------------------------------------------------------*/
+		ChunkStreamer(Renderer* renderer, Camera* camera, ChunkGenerator generator);
+
+		/*-------------------------------------------------------------------*/
+		/* Deconstructor													 */
+		/*-------------------------------------------------------------------*/
+		~ChunkStreamer();
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,111 @@
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Lod_Grid.cpp																											 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <algorithm>
+#include <cfloat>
+
+#include "lod_grid.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Lod Grid																					   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*-----------------------------------------------------------------------*/
+	/* Merge Functions														 */
+	/*-----------------------------------------------------------------------*/
+	/* Reset ----------------------------------------------------------------*/
+	/*
+		Starts a new merge over the square [origin, origin + size).
+	*/
+	void LodGrid::Reset(glm::vec2 origin, float size)
+	{
+		this->origin = origin;
+		this->cellSize = size / resolution;
+
+		for (int i = 0; i < cells.size(); i++) cells[i] = { glm::vec2(FLT_MAX), glm::vec2(-FLT_MAX), glm::vec4(0.0f), 0.0f, 0.0f };
+	}
+
+	/* Add Quads ------------------------------------------------------------*/
+	/*
+		Quads with no area, such as slot padding, don't count, and neither
+		do quads centred outside the area.
+	*/
+	void LodGrid::AddQuads(const std::vector<Vertex>& vertices)
+	{
+		for (int q = 0; q + 6 <= vertices.size(); q += 6)
+		{
+			glm::vec2 lo(FLT_MAX);
+			glm::vec2 hi(-FLT_MAX);
+			glm::vec4 color(0.0f);
+
+			for (int v = q; v < q + 6; v++)
+			{
+				glm::vec2 p(vertices[v].position.x, vertices[v].position.y);
+				lo = glm::min(lo, p);
+				hi = glm::max(hi, p);
+				color += vertices[v].color;
+			}
+
+			float area = (hi.x - lo.x) * (hi.y - lo.y);
+			if (area <= 0.0f) continue;
+
+			glm::vec2 centre = ((lo + hi) * 0.5f - origin) / cellSize;
+			if (centre.x < 0.0f || centre.y < 0.0f || centre.x >= resolution || centre.y >= resolution) continue;
+
+			Cell& cell = cells[(uint32_t)centre.y * resolution + (uint32_t)centre.x];
+			if (cell.area == 0.0f) cell.depth = vertices[q].position.z;
+
+			cell.min = glm::min(cell.min, lo);
+			cell.max = glm::max(cell.max, hi);
+			cell.color += color * (area / 6.0f);
+			cell.area += area;
+		}
+	}
+
+	/* Emit -----------------------------------------------------------------*/
+	/*
+		Appends one quad per occupied cell to vertices.
+	*/
+	void LodGrid::Emit(std::vector<Vertex>& vertices)
+	{
+		for (uint32_t y = 0; y < resolution; y++)
+		{
+			for (uint32_t x = 0; x < resolution; x++)
+			{
+				const Cell& cell = cells[y * resolution + x];
+				if (cell.area == 0.0f) continue;
+
+				glm::vec2 cellMin = origin + glm::vec2(x, y) * cellSize;
+				glm::vec2 lo = glm::max(cell.min, cellMin);
+				glm::vec2 hi = glm::min(cell.max, cellMin + cellSize);
+				glm::vec4 color = cell.color / cell.area;
+
+				Vertex a = { glm::vec3(lo.x, lo.y, cell.depth), color, { 0.0f, 0.0f } };
+				Vertex b = { glm::vec3(hi.x, lo.y, cell.depth), color, { 1.0f, 0.0f } };
+				Vertex c = { glm::vec3(hi.x, hi.y, cell.depth), color, { 1.0f, 1.0f } };
+				Vertex d = { glm::vec3(lo.x, hi.y, cell.depth), color, { 0.0f, 1.0f } };
+
+				vertices.insert(vertices.end(), { a, b, c, a, c, d });
+			}
+		}
+	}
+
+	/*-----------------------------------------------------------------------*/
+	/* Constructor															 */
+	/*-----------------------------------------------------------------------*/
+	LodGrid::LodGrid(uint32_t resolution)
+	{
+		this->resolution = resolution;
+		this->origin = glm::vec2(0.0f);
+		this->cellSize = 1.0f;
+
+		cells.resize(resolution * resolution);
+		Reset(origin, (float)resolution);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef LOD_GRID_H
+#define LOD_GRID_H
+
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/* Lod_Grid.h																											 */
+/* --  -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- */
+/*-----------------------------------------------------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------------------------------------*/
+/* Includes																						   */
+/*-------------------------------------------------------------------------------------------------*/
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "../util/polygons.h"
+
+namespace VkExample
+{
+	/*---------------------------------------------------------------------------------------------*/
+	/* Lod Grid																					   */
+	/*---------------------------------------------------------------------------------------------*/
+	/*
+		Merges quads into a coarser stand-in for them. The area being
+		merged is cut into resolution x resolution cells, and each quad
+		lands in the cell holding its centre. Every cell that received
+		anything comes out as one quad: the union of its quads' bounds
+		(clipped to the cell), coloured with their area-weighted average.
+
+		Quads come in as 6 vertices each, the way the chunk generators
+		write them, and go out the same way, so at most
+		resolution * resolution * 6 vertices are emitted.
+	*/
+	class LodGrid
+	{
+	private:
+		/*-------------------------------------------------------------------*/
+		/* Cells															 */
+		/*-------------------------------------------------------------------*/
+		struct Cell
+		{
+			glm::vec2	min;
+			glm::vec2	max;
+			glm::vec4	color;
+			float		area;
+			float		depth;
+		};
+
+		std::vector<Cell>				cells;
+		uint32_t						resolution;
+		glm::vec2						origin;
+		float							cellSize;
+
+	public:
+		/*-------------------------------------------------------------------*/
+		/* Merge Functions													 */
+		/*-------------------------------------------------------------------*/
+		void							Reset(glm::vec2 origin, float size);
+		void							AddQuads(const std::vector<Vertex>& vertices);
+		void							Emit(std::vector<Vertex>& vertices);
+
+		/*-------------------------------------------------------------------*/
+		/* Constructor														 */
+		/*-------------------------------------------------------------------*/
+		LodGrid(uint32_t resolution);
+	};
+}
+
+#endif
\ No newline at end of file